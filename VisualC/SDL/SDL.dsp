@@ -152,6 +152,10 @@ SOURCE=..\..\src\video\SDL_blit_N.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\video\SDL_blitstats.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_bmp.c
 # End Source File
 # Begin Source File
@@ -280,6 +284,10 @@ SOURCE=..\..\src\stdlib\SDL_getenv.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\stdlib\SDL_arena.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\stdlib\SDL_iconv.c
 # End Source File
 # Begin Source File
@@ -360,6 +368,10 @@ SOURCE=..\..\src\stdlib\SDL_qsort.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\stdlib\SDL_sort.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\events\SDL_quit.c
 # End Source File
 # Begin Source File
@@ -372,6 +384,10 @@ SOURCE=..\..\src\video\SDL_RLEaccel.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\video\SDL_srf.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_RLEaccel_c.h
 # End Source File
 # Begin Source File
@@ -380,6 +396,18 @@ SOURCE=..\..\src\file\SDL_rwops.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\file\SDL_lz4.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\file\SDL_rwasync.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\file\SDL_rwpack.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\video\SDL_stretch.c
 # End Source File
 # Begin Source File
@@ -400,6 +428,10 @@ SOURCE=..\..\src\video\SDL_surface.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\video\SDL_surfacepool.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\audio\SDL_sysaudio.h
 # End Source File
 # Begin Source File
@@ -484,6 +516,14 @@ SOURCE=..\..\src\thread\SDL_thread.c
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\src\thread\SDL_atomic.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\src\thread\SDL_job.c
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\src\thread\SDL_thread_c.h
 # End Source File
 # Begin Source File
@@ -0,0 +1,138 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+#ifndef _SDL_atomic_h
+#define _SDL_atomic_h
+
+/** @file SDL_atomic.h
+ *  Atomic operations and spinlocks, for building lock-free structures.
+ *
+ *  These use compiler builtins where available and a global mutex
+ *  otherwise, so they are always correct but only fast on compilers SDL
+ *  knows about.
+ *
+ *  @note These are independent of the other SDL routines.
+ */
+
+#include "SDL_stdinc.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/** @name Spinlock functions                                     */ /*@{*/
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/** A spinlock, initialized to 0 for unlocked */
+typedef int SDL_SpinLock;
+
+/** Try to take a spinlock, returning SDL_TRUE if it was taken */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicTryLock(SDL_SpinLock *lock);
+
+/**
+ *  Take a spinlock.  This spins with SDL_CPUPause() a few times, backing
+ *  off as it goes, and then gives up the CPU between attempts, so it only
+ *  burns time when the lock is held briefly.
+ */
+extern DECLSPEC void SDLCALL SDL_AtomicLock(SDL_SpinLock *lock);
+
+/** Release a spinlock, with release ordering */
+extern DECLSPEC void SDLCALL SDL_AtomicUnlock(SDL_SpinLock *lock);
+
+/** Hint to the CPU that this is a busy-wait loop */
+extern DECLSPEC void SDLCALL SDL_CPUPause(void);
+
+/** Give the rest of this thread's time slice to another thread */
+extern DECLSPEC void SDLCALL SDL_ThreadYield(void);
+
+/*@}*/
+
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+/** @name Atomic operations                                      */ /*@{*/
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+/** An integer that is only accessed with the atomic functions */
+typedef struct SDL_atomic_t {
+	volatile int value;
+} SDL_atomic_t;
+
+/** Memory orderings for SDL_AtomicLoad() and SDL_AtomicStore() */
+typedef enum {
+	SDL_MEMORY_ORDER_RELAXED,	/**< No ordering, only atomicity */
+	SDL_MEMORY_ORDER_ACQUIRE,	/**< Later accesses stay after a load */
+	SDL_MEMORY_ORDER_RELEASE,	/**< Earlier accesses stay before a store */
+	SDL_MEMORY_ORDER_SEQ_CST	/**< A single total order */
+} SDL_MemoryOrder;
+
+/**
+ *  Set an atomic to newval if it is currently oldval.
+ *  The read-modify-write operations here are all sequentially consistent.
+ *
+ *  @return SDL_TRUE if the value was set
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCAS(SDL_atomic_t *a, int oldval, int newval);
+
+/** Set an atomic, returning its previous value */
+extern DECLSPEC int SDLCALL SDL_AtomicSet(SDL_atomic_t *a, int value);
+
+/** Add to an atomic, returning its previous value */
+extern DECLSPEC int SDLCALL SDL_AtomicAdd(SDL_atomic_t *a, int value);
+
+/** Read an atomic with sequentially consistent ordering */
+#define SDL_AtomicGet(a)	SDL_AtomicLoad(a, SDL_MEMORY_ORDER_SEQ_CST)
+
+/** Read an atomic.  Release ordering is treated as relaxed. */
+extern DECLSPEC int SDLCALL SDL_AtomicLoad(SDL_atomic_t *a, SDL_MemoryOrder order);
+
+/** Write an atomic.  Acquire ordering is treated as relaxed. */
+extern DECLSPEC void SDLCALL SDL_AtomicStore(SDL_atomic_t *a, int value, SDL_MemoryOrder order);
+
+/** Increment an atomic reference count */
+#define SDL_AtomicIncRef(a)	SDL_AtomicAdd(a, 1)
+
+/** Decrement an atomic reference count, returning SDL_TRUE if it hit 0 */
+#define SDL_AtomicDecRef(a)	(SDL_AtomicAdd(a, -1) == 1)
+
+/** Set a pointer to newval if it is currently oldval */
+extern DECLSPEC SDL_bool SDLCALL SDL_AtomicCASPtr(void **a, void *oldval, void *newval);
+
+/** Set a pointer, returning its previous value */
+extern DECLSPEC void * SDLCALL SDL_AtomicSetPtr(void **a, void *value);
+
+/** Read a pointer with sequentially consistent ordering */
+extern DECLSPEC void * SDLCALL SDL_AtomicGetPtr(void **a);
+
+/** A full memory barrier */
+extern DECLSPEC void SDLCALL SDL_MemoryBarrier(void);
+
+/*@}*/
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* _SDL_atomic_h */
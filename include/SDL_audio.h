@@ -195,6 +195,41 @@ extern DECLSPEC SDL_audiostatus SDLCALL SDL_GetAudioStatus(void);
  */
 extern DECLSPEC void SDLCALL SDL_PauseAudio(int pause_on);
 
+/** Time spent in one stage of the audio thread, in microseconds */
+typedef struct SDL_AudioTiming {
+	Uint32 last;		/**< For the most recent buffer */
+	Uint32 average;
+	Uint32 max;
+} SDL_AudioTiming;
+
+/** Buckets in SDL_AudioStats::histogram, each 1/8 of a buffer's play time */
+#define SDL_AUDIO_HISTOGRAM_BUCKETS	16
+
+/** What the audio thread has done since the audio device was opened */
+typedef struct SDL_AudioStats {
+	Uint32 buffers;			/**< Buffers the audio thread has filled */
+	Uint32 buffer_time;		/**< How long a buffer plays for, in microseconds */
+	SDL_AudioTiming callback;	/**< The audio callback, with the audio locked */
+	SDL_AudioTiming convert;	/**< Converting to the device format */
+	SDL_AudioTiming play;		/**< Handing the buffer to the device */
+	SDL_AudioTiming wait;		/**< Waiting for the device to want more */
+	Uint32 underruns;		/**< Buffers that took longer to fill than to play */
+	Uint32 late;			/**< Waits that ended more than a buffer behind */
+	Uint32 dropped;			/**< Buffers filled with no device buffer to take them */
+	/** Buffers by the time taken to fill, convert and play them:
+	 *  histogram[i] counts those taking i/8 to (i+1)/8 of buffer_time,
+	 *  and the last bucket everything longer.
+	 */
+	Uint32 histogram[SDL_AUDIO_HISTOGRAM_BUCKETS];
+} SDL_AudioStats;
+
+/**
+ * Get the audio thread's timings.  Setting SDL_AUDIOSTATS in the
+ * environment prints them when the audio device is closed.
+ * @return 0, or -1 if the audio device isn't open
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioStats(SDL_AudioStats *stats);
+
 /**
  * This function loads a WAVE from the data source, automatically freeing
  * that source if 'freesrc' is non-zero.  For example, to load a WAVE file,
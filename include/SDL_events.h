@@ -68,7 +68,7 @@ typedef enum {
        SDL_EVENT_RESERVEDB,		/**< Reserved for future use.. */
        SDL_VIDEORESIZE,			/**< User resized video mode */
        SDL_VIDEOEXPOSE,			/**< Screen needs to be redrawn */
-       SDL_EVENT_RESERVED2,		/**< Reserved for future use.. */
+       SDL_RWASYNCEVENT,		/**< Asynchronous RWops read finished */
        SDL_EVENT_RESERVED3,		/**< Reserved for future use.. */
        SDL_EVENT_RESERVED4,		/**< Reserved for future use.. */
        SDL_EVENT_RESERVED5,		/**< Reserved for future use.. */
@@ -110,7 +110,8 @@ typedef enum {
 	SDL_VIDEORESIZEMASK	= SDL_EVENTMASK(SDL_VIDEORESIZE),
 	SDL_VIDEOEXPOSEMASK	= SDL_EVENTMASK(SDL_VIDEOEXPOSE),
 	SDL_QUITMASK		= SDL_EVENTMASK(SDL_QUIT),
-	SDL_SYSWMEVENTMASK	= SDL_EVENTMASK(SDL_SYSWMEVENT)
+	SDL_SYSWMEVENTMASK	= SDL_EVENTMASK(SDL_SYSWMEVENT),
+	SDL_RWASYNCEVENTMASK	= SDL_EVENTMASK(SDL_RWASYNCEVENT)
 } SDL_EventMask ;
 #define SDL_ALLEVENTS		0xFFFFFFFF
 /*@}*/
@@ -215,6 +216,10 @@ typedef struct SDL_UserEvent {
 	void *data2;	/**< User defined data pointer */
 } SDL_UserEvent;
 
+/** SDL_RWASYNCEVENT uses the user event structure: 'code' is the result
+ *  of the read, 'data1' the SDL_RWasync request and 'data2' its userdata.
+ */
+
 /** If you want to use this event, you should include SDL_syswm.h */
 struct SDL_SysWMmsg;
 typedef struct SDL_SysWMmsg SDL_SysWMmsg;
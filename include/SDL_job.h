@@ -0,0 +1,109 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+
+#ifndef _SDL_job_h
+#define _SDL_job_h
+
+/** @file SDL_job.h
+ *  A shared pool of worker threads for running small jobs in parallel.
+ *
+ *  Each worker keeps its own queue of jobs and steals from the others when
+ *  it runs dry.  Jobs added from outside the pool go on a shared queue.
+ *  Threads that wait for jobs run queued jobs while they wait, so waiting
+ *  on the main thread or inside a job doesn't waste a core.
+ */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Counts the unfinished jobs in a group, defined in SDL_job.c */
+struct SDL_JobCounter;
+typedef struct SDL_JobCounter SDL_JobCounter;
+
+typedef void (SDLCALL *SDL_JobFunction)(void *data);
+typedef void (SDLCALL *SDL_JobRangeFunction)(void *data, int start, int end);
+
+/**
+ *  Start the worker threads.  This is optional, since the pool starts
+ *  itself the first time a job is added.
+ *
+ *  @param numthreads The number of workers, or 0 for one less than the
+ *                    number of CPU cores or the value of the SDL_JOB_THREADS
+ *                    environment variable.  With no workers, jobs run on the
+ *                    thread that adds them, or that waits for them.
+ *
+ *  @return 0, or -1 if the pool was already running with another size
+ */
+extern DECLSPEC int SDLCALL SDL_InitJobs(int numthreads);
+
+/** Stop the worker threads, after running any jobs still queued */
+extern DECLSPEC void SDLCALL SDL_QuitJobs(void);
+
+/** Return the number of worker threads, starting the pool if needed */
+extern DECLSPEC int SDLCALL SDL_GetJobThreadCount(void);
+
+/** Create a counter for a group of jobs, initially with none pending */
+extern DECLSPEC SDL_JobCounter * SDLCALL SDL_CreateJobCounter(void);
+
+/** Free a counter, which must have no jobs pending or waiting on it */
+extern DECLSPEC void SDLCALL SDL_DestroyJobCounter(SDL_JobCounter *counter);
+
+/**
+ *  Add a job to the pool.
+ *
+ *  @param counter If not NULL, the job counts as pending on this counter
+ *                 until it returns.
+ *  @param after   If not NULL, the job doesn't start until this counter
+ *                 has no jobs pending.
+ *
+ *  @return 0, or -1 if there wasn't memory for the job
+ */
+extern DECLSPEC int SDLCALL SDL_AddJob(SDL_JobFunction func, void *data, SDL_JobCounter *counter, SDL_JobCounter *after);
+
+/**
+ *  Run queued jobs until the counter has no jobs pending.  Threads outside
+ *  the pool sleep once there is nothing left for them to run, workers keep
+ *  looking for jobs.
+ */
+extern DECLSPEC void SDLCALL SDL_WaitJobs(SDL_JobCounter *counter);
+
+/**
+ *  Split [start, end) into ranges of about grain items, call func on each
+ *  range in parallel, and return when they are all done.  A grain of 0
+ *  picks one that gives each thread a few ranges.  The calling thread runs
+ *  ranges too, and any range that can't be queued.
+ */
+extern DECLSPEC void SDLCALL SDL_ParallelFor(int start, int end, int grain, SDL_JobRangeFunction func, void *data);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* _SDL_job_h */
@@ -85,6 +85,16 @@ extern DECLSPEC void SDLCALL SDL_WarpMouse(Uint16 x, Uint16 y);
 extern DECLSPEC SDL_Cursor * SDLCALL SDL_CreateCursor
 		(Uint8 *data, Uint8 *mask, int w, int h, int hot_x, int hot_y);
 
+/**
+ * Create a full colour cursor from a surface.  Pixels are blended onto
+ * the screen using the surface's alpha channel, or its colorkey if it
+ * doesn't have one.  Colour cursors are always drawn in software.
+ *
+ * Cursors created with this function must be freed with SDL_FreeCursor().
+ */
+extern DECLSPEC SDL_Cursor * SDLCALL SDL_CreateColorCursor
+		(SDL_Surface *surface, int hot_x, int hot_y);
+
 /**
  * Set the currently active cursor to the specified one.
  * If the cursor is currently visible, the change will be immediately 
@@ -98,7 +108,8 @@ extern DECLSPEC void SDLCALL SDL_SetCursor(SDL_Cursor *cursor);
 extern DECLSPEC SDL_Cursor * SDLCALL SDL_GetCursor(void);
 
 /**
- * Deallocates a cursor created with SDL_CreateCursor().
+ * Deallocates a cursor created with SDL_CreateCursor() or
+ * SDL_CreateColorCursor().
  */
 extern DECLSPEC void SDLCALL SDL_FreeCursor(SDL_Cursor *cursor);
 
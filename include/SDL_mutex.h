@@ -76,6 +76,18 @@ extern DECLSPEC int SDLCALL SDL_mutexV(SDL_mutex *mutex);
 /** Destroy a mutex */
 extern DECLSPEC void SDLCALL SDL_DestroyMutex(SDL_mutex *mutex);
 
+/** Counts kept by a mutex or semaphore since it was created */
+typedef struct SDL_SyncStats {
+	Uint32 acquired;	/**< Successful locks or semaphore waits */
+	Uint32 contended;	/**< Those that had to wait for another thread */
+	Uint32 timeouts;	/**< Semaphore waits that timed out */
+} SDL_SyncStats;
+
+/** Get the lock counts of a mutex.
+ *  @return 0, or -1 if this platform doesn't keep them
+ */
+extern DECLSPEC int SDLCALL SDL_GetMutexStats(SDL_mutex *mutex, SDL_SyncStats *stats);
+
 /*@}*/
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
@@ -110,7 +122,8 @@ extern DECLSPEC int SDLCALL SDL_SemTryWait(SDL_sem *sem);
  *  the allotted time, and -1 on error.
  *
  *  On some platforms this function is implemented by looping with a delay
- *  of 1 ms, and so should be avoided if possible.
+ *  of 1 ms, and so should be avoided if possible.  On Linux it sleeps
+ *  until the semaphore is posted or the timeout passes.
  */
 extern DECLSPEC int SDLCALL SDL_SemWaitTimeout(SDL_sem *sem, Uint32 ms);
 
@@ -122,6 +135,11 @@ extern DECLSPEC int SDLCALL SDL_SemPost(SDL_sem *sem);
 /** Returns the current count of the semaphore */
 extern DECLSPEC Uint32 SDLCALL SDL_SemValue(SDL_sem *sem);
 
+/** Get the wait counts of a semaphore.
+ *  @return 0, or -1 if this platform doesn't keep them
+ */
+extern DECLSPEC int SDLCALL SDL_GetSemStats(SDL_sem *sem, SDL_SyncStats *stats);
+
 /*@}*/
 
 /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
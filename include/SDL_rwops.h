@@ -61,6 +61,7 @@ typedef struct SDL_RWops {
 	/** Close and free an allocated SDL_FSops structure */
 	int (SDLCALL *close)(struct SDL_RWops *context);
 
+	/** One of the SDL_RWOPS_* values below */
 	Uint32 type;
 	union {
 #if defined(__WIN32__) && !defined(__SYMBIAN32__)
@@ -93,6 +94,17 @@ typedef struct SDL_RWops {
 } SDL_RWops;
 
 
+/** @name RWops types */
+/*@{*/
+#define SDL_RWOPS_UNKNOWN	0	/**< Unknown stream type */
+#define SDL_RWOPS_WINFILE	1	/**< Win32 file */
+#define SDL_RWOPS_STDFILE	2	/**< Stdio file */
+#define SDL_RWOPS_MEMORY	3	/**< Memory stream */
+#define SDL_RWOPS_MEMORY_RO	4	/**< Read-Only memory stream */
+#define SDL_RWOPS_MAPPED	5	/**< Memory-mapped file */
+#define SDL_RWOPS_BUFFERED	6	/**< Read-ahead buffer over another source */
+/*@}*/
+
 /** @name Functions to create SDL_RWops structures from various data sources */
 /*@{*/
 
@@ -105,6 +117,40 @@ extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromFP(FILE *fp, int autoclose);
 extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromMem(void *mem, int size);
 extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromConstMem(const void *mem, int size);
 
+/**
+ * Create a read-only data source backed by a memory mapping of 'file'.
+ * Reads and seeks work directly on the mapped pages, so only the parts
+ * of the file that are actually touched get loaded.  On platforms
+ * without mmap() the file contents are read into memory instead.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromMappedFile(const char *file);
+
+/**
+ * Borrow the data of a memory backed source (SDL_RWFromMem(),
+ * SDL_RWFromConstMem() or SDL_RWFromMappedFile()) at the current offset,
+ * so it can be decoded in place instead of being read into a copy.
+ * The number of bytes up to the end of the source is stored in 'length'.
+ * The read position doesn't move, seek past the data once it's consumed.
+ *
+ * @param writable Whether the caller will modify the data.  Read-only
+ *	memory can only be borrowed for reading.  Writes to a mapped file
+ *	are private and never reach the file.
+ * @return A pointer that stays valid until the source is closed, or NULL
+ *	if the source isn't held in memory.
+ */
+extern DECLSPEC void * SDLCALL SDL_RWborrow(SDL_RWops *context, size_t *length, int writable);
+
+/**
+ * Create a data source that reads ahead from 'src' in blocks of
+ * 'blocksize' bytes (4096 if 0), so parsers doing lots of small reads
+ * don't go through the source for each one.  Seeks within the buffered
+ * block are free.  Writes go through to 'src' at the current offset.
+ *
+ * @param freesrc If non-zero 'src' is closed along with the new source,
+ *	otherwise it is left at the offset the reader stopped at.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromBufferedRW(SDL_RWops *src, int blocksize, int freesrc);
+
 extern DECLSPEC SDL_RWops * SDLCALL SDL_AllocRW(void);
 extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops *area);
 
@@ -126,6 +172,126 @@ extern DECLSPEC void SDLCALL SDL_FreeRW(SDL_RWops *area);
 #define SDL_RWclose(ctx)		(ctx)->close(ctx)
 /*@}*/
 
+/**
+ * Seek with a 64-bit offset, for sources larger than 2 GB.
+ * Files and memory sources support the full range, other sources
+ * fail if the offset doesn't fit in their 32-bit seek function.
+ *
+ * @return The final offset in the data source, or -1 on error.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_RWseek64(SDL_RWops *context, Sint64 offset, int whence);
+#define SDL_RWtell64(ctx)		SDL_RWseek64(ctx, 0, RW_SEEK_CUR)
+
+/** @name Asynchronous reads
+ *  Reads can be queued to be done by a small pool of background threads,
+ *  two unless the SDL_RWASYNC_THREADS environment variable says otherwise.
+ *  A data source must not be used directly while it has reads queued.
+ */
+/*@{*/
+typedef struct SDL_RWasync SDL_RWasync;
+
+/** The result of a read that was cancelled before it started */
+#define SDL_RWASYNC_CANCELLED	(-2)
+
+/** Called on the I/O thread when a read finishes.  'result' is the number
+ *  of bytes read, -1 if the source couldn't seek to the offset, or
+ *  SDL_RWASYNC_CANCELLED if SDL_Quit() cancelled the read.
+ *  The read is already finished, so the callback may release 'request'
+ *  with SDL_RWwaitAsync() itself.  If it does, nothing else may use the
+ *  request, including the pointer SDL_RWreadAsync() returned for it.
+ */
+typedef void (SDLCALL *SDL_RWasyncCallback)(void *userdata, SDL_RWasync *request, int result);
+
+/**
+ * Queue a read of 'size' bytes at 'offset' of 'src' into 'ptr'.
+ * When it finishes 'callback' is called, or if it is NULL an
+ * SDL_RWASYNCEVENT is pushed on the event queue (events that don't fit
+ * in a full queue are lost, the result is still returned by
+ * SDL_RWwaitAsync()).  Queued reads that continue each other on the
+ * same source are done in one go.
+ *
+ * @return A request that must be released with SDL_RWwaitAsync(),
+ *	or NULL on error.
+ */
+extern DECLSPEC SDL_RWasync * SDLCALL SDL_RWreadAsync(SDL_RWops *src, Sint64 offset, void *ptr, int size, SDL_RWasyncCallback callback, void *userdata);
+
+/**
+ * Cancel a read that hasn't started yet.  Reads cancelled here don't call
+ * their callback or push an event, and SDL_RWwaitAsync() returns
+ * SDL_RWASYNC_CANCELLED.  SDL_Quit() cancels the reads that haven't
+ * started, and those do call their callback or push an event.
+ *
+ * @return 0 if the read was cancelled, -1 if it is already under way.
+ */
+extern DECLSPEC int SDLCALL SDL_RWcancelAsync(SDL_RWasync *request);
+
+/**
+ * Wait for a read to finish and free the request.
+ *
+ * @return The number of bytes read, -1 if the read failed, or
+ *	SDL_RWASYNC_CANCELLED if it was cancelled.
+ */
+extern DECLSPEC int SDLCALL SDL_RWwaitAsync(SDL_RWasync *request);
+/*@}*/
+
+/** @name Pack files
+ *  A pack file holds many small data files, optionally compressed, with
+ *  an index for looking them up by name.  Opening an entry doesn't touch
+ *  the file system: stored entries are read straight out of the pack.
+ */
+/*@{*/
+typedef struct SDL_RWpack SDL_RWpack;
+
+/**
+ * Open a pack for reading from 'src', which should be memory or a mapped
+ * file (see SDL_RWFromMappedFile()).  Other sources are read into memory.
+ * If 'freesrc' is non-zero the source is closed along with the pack.
+ * Returns the pack, or NULL if there was an error.  A NULL 'src' leaves
+ * the error from whatever failed to make it.
+ */
+extern DECLSPEC SDL_RWpack * SDLCALL SDL_OpenPackRW(SDL_RWops *src, int freesrc);
+
+/** Convenience macro -- open a pack file through a file mapping */
+#define SDL_OpenPack(file)	SDL_OpenPackRW(SDL_RWFromMappedFile(file), 1)
+
+/**
+ * Open the entry 'name' of a pack as a read-only data source.
+ * Sources for stored entries point into the pack, so the pack must stay
+ * open until they are closed.  Compressed entries are unpacked into
+ * memory owned by the new source.
+ */
+extern DECLSPEC SDL_RWops * SDLCALL SDL_RWFromPack(SDL_RWpack *pack, const char *name);
+
+/** Get the number of entries in a pack */
+extern DECLSPEC int SDLCALL SDL_PackNumEntries(SDL_RWpack *pack);
+
+/** Get the name of entry 'index' of a pack */
+extern DECLSPEC const char * SDLCALL SDL_PackEntryName(SDL_RWpack *pack, int index);
+
+/**
+ * Start writing a pack to 'dst', which must be seekable.
+ * If 'freedst' is non-zero the destination is closed along with the pack.
+ */
+extern DECLSPEC SDL_RWpack * SDLCALL SDL_CreatePackRW(SDL_RWops *dst, int freedst);
+
+/** Convenience macro -- write a pack to a file */
+#define SDL_CreatePack(file)	SDL_CreatePackRW(SDL_RWFromFile(file, "wb"), 1)
+
+/**
+ * Add 'size' bytes of 'data' to a pack being written, under 'name'.
+ * If 'compress' is non-zero the data is stored LZ4 compressed, as long
+ * as that makes it smaller.
+ * Returns 0 if successful or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_AddPackEntry(SDL_RWpack *pack, const char *name, const void *data, int size, int compress);
+
+/**
+ * Close a pack.  A pack being written gets its index written first.
+ * Returns 0 if successful or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_ClosePack(SDL_RWpack *pack);
+/*@}*/
+
 /** @name Read an item of the specified endianness and return in native format */
 /*@{*/
 extern DECLSPEC Uint16 SDLCALL SDL_ReadLE16(SDL_RWops *src);
@@ -204,6 +204,67 @@ extern DECLSPEC void * SDLCALL SDL_realloc(void *mem, size_t size);
 extern DECLSPEC void SDLCALL SDL_free(void *mem);
 #endif
 
+/** Number of size classes in SDL_MallocStats */
+#define SDL_MALLOC_SIZE_CLASSES	16
+
+/** Allocation statistics for SDL's built-in malloc */
+typedef struct SDL_MallocStats {
+	size_t in_use;		/**< Bytes currently allocated */
+	size_t peak;		/**< Highest value in_use has reached */
+	Uint32 allocations;	/**< Total number of allocations */
+	Uint32 frees;		/**< Total number of frees */
+	/** Live blocks by size: up to 16 bytes in class 0, up to 32 in
+	 *  class 1 and so on, with larger blocks in the last class
+	 */
+	Uint32 size_class[SDL_MALLOC_SIZE_CLASSES];
+	int arenas;		/**< Number of heaps threads are spread across */
+} SDL_MallocStats;
+
+/**
+ * Get the allocation statistics of SDL_malloc(), for leak and memory
+ * pressure monitoring.  Sizes include the allocator's rounding.
+ *
+ * @return 0, or -1 if SDL_malloc() is the C library's malloc and keeps
+ *         no statistics
+ */
+extern DECLSPEC int SDLCALL SDL_GetMallocStats(SDL_MallocStats *stats);
+
+/** A linear allocator for short-lived memory, such as per-frame buffers */
+typedef struct SDL_Arena SDL_Arena;
+
+/**
+ * Create an arena that hands out memory from blocks of at least
+ * blocksize bytes, or a default size if blocksize is 0.
+ */
+extern DECLSPEC SDL_Arena * SDLCALL SDL_CreateArena(size_t blocksize);
+
+/**
+ * Allocate size bytes from an arena, aligned to 16 bytes.  The memory
+ * stays valid until the next SDL_ResetArena() or SDL_FreeArena(), and
+ * is never freed individually.
+ *
+ * @return the memory, or NULL if out of memory
+ */
+extern DECLSPEC void * SDLCALL SDL_ArenaAlloc(SDL_Arena *arena, size_t size);
+
+/**
+ * Release everything allocated from an arena at once, typically at the
+ * end of each frame.  If the last cycle overflowed into extra blocks,
+ * they are merged into one block big enough for all of it, so a steady
+ * workload stops touching the heap after the first few cycles.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetArena(SDL_Arena *arena);
+
+/**
+ * Release everything allocated from an arena, like SDL_ResetArena(), and
+ * give back any memory beyond its block size.  Use it after a one-off
+ * cycle that needed far more than usual.
+ */
+extern DECLSPEC void SDLCALL SDL_TrimArena(SDL_Arena *arena);
+
+/** Free an arena and all memory allocated from it */
+extern DECLSPEC void SDLCALL SDL_FreeArena(SDL_Arena *arena);
+
 #ifdef HAVE_ALLOCA
 #define SDL_stack_alloc(type, count)    (type*)alloca(sizeof(type)*(count))
 #define SDL_stack_free(data)
@@ -212,17 +273,32 @@ extern DECLSPEC void SDLCALL SDL_free(void *mem);
 #define SDL_stack_free(data)            SDL_free(data)
 #endif
 
-#ifdef HAVE_GETENV
+#if defined(HAVE_GETENV) && defined(HAVE_PUTENV)
 #define SDL_getenv	getenv
 #else
 extern DECLSPEC char * SDLCALL SDL_getenv(const char *name);
 #endif
 
-#ifdef HAVE_PUTENV
-#define SDL_putenv	putenv
-#else
+/** Put a variable of the form "name=value" into the environment, then call
+ *  the functions watching it.  With the C library this is putenv(), and the
+ *  string becomes part of the environment.
+ */
 extern DECLSPEC int SDLCALL SDL_putenv(const char *variable);
-#endif
+
+/** A function watching an environment variable, called with its new value */
+typedef void (SDLCALL *SDL_EnvCallback)(void *userdata, const char *name, const char *value);
+
+/** Call callback whenever SDL_putenv() sets the variable name.
+ *  Changes made outside SDL_putenv() aren't seen, and callback mustn't
+ *  set the variable it is watching.
+ *  Returns 0, or -1 if there wasn't enough memory.
+ */
+extern DECLSPEC int SDLCALL SDL_AddEnvCallback(const char *name, SDL_EnvCallback callback, void *userdata);
+
+/** Stop a callback added with SDL_AddEnvCallback(), which is safe to do
+ *  from inside any callback.
+ */
+extern DECLSPEC void SDLCALL SDL_DelEnvCallback(const char *name, SDL_EnvCallback callback, void *userdata);
 
 #ifdef HAVE_QSORT
 #define SDL_qsort	qsort
@@ -231,6 +307,41 @@ extern DECLSPEC void SDLCALL SDL_qsort(void *base, size_t nmemb, size_t size,
            int (*compare)(const void *, const void *));
 #endif
 
+/**
+ *  @name Typed Sorts
+ *  Stable radix sorts of integer keys carrying a payload, for large arrays
+ *  where calling a comparison function per element is too slow.  Use
+ *  SDL_qsort() for anything else.
+ */
+/*@{*/
+typedef struct SDL_SortKey32 {
+	Uint32 key;
+	Uint32 value;
+} SDL_SortKey32;
+
+typedef struct SDL_SortKey64 {
+	Uint64 key;
+	Uint64 value;
+} SDL_SortKey64;
+
+/** The keys are two's complement signed integers */
+#define SDL_SORT_SIGNED		0x01
+/** Split large arrays across the job pool and merge the sorted parts */
+#define SDL_SORT_PARALLEL	0x02
+
+/**
+ *  Sort an array by key, keeping items with equal keys in order.
+ *  With SDL_SORT_PARALLEL, arrays of 64K items or more are split into
+ *  chunks sorted and merged on the job pool (see SDL_job.h), one for each
+ *  worker and the calling thread unless the SDL_SORT_THREADS environment
+ *  variable says otherwise.
+ *
+ *  @return 0, or -1 if there wasn't memory for the scratch buffer
+ */
+extern DECLSPEC int SDLCALL SDL_SortKeys32(SDL_SortKey32 *items, size_t nitems, Uint32 flags);
+extern DECLSPEC int SDLCALL SDL_SortKeys64(SDL_SortKey64 *items, size_t nitems, Uint32 flags);
+/*@}*/
+
 #ifdef HAVE_ABS
 #define SDL_abs		abs
 #else
@@ -269,6 +380,13 @@ do {								\
 		: "0" (dst), "1" (val), "2" (SDL_static_cast(Uint32, len))	\
 		: "memory" );					\
 } while(0)
+#elif !defined(HAVE_MEMSET)
+/**
+ *  Fills len 32-bit words at dst with val.  Without a C library this is a
+ *  function using SSE2 or NEON stores where the build supports them.
+ */
+extern DECLSPEC void SDLCALL SDL_memset4(void *dst, Uint32 val, size_t len);
+#define SDL_memset4	SDL_memset4
 #endif
 #ifndef SDL_memset4
 #define SDL_memset4(dst, val, len)		\
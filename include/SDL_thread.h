@@ -45,6 +45,25 @@ extern "C" {
 struct SDL_Thread;
 typedef struct SDL_Thread SDL_Thread;
 
+/** Scheduling priorities for SDL_CreateThreadWithAttr() */
+typedef enum {
+	SDL_THREAD_PRIORITY_NORMAL,
+	SDL_THREAD_PRIORITY_LOW,
+	SDL_THREAD_PRIORITY_HIGH,
+	SDL_THREAD_PRIORITY_TIME_CRITICAL	/**< Real-time, for audio and the like */
+} SDL_ThreadPriority;
+
+/** Settings for a new thread.  A zeroed structure gives the defaults.
+ *  Settings the system doesn't support or won't grant, like real-time
+ *  priority for an unprivileged process, are skipped without failing.
+ */
+typedef struct SDL_ThreadAttr {
+	const char *name;		/**< Shown by debuggers and ps, or NULL */
+	Uint32 stacksize;		/**< In bytes, or 0 for the system default */
+	SDL_ThreadPriority priority;
+	Uint32 affinity;		/**< Mask of CPUs to run on, or 0 for any */
+} SDL_ThreadAttr;
+
 /** Create a thread */
 #if ((defined(__WIN32__) && !defined(HAVE_LIBC)) || defined(__OS2__)) &&  !defined(__SYMBIAN32__)
 /**
@@ -79,18 +98,30 @@ typedef void (__cdecl *pfnSDL_CurrentEndThread)(unsigned code);
 #endif
 
 extern DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *data, pfnSDL_CurrentBeginThread pfnBeginThread, pfnSDL_CurrentEndThread pfnEndThread);
+extern DECLSPEC SDL_Thread * SDLCALL SDL_CreateThreadWithAttr(int (SDLCALL *fn)(void *), void *data, const SDL_ThreadAttr *attr, pfnSDL_CurrentBeginThread pfnBeginThread, pfnSDL_CurrentEndThread pfnEndThread);
 
 #ifdef __OS2__
 #define SDL_CreateThread(fn, data) SDL_CreateThread(fn, data, _beginthread, _endthread)
+#define SDL_CreateThreadWithAttr(fn, data, attr) SDL_CreateThreadWithAttr(fn, data, attr, _beginthread, _endthread)
 #elif defined(_WIN32_WCE)
 #define SDL_CreateThread(fn, data) SDL_CreateThread(fn, data, NULL, NULL)
+#define SDL_CreateThreadWithAttr(fn, data, attr) SDL_CreateThreadWithAttr(fn, data, attr, NULL, NULL)
 #else
 #define SDL_CreateThread(fn, data) SDL_CreateThread(fn, data, _beginthreadex, _endthreadex)
+#define SDL_CreateThreadWithAttr(fn, data, attr) SDL_CreateThreadWithAttr(fn, data, attr, _beginthreadex, _endthreadex)
 #endif
 #else
 extern DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *data);
+
+/** Create a thread with a name, stack size, priority or CPU affinity.
+ *  attr may be NULL for the defaults, and needn't outlive the call.
+ */
+extern DECLSPEC SDL_Thread * SDLCALL SDL_CreateThreadWithAttr(int (SDLCALL *fn)(void *), void *data, const SDL_ThreadAttr *attr);
 #endif
 
+/** Get the name a thread was created with, or NULL if it has none */
+extern DECLSPEC const char * SDLCALL SDL_GetThreadName(SDL_Thread *thread);
+
 /** Get the 32-bit thread identifier for the current thread */
 extern DECLSPEC Uint32 SDLCALL SDL_ThreadID(void);
 
@@ -108,6 +139,57 @@ extern DECLSPEC void SDLCALL SDL_WaitThread(SDL_Thread *thread, int *status);
 /** Forcefully kill a thread without worrying about its state */
 extern DECLSPEC void SDLCALL SDL_KillThread(SDL_Thread *thread);
 
+/** @name Thread Enumeration
+ *  These cover the threads created with SDL_CreateThread() that haven't
+ *  been passed to SDL_WaitThread() yet, including ones that have finished.
+ */
+/*@{*/
+typedef struct SDL_ThreadStats {
+	int active;			/**< Threads not waited for yet */
+	Uint32 created;			/**< Threads created so far */
+	Uint32 exited;			/**< Threads whose function has returned */
+	Uint32 created_last_second;	/**< Threads created in the last full second */
+	Uint32 average_lifetime;	/**< Milliseconds, over the exited threads */
+	Uint32 longest_lifetime;	/**< Milliseconds */
+} SDL_ThreadStats;
+
+/** Get the thread counts and lifetimes
+ *  @return 0
+ */
+extern DECLSPEC int SDLCALL SDL_GetThreadStats(SDL_ThreadStats *stats);
+
+/** Fill in up to maxthreads threads, and return how many there are.
+ *  The threads stay valid until they're passed to SDL_WaitThread().
+ */
+extern DECLSPEC int SDLCALL SDL_GetThreads(SDL_Thread **threads, int maxthreads);
+
+/** Find a thread by its ID, or return NULL if it isn't one of these */
+extern DECLSPEC SDL_Thread * SDLCALL SDL_GetThreadFromID(Uint32 id);
+/*@}*/
+
+/** @name Thread Local Storage
+ *  Each thread has its own value for every ID, which starts out NULL.
+ *  Values are cleaned up when the thread exits, for threads created with
+ *  SDL_CreateThread() and, where the system supports it, any other thread.
+ */
+/*@{*/
+typedef unsigned int SDL_TLSID;
+
+/** Create an identifier that is valid on all threads, or 0 on failure */
+extern DECLSPEC SDL_TLSID SDLCALL SDL_TLSCreate(void);
+
+/** Get the calling thread's value for an ID, or NULL if it has none */
+extern DECLSPEC void * SDLCALL SDL_TLSGet(SDL_TLSID id);
+
+/**
+ *  Set the calling thread's value for an ID.  If destructor isn't NULL,
+ *  it is called with the value when the thread exits.
+ *
+ *  @return 0 on success, or -1 on error
+ */
+extern DECLSPEC int SDLCALL SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *));
+/*@}*/
+
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
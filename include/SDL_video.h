@@ -167,6 +167,36 @@ typedef struct SDL_Surface {
 typedef int (*SDL_blit)(struct SDL_Surface *src, SDL_Rect *srcrect,
 			struct SDL_Surface *dst, SDL_Rect *dstrect);
 
+/** Blit profiling counters for one blitter and pair of formats,
+ *  see SDL_EnableBlitStats()
+ */
+typedef struct SDL_BlitStats {
+	const char *blitter;	/**< Name of the low level blit function */
+	Uint32 flags;		/**< SDL_SRCCOLORKEY, SDL_SRCALPHA, SDL_RLEACCEL */
+	Uint8  src_bpp;		/**< Source BitsPerPixel */
+	Uint8  dst_bpp;		/**< Destination BitsPerPixel */
+	Uint32 src_Rmask, src_Gmask, src_Bmask, src_Amask;
+	Uint32 dst_Rmask, dst_Gmask, dst_Bmask, dst_Amask;
+	Uint32 calls;		/**< Number of blits */
+	Uint64 pixels;		/**< Number of pixels blitted */
+	Uint64 time;		/**< In SDL_GetPerformanceFrequency() units */
+} SDL_BlitStats;
+
+/** Counters for the surface pixel pool and the pixel format and blit
+ *  mapping caches, see SDL_GetSurfacePoolStats()
+ */
+typedef struct SDL_SurfacePoolStats {
+	Uint32 pixel_hits;	/**< Pixel buffers reused from the pool */
+	Uint32 pixel_misses;	/**< Pixel buffers allocated from the heap */
+	Uint32 pixel_releases;	/**< Pixel buffers returned to the pool */
+	Uint32 pixel_discards;	/**< Pixel buffers freed, the pool being full */
+	Uint32 pooled_bytes;	/**< Memory held by idle pixel buffers */
+	Uint32 format_hits;	/**< Pixel formats copied from the cache */
+	Uint32 format_misses;	/**< Pixel formats worked out from masks */
+	Uint32 blitmap_hits;	/**< Blit mappings reused from the cache */
+	Uint32 blitmap_misses;	/**< Blit mappings worked out from scratch */
+} SDL_SurfacePoolStats;
+
 
 /** Useful for determining the video hardware capabilities */
 typedef struct SDL_VideoInfo {
@@ -604,6 +634,40 @@ extern DECLSPEC int SDLCALL SDL_SaveBMP_RW
 #define SDL_SaveBMP(surface, file) \
 		SDL_SaveBMP_RW(surface, SDL_RWFromFile(file, "wb"), 1)
 
+/** @name SRF surface container flags */
+/*@{*/
+#define SDL_SRF_COMPRESS	0x00000001	/**< Compress the pixel data */
+/*@}*/
+
+/**
+ * Load a surface from an SRF container, SDL's native surface format.
+ * The pixels are stored in the surface's own format, so no decoding or
+ * conversion is needed.  If 'freesrc' is non-zero and the source is
+ * memory or a mapped file (see SDL_RWFromMappedFile()), uncompressed
+ * pixels are used in place: the surface takes ownership of the source
+ * and closes it when the surface is freed.
+ * Returns the new surface, or NULL if there was an error.
+ * The new surface should be freed with SDL_FreeSurface().
+ */
+extern DECLSPEC SDL_Surface * SDLCALL SDL_LoadSRF_RW(SDL_RWops *src, int freesrc);
+
+/** Convenience macro -- load a surface from a mapped file */
+#define SDL_LoadSRF(file)	SDL_LoadSRF_RW(SDL_RWFromMappedFile(file), 1)
+
+/**
+ * Save a surface to an SRF container, along with its palette, color key
+ * and alpha settings.  'flags' may contain SDL_SRF_COMPRESS.
+ * If 'freedst' is non-zero, the destination will be closed after being
+ * written.
+ * Returns 0 if successful or -1 if there was an error.
+ */
+extern DECLSPEC int SDLCALL SDL_SaveSRF_RW
+		(SDL_Surface *surface, SDL_RWops *dst, int freedst, Uint32 flags);
+
+/** Convenience macro -- save a surface to a file */
+#define SDL_SaveSRF(surface, file, flags) \
+		SDL_SaveSRF_RW(surface, SDL_RWFromFile(file, "wb"), 1, flags)
+
 /**
  * Sets the color key (transparent pixel) in a blittable surface.
  * If 'flag' is SDL_SRCCOLORKEY (optionally OR'd with SDL_RLEACCEL), 
@@ -756,6 +820,53 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 			(SDL_Surface *src, SDL_Rect *srcrect,
 			 SDL_Surface *dst, SDL_Rect *dstrect);
 
+/**
+ * Turn counting of software blits on (1) or off (0), or query whether
+ * it is on (-1).  Blits are counted per low level blit function, pair
+ * of surface formats and blit flags, so slow fallback paths show up.
+ * Only surfaces whose blit mapping is set up while counting is on are
+ * counted, so turn it on before creating and blitting surfaces.  Once
+ * it is turned off, each mapping drops the counting on its next blit.
+ *
+ * Setting the SDL_BLIT_STATS environment variable turns counting on
+ * at startup and prints the counters to stderr in SDL_Quit().
+ *
+ * Returns the previous state.
+ */
+extern DECLSPEC int SDLCALL SDL_EnableBlitStats(int enable);
+
+/**
+ * Copy up to 'maxstats' blit counters into 'stats'.
+ * Returns the total number of counters, which may be more than
+ * 'maxstats'.  Pass a NULL 'stats' to get the number alone.
+ */
+extern DECLSPEC int SDLCALL SDL_GetBlitStats(SDL_BlitStats *stats,
+							int maxstats);
+
+/** Reset all the blit counters to zero */
+extern DECLSPEC void SDLCALL SDL_ResetBlitStats(void);
+
+/**
+ * Get the counters for the surface pixel pool.  While the video
+ * subsystem is initialized, software surface pixels are allocated in
+ * size classes, and the buffers of freed surfaces are kept for reuse
+ * by later surfaces.  The SDL_SURFACE_POOL environment variable sets
+ * how many kilobytes of idle buffers are kept, 0 disables the pool.
+ * The default is 8192, or less on consoles (1024 on the PS Vita).
+ * Changing it with SDL_putenv() while the pool is running frees any
+ * idle buffers over the new limit.
+ *
+ * Pixel formats with the same depth and masks are worked out once and
+ * copied into new surfaces.  They aren't shared between surfaces,
+ * since a format also holds the surface's color key, alpha and palette.
+ *
+ * The color tables and blitter chosen for blitting software surfaces
+ * are cached by source and destination format, blit flags, color key
+ * and alpha, so blitting a surface to different destinations in turn
+ * doesn't work them out again for each blit.
+ */
+extern DECLSPEC void SDLCALL SDL_GetSurfacePoolStats(SDL_SurfacePoolStats *stats);
+
 /**
  * This function performs a fast fill of the given rectangle with 'color'
  * The given rectangle is clipped to the destination surface clip area
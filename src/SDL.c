@@ -27,12 +27,15 @@
 #include "SDL_fatal.h"
 #if !SDL_VIDEO_DISABLED
 #include "video/SDL_leaks.h"
+extern void SDL_DumpBlitStats(void);
 #endif
 
 #if SDL_THREAD_PTH
 #include <pth.h>
 #endif
 
+extern void SDL_RWasyncQuit(void);
+
 /* Initialization/Cleanup routines */
 #if !SDL_JOYSTICK_DISABLED
 extern int  SDL_JoystickInit(void);
@@ -219,6 +222,8 @@ void SDL_Quit(void)
 #ifdef DEBUG_BUILD
   printf("[SDL_Quit] : Enter! Calling QuitSubSystem()\n"); fflush(stdout);
 #endif
+	SDL_RWasyncQuit();
+	SDL_QuitJobs();
 	SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
 
 #ifdef CHECK_LEAKS
@@ -232,6 +237,10 @@ void SDL_Quit(void)
 							surfaces_allocated);
 	}
 #endif
+#if !SDL_VIDEO_DISABLED
+	/* Print the blit counters if SDL_BLIT_STATS is set */
+	SDL_DumpBlitStats();
+#endif
 #ifdef DEBUG_BUILD
   printf("[SDL_Quit] : SDL_UninstallParachute()\n"); fflush(stdout);
 #endif
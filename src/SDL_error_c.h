@@ -30,6 +30,7 @@
 
 #define ERR_MAX_STRLEN	128
 #define ERR_MAX_ARGS	5
+#define SDL_ERRBUFIZE	1024
 
 typedef struct SDL_error {
 	/* This is a numeric value corresponding to the current error */
@@ -54,6 +55,9 @@ typedef struct SDL_error {
 		double value_f;
 		char buf[ERR_MAX_STRLEN];
 	} args[ERR_MAX_ARGS];
+
+	/* The message last formatted by SDL_GetError() */
+	char message[SDL_ERRBUFIZE];
 } SDL_error;
 
 #endif /* _SDL_error_c_h */
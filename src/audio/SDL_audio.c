@@ -23,6 +23,10 @@
 
 /* Allow access to a raw mixing buffer */
 
+#if HAVE_STDIO_H
+#include <stdio.h>
+#endif
+
 #include "SDL.h"
 #include "SDL_audio_c.h"
 #include "SDL_audiomem.h"
@@ -121,6 +125,56 @@ SDL_AudioDevice *current_audio = NULL;
 int SDL_AudioInit(const char *driver_name);
 void SDL_AudioQuit(void);
 
+/* Add one pass through a stage of the audio thread to its timings */
+static void SDL_TimeAudioStage(SDL_AudioThreadStats *stats, int stage, Uint64 ticks)
+{
+	stats->last[stage] = ticks;
+	stats->total[stage] += ticks;
+	if ( ticks > stats->max[stage] ) {
+		stats->max[stage] = ticks;
+	}
+}
+
+/* Record how long the audio thread took over a buffer.
+   t[0] is when it started filling the buffer, and t[1] to t[4] when the
+   callback, conversion, play and wait stages ended.
+ */
+static void SDL_UpdateAudioStats(SDL_AudioDevice *audio, const Uint64 *t, int dropped)
+{
+	SDL_AudioThreadStats *stats = &audio->stats;
+	Uint64 work = t[3] - t[0];
+	int bucket;
+
+	SDL_AtomicLock(&audio->stats_lock);
+	++stats->buffers;
+	SDL_TimeAudioStage(stats, SDL_AUDIO_STAGE_CALLBACK, t[1] - t[0]);
+	SDL_TimeAudioStage(stats, SDL_AUDIO_STAGE_CONVERT, t[2] - t[1]);
+	SDL_TimeAudioStage(stats, SDL_AUDIO_STAGE_PLAY, t[3] - t[2]);
+	SDL_TimeAudioStage(stats, SDL_AUDIO_STAGE_WAIT, t[4] - t[3]);
+	if ( dropped ) {
+		++stats->dropped;
+	}
+	if ( work > stats->period ) {
+		++stats->underruns;
+	}
+	bucket = SDL_AUDIO_HISTOGRAM_BUCKETS-1;
+	if ( work < (stats->period * bucket) / 8 ) {
+		bucket = (int)((work * 8) / stats->period);
+	}
+	++stats->histogram[bucket];
+
+	/* Once the device has accepted a buffer it should want the next
+	   one a buffer later; if it's more than a buffer behind that, the
+	   audio thread has fallen behind the device and starts again.
+	 */
+	stats->deadline += stats->period;
+	if ( t[4] > stats->deadline + stats->period ) {
+		++stats->late;
+		stats->deadline = t[4];
+	}
+	SDL_AtomicUnlock(&audio->stats_lock);
+}
+
 /* The general mixing thread function */
 int SDLCALL SDL_RunAudio(void *audiop)
 {
@@ -130,6 +184,7 @@ int SDLCALL SDL_RunAudio(void *audiop)
 	void  *udata;
 	void (SDLCALL *fill)(void *userdata,Uint8 *stream, int len);
 	int    silence;
+	Uint64 t[SDL_AUDIO_STAGES+1];
 
 	/* Perform any thread setup */
 	if ( audio->ThreadInit ) {
@@ -153,6 +208,17 @@ int SDLCALL SDL_RunAudio(void *audiop)
 		stream_len = audio->spec.size;
 	}
 
+	/* Start the timings from scratch */
+	SDL_AtomicLock(&audio->stats_lock);
+	SDL_memset(&audio->stats, 0, sizeof(audio->stats));
+	audio->stats.period = (SDL_GetPerformanceFrequency() *
+	                       audio->spec.samples) / audio->spec.freq;
+	if ( audio->stats.period == 0 ) {
+		audio->stats.period = 1;
+	}
+	audio->stats.deadline = SDL_GetPerformanceCounter();
+	SDL_AtomicUnlock(&audio->stats_lock);
+
 	/* Loop, filling the audio buffers */
 	while ( audio->enabled ) {
 
@@ -170,6 +236,7 @@ int SDLCALL SDL_RunAudio(void *audiop)
 			}
 		}
 
+		t[0] = SDL_GetPerformanceCounter();
 		SDL_memset(stream, silence, stream_len);
 
 		if ( ! audio->paused ) {
@@ -177,6 +244,7 @@ int SDLCALL SDL_RunAudio(void *audiop)
 			(*fill)(udata, stream, stream_len);
 			SDL_mutexV(audio->mixer_lock);
 		}
+		t[1] = SDL_GetPerformanceCounter();
 
 		/* Convert the audio if necessary */
 		if ( audio->convert.needed ) {
@@ -188,11 +256,13 @@ int SDLCALL SDL_RunAudio(void *audiop)
 			SDL_memcpy(stream, audio->convert.buf,
 			               audio->convert.len_cvt);
 		}
+		t[2] = SDL_GetPerformanceCounter();
 
 		/* Ready current buffer for play and change current buffer */
 		if ( stream != audio->fake_stream ) {
 			audio->PlayAudio(audio);
 		}
+		t[3] = SDL_GetPerformanceCounter();
 
 		/* Wait for an audio buffer to become available */
 		if ( stream == audio->fake_stream ) {
@@ -200,6 +270,9 @@ int SDLCALL SDL_RunAudio(void *audiop)
 		} else {
 			audio->WaitAudio(audio);
 		}
+		t[4] = SDL_GetPerformanceCounter();
+
+		SDL_UpdateAudioStats(audio, t, (stream == audio->fake_stream));
 	}
 
 	/* Wait for the audio to drain.. */
@@ -379,6 +452,7 @@ char *SDL_AudioDriverName(char *namebuf, int maxlen)
 int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 {
 	SDL_AudioDevice *audio;
+	SDL_ThreadAttr attr;
 	const char *env;
 
 	/* Start up the audio driver, if necessary */
@@ -529,12 +603,17 @@ int SDL_OpenAudio(SDL_AudioSpec *desired, SDL_AudioSpec *obtained)
 	/* Start the audio thread if necessary */
 	switch (audio->opened) {
 		case  1:
-			/* Start the audio thread */
+			/* Start the audio thread, ahead of everything else */
+			SDL_memset(&attr, 0, sizeof(attr));
+			attr.name = "SDLAudio";
+			attr.priority = audio->freerun ?
+					SDL_THREAD_PRIORITY_NORMAL :
+					SDL_THREAD_PRIORITY_TIME_CRITICAL;
 #if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
-#undef SDL_CreateThread
-			audio->thread = SDL_CreateThread(SDL_RunAudio, audio, NULL, NULL);
+#undef SDL_CreateThreadWithAttr
+			audio->thread = SDL_CreateThreadWithAttr(SDL_RunAudio, audio, &attr, NULL, NULL);
 #else
-			audio->thread = SDL_CreateThread(SDL_RunAudio, audio);
+			audio->thread = SDL_CreateThreadWithAttr(SDL_RunAudio, audio, &attr);
 #endif
 			if ( audio->thread == NULL ) {
 				SDL_CloseAudio();
@@ -596,6 +675,88 @@ void SDL_UnlockAudio (void)
 	}
 }
 
+static Uint32 SDL_AudioTicksToUS(Uint64 ticks)
+{
+	return (Uint32)((ticks * 1000000) / SDL_GetPerformanceFrequency());
+}
+
+static void SDL_GetAudioTiming(const SDL_AudioThreadStats *stats, int stage,
+                               SDL_AudioTiming *timing)
+{
+	timing->last = SDL_AudioTicksToUS(stats->last[stage]);
+	timing->max = SDL_AudioTicksToUS(stats->max[stage]);
+	timing->average = 0;
+	if ( stats->buffers ) {
+		timing->average = SDL_AudioTicksToUS(stats->total[stage] /
+		                                     stats->buffers);
+	}
+}
+
+int SDL_GetAudioStats(SDL_AudioStats *stats)
+{
+	SDL_AudioDevice *audio = current_audio;
+	SDL_AudioThreadStats copy;
+
+	SDL_memset(stats, 0, sizeof(*stats));
+	if ( ! audio || ! audio->opened ) {
+		SDL_SetError("Audio subsystem is not initialized");
+		return(-1);
+	}
+
+	SDL_AtomicLock(&audio->stats_lock);
+	SDL_memcpy(&copy, &audio->stats, sizeof(copy));
+	SDL_AtomicUnlock(&audio->stats_lock);
+
+	stats->buffers = copy.buffers;
+	stats->buffer_time = SDL_AudioTicksToUS(copy.period);
+	SDL_GetAudioTiming(&copy, SDL_AUDIO_STAGE_CALLBACK, &stats->callback);
+	SDL_GetAudioTiming(&copy, SDL_AUDIO_STAGE_CONVERT, &stats->convert);
+	SDL_GetAudioTiming(&copy, SDL_AUDIO_STAGE_PLAY, &stats->play);
+	SDL_GetAudioTiming(&copy, SDL_AUDIO_STAGE_WAIT, &stats->wait);
+	stats->underruns = copy.underruns;
+	stats->late = copy.late;
+	stats->dropped = copy.dropped;
+	SDL_memcpy(stats->histogram, copy.histogram, sizeof(stats->histogram));
+	return(0);
+}
+
+#if HAVE_STDIO_H
+static void SDL_PrintAudioTiming(const char *stage, const SDL_AudioTiming *timing)
+{
+	fprintf(stderr, "  %-8s %8u %8u %8u\n", stage,
+	        timing->last, timing->average, timing->max);
+}
+
+/* Print the audio thread's timings if SDL_AUDIOSTATS is set */
+static void SDL_PrintAudioStats(void)
+{
+	SDL_AudioStats stats;
+	int i;
+
+	if ( ! SDL_getenv("SDL_AUDIOSTATS") ||
+	     (SDL_GetAudioStats(&stats) < 0) || ! stats.buffers ) {
+		return;
+	}
+	fprintf(stderr, "Audio: %u buffers of %u us, %u underruns, "
+	        "%u late, %u dropped\n", stats.buffers, stats.buffer_time,
+	        stats.underruns, stats.late, stats.dropped);
+	fprintf(stderr, "  %-8s %8s %8s %8s\n", "us", "last", "average", "max");
+	SDL_PrintAudioTiming("callback", &stats.callback);
+	SDL_PrintAudioTiming("convert", &stats.convert);
+	SDL_PrintAudioTiming("play", &stats.play);
+	SDL_PrintAudioTiming("wait", &stats.wait);
+	fprintf(stderr, "  Time to fill a buffer, in eighths of its play time:\n ");
+	for ( i = 0; i < SDL_AUDIO_HISTOGRAM_BUCKETS; ++i ) {
+		if ( stats.histogram[i] ) {
+			fprintf(stderr, " %d%s:%u", i,
+			        (i == SDL_AUDIO_HISTOGRAM_BUCKETS-1) ? "+" : "",
+			        stats.histogram[i]);
+		}
+	}
+	fprintf(stderr, "\n");
+}
+#endif /* HAVE_STDIO_H */
+
 void SDL_CloseAudio (void)
 {
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -609,6 +770,9 @@ void SDL_AudioQuit(void)
 		audio->enabled = 0;
 		if ( audio->thread != NULL ) {
 			SDL_WaitThread(audio->thread, NULL);
+#if HAVE_STDIO_H
+			SDL_PrintAudioStats();
+#endif
 		}
 		if ( audio->mixer_lock != NULL ) {
 			SDL_DestroyMutex(audio->mixer_lock);
@@ -676,6 +840,28 @@ void SDL_CalculateAudioSpec(SDL_AudioSpec *spec)
 	spec->size *= spec->samples;
 }
 
+void SDL_StartAudioPacer(SDL_AudioPacer *pacer, const SDL_AudioSpec *spec)
+{
+	pacer->frequency = SDL_GetPerformanceFrequency();
+	pacer->period = (pacer->frequency * spec->samples) / spec->freq;
+	pacer->deadline = SDL_GetPerformanceCounter();
+	pacer->late = 0;
+}
+
+void SDL_WaitAudioPacer(SDL_AudioPacer *pacer)
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+
+	pacer->deadline += pacer->period;
+	if ( now < pacer->deadline ) {
+		SDL_Delay((Uint32)(((pacer->deadline - now) * 1000) / pacer->frequency));
+	} else if ( (now - pacer->deadline) > pacer->period ) {
+		/* Rather than rushing to catch up, start again from now */
+		++pacer->late;
+		pacer->deadline = now;
+	}
+}
+
 void SDL_Audio_SetCaption(const char *caption)
 {
 	if ((current_audio) && (current_audio->SetCaption)) {
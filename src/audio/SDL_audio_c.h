@@ -21,6 +21,9 @@
 */
 #include "SDL_config.h"
 
+#ifndef _SDL_audio_c_h
+#define _SDL_audio_c_h
+
 /* Functions and variables exported from SDL_audio.c for SDL_sysaudio.c */
 
 /* Functions to get a list of "close" audio formats */
@@ -33,3 +36,20 @@ extern void SDL_CalculateAudioSpec(SDL_AudioSpec *spec);
 /* The actual mixing thread function */
 extern int SDLCALL SDL_RunAudio(void *audiop);
 
+/* Paces drivers with no device to wait on to the rate of the audio, using
+   absolute deadlines so the time spent mixing doesn't add up to drift.
+ */
+typedef struct SDL_AudioPacer {
+	Uint64 frequency;	/* performance counter ticks per second */
+	Uint64 period;		/* ticks per buffer */
+	Uint64 deadline;	/* when the last buffer was due */
+	Uint32 late;		/* times the pacer fell more than a buffer behind */
+} SDL_AudioPacer;
+
+/* Start pacing buffers of the given spec from now */
+extern void SDL_StartAudioPacer(SDL_AudioPacer *pacer, const SDL_AudioSpec *spec);
+
+/* Wait until the next buffer is due */
+extern void SDL_WaitAudioPacer(SDL_AudioPacer *pacer);
+
+#endif /* _SDL_audio_c_h */
@@ -26,10 +26,34 @@
 
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
+#include "SDL_atomic.h"
 
 /* The SDL audio driver */
 typedef struct SDL_AudioDevice SDL_AudioDevice;
 
+/* The stages of the audio thread that are timed */
+enum {
+	SDL_AUDIO_STAGE_CALLBACK,
+	SDL_AUDIO_STAGE_CONVERT,
+	SDL_AUDIO_STAGE_PLAY,
+	SDL_AUDIO_STAGE_WAIT,
+	SDL_AUDIO_STAGES
+};
+
+/* The running totals behind SDL_AudioStats, in performance counter ticks */
+typedef struct SDL_AudioThreadStats {
+	Uint64 period;			/* how long a buffer plays for */
+	Uint64 deadline;		/* when the last wait should have ended */
+	Uint64 last[SDL_AUDIO_STAGES];
+	Uint64 total[SDL_AUDIO_STAGES];
+	Uint64 max[SDL_AUDIO_STAGES];
+	Uint32 buffers;
+	Uint32 underruns;
+	Uint32 late;
+	Uint32 dropped;
+	Uint32 histogram[SDL_AUDIO_HISTOGRAM_BUCKETS];
+} SDL_AudioThreadStats;
+
 /* Define the SDL audio driver structure */
 #define _THIS	SDL_AudioDevice *_this
 #ifndef _STATUS
@@ -85,6 +109,14 @@ struct SDL_AudioDevice {
 	SDL_Thread *thread;
 	Uint32 threadid;
 
+	/* Set by drivers that don't wait for a device, so the thread
+	   runs at normal priority rather than hogging the CPU */
+	int freerun;
+
+	/* Timings of the audio thread, see SDL_GetAudioStats() */
+	SDL_SpinLock stats_lock;
+	SDL_AudioThreadStats stats;
+
 	/* * * */
 	/* Data private to this driver */
 	struct SDL_PrivateAudioData *hidden;
@@ -27,7 +27,7 @@
 #include "SDL_wave.h"
 
 
-static int ReadChunk(SDL_RWops *src, Chunk *chunk);
+static int ReadChunk(SDL_RWops *src, Chunk *chunk, int borrow);
 
 struct MS_ADPCM_decodestate {
 	Uint8 hPredictor;
@@ -119,7 +119,7 @@ static Sint32 MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
 	return(new_sample);
 }
 
-static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len, int borrowed)
 {
 	struct MS_ADPCM_decodestate *state[2];
 	Uint8 *freeable, *encoded, *encoded_end, *decoded, *decoded_end;
@@ -224,15 +224,21 @@ static int MS_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 		}
 		encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
 	}
-	SDL_free(freeable);
+	if ( ! borrowed ) {
+		SDL_free(freeable);
+	}
 	return(0);
 invalid_size:
 	SDL_SetError("Unexpected chunk length for a MS ADPCM decoder");
-	SDL_free(freeable);
+	if ( ! borrowed ) {
+		SDL_free(freeable);
+	}
 	return(-1);
 invalid_predictor:
 	SDL_SetError("Invalid predictor value for a MS ADPCM decoder");
-	SDL_free(freeable);
+	if ( ! borrowed ) {
+		SDL_free(freeable);
+	}
 	return(-1);
 }
 
@@ -353,7 +359,7 @@ static void Fill_IMA_ADPCM_block(Uint8 *decoded, Uint8 *encoded,
 	}
 }
 
-static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
+static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len, int borrowed)
 {
 	struct IMA_ADPCM_decodestate *state;
 	Uint8 *freeable, *encoded, *encoded_end, *decoded, *decoded_end;
@@ -425,11 +431,15 @@ static int IMA_ADPCM_decode(Uint8 **audio_buf, Uint32 *audio_len)
 		}
 		encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
 	}
-	SDL_free(freeable);
+	if ( ! borrowed ) {
+		SDL_free(freeable);
+	}
 	return(0);
 invalid_size:
 	SDL_SetError("Unexpected chunk length for an IMA ADPCM decoder");
-	SDL_free(freeable);
+	if ( ! borrowed ) {
+		SDL_free(freeable);
+	}
 	return(-1);
 }
 
@@ -482,7 +492,7 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 			SDL_free(chunk.data);
 			chunk.data = NULL;
 		}
-		lenread = ReadChunk(src, &chunk);
+		lenread = ReadChunk(src, &chunk, 0);
 		if ( lenread < 0 ) {
 			was_error = 1;
 			goto done;
@@ -565,7 +575,9 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 			SDL_free(*audio_buf);
 			*audio_buf = NULL;
 		}
-		lenread = ReadChunk(src, &chunk);
+		/* Compressed data is only needed until it's decoded */
+		lenread = ReadChunk(src, &chunk,
+				MS_ADPCM_encoded || IMA_ADPCM_encoded);
 		if ( lenread < 0 ) {
 			was_error = 1;
 			goto done;
@@ -577,13 +589,13 @@ SDL_AudioSpec * SDL_LoadWAV_RW (SDL_RWops *src, int freesrc,
 	headerDiff += 2 * sizeof(Uint32); /* for the data chunk and len */
 
 	if ( MS_ADPCM_encoded ) {
-		if ( MS_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+		if ( MS_ADPCM_decode(audio_buf, audio_len, chunk.borrowed) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
 	}
 	if ( IMA_ADPCM_encoded ) {
-		if ( IMA_ADPCM_decode(audio_buf, audio_len) < 0 ) {
+		if ( IMA_ADPCM_decode(audio_buf, audio_len, chunk.borrowed) < 0 ) {
 			was_error = 1;
 			goto done;
 		}
@@ -621,10 +633,22 @@ void SDL_FreeWAV(Uint8 *audio_buf)
 	}
 }
 
-static int ReadChunk(SDL_RWops *src, Chunk *chunk)
+static int ReadChunk(SDL_RWops *src, Chunk *chunk, int borrow)
 {
 	chunk->magic	= SDL_ReadLE32(src);
 	chunk->length	= SDL_ReadLE32(src);
+	chunk->borrowed = 0;
+	if ( borrow && (chunk->magic == DATA) ) {
+		size_t avail;
+
+		/* Decode audio data straight from memory if we can */
+		chunk->data = (Uint8 *)SDL_RWborrow(src, &avail, 0);
+		if ( chunk->data && (avail >= chunk->length) &&
+		     (SDL_RWseek64(src, chunk->length, RW_SEEK_CUR) >= 0) ) {
+			chunk->borrowed = 1;
+			return(chunk->length);
+		}
+	}
 	chunk->data = (Uint8 *)SDL_malloc(chunk->length);
 	if ( chunk->data == NULL ) {
 		SDL_Error(SDL_ENOMEM);
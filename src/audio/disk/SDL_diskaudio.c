@@ -45,6 +45,10 @@
 #define DISKDEFAULT_OUTFILE      "sdlaudio.raw"
 #define DISKENVR_WRITEDELAY      "SDL_DISKAUDIODELAY"
 #define DISKDEFAULT_WRITEDELAY   150
+#define DISKENVR_MODE            "SDL_DISKAUDIOMODE"
+#define DISKENVR_BUFFERS         "SDL_DISKAUDIOBUFFERS"
+#define DISKDEFAULT_BUFFERS      3
+#define DISKMAX_BUFFERS          64
 
 /* Audio driver functions */
 static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec);
@@ -99,6 +103,23 @@ static SDL_AudioDevice *DISKAUD_CreateDevice(int devindex)
 	envr = SDL_getenv(DISKENVR_WRITEDELAY);
 	this->hidden->write_delay = (envr) ? SDL_atoi(envr) : DISKDEFAULT_WRITEDELAY;
 
+	envr = SDL_getenv(DISKENVR_MODE);
+	if ( envr && (SDL_strcmp(envr, "paced") == 0) ) {
+		this->hidden->mode = DISKAUD_MODE_PACED;
+	} else if ( envr && (SDL_strcmp(envr, "freerun") == 0) ) {
+		this->hidden->mode = DISKAUD_MODE_FREERUN;
+	} else {
+		this->hidden->mode = DISKAUD_MODE_DELAY;
+	}
+
+	envr = SDL_getenv(DISKENVR_BUFFERS);
+	this->hidden->nbuffers = (envr) ? SDL_atoi(envr) : DISKDEFAULT_BUFFERS;
+	if ( this->hidden->nbuffers < 2 ) {
+		this->hidden->nbuffers = 2;
+	} else if ( this->hidden->nbuffers > DISKMAX_BUFFERS ) {
+		this->hidden->nbuffers = DISKMAX_BUFFERS;
+	}
+
 	/* Set the function pointers */
 	this->OpenAudio = DISKAUD_OpenAudio;
 	this->WaitAudio = DISKAUD_WaitAudio;
@@ -116,37 +137,129 @@ AudioBootStrap DISKAUD_bootstrap = {
 	DISKAUD_Available, DISKAUD_CreateDevice
 };
 
+/* Write the buffers out as the audio thread hands them over, until an
+   extra post of filled with nothing queued says the device is closing.
+ */
+static int SDLCALL DISKAUD_WriterThread(void *data)
+{
+	struct SDL_PrivateAudioData *hidden = (struct SDL_PrivateAudioData *)data;
+	Uint32 written = 0;
+	Uint8 *buf;
+
+	for ( ;; ) {
+		SDL_SemWait(hidden->filled);
+		if ( written == hidden->queued ) {
+			break;
+		}
+		buf = hidden->mixbuf +
+		      (written % hidden->nbuffers) * hidden->mixlen;
+		if ( !hidden->failed &&
+		     (Uint32)SDL_RWwrite(hidden->output, buf, 1, hidden->mixlen) != hidden->mixlen ) {
+			hidden->failed = 1;
+		}
+		++written;
+		hidden->written = written;
+		hidden->finish = SDL_GetPerformanceCounter();
+		SDL_SemPost(hidden->empty);
+	}
+	return(0);
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void DISKAUD_WaitAudio(_THIS)
 {
-	SDL_Delay(this->hidden->write_delay);
+	switch ( this->hidden->mode ) {
+	    case DISKAUD_MODE_DELAY:
+		SDL_Delay(this->hidden->write_delay);
+		break;
+	    case DISKAUD_MODE_PACED:
+		SDL_WaitAudioPacer(&this->hidden->pacer);
+		break;
+	    case DISKAUD_MODE_FREERUN:
+		break;
+	}
+
+	/* Take the next buffer, waiting only if the writer is behind.
+	   Running free, this is all that holds the callback back, so
+	   every buffer mixed still reaches the file.
+	 */
+	if ( SDL_SemTryWait(this->hidden->empty) != 0 ) {
+		++this->hidden->stalls;
+		SDL_SemWait(this->hidden->empty);
+	}
 }
 
 static void DISKAUD_PlayAudio(_THIS)
 {
-	int written;
-
-	/* Write the audio data */
-	written = SDL_RWwrite(this->hidden->output,
-                        this->hidden->mixbuf, 1,
-                        this->hidden->mixlen);
-
 	/* If we couldn't write, assume fatal error for now */
-	if ( (Uint32)written != this->hidden->mixlen ) {
+	if ( this->hidden->failed ) {
 		this->enabled = 0;
+		return;
 	}
+
+	/* Hand the buffer to the writer thread */
+	if ( this->hidden->played++ == 0 ) {
+		this->hidden->start = SDL_GetPerformanceCounter();
+	}
+	++this->hidden->queued;
+	SDL_SemPost(this->hidden->filled);
+	this->hidden->current = (this->hidden->current + 1) % this->hidden->nbuffers;
 #ifdef DEBUG_AUDIO
-	fprintf(stderr, "Wrote %d bytes of audio data\n", written);
+	fprintf(stderr, "Queued %u bytes of audio data\n", this->hidden->mixlen);
 #endif
 }
 
 static Uint8 *DISKAUD_GetAudioBuf(_THIS)
 {
-	return(this->hidden->mixbuf);
+	return(this->hidden->mixbuf +
+	       this->hidden->current * this->hidden->mixlen);
 }
 
 static void DISKAUD_CloseAudio(_THIS)
 {
+	if ( this->hidden->writer != NULL ) {
+		/* Let the writer finish what's queued and quit */
+		SDL_SemPost(this->hidden->filled);
+		SDL_WaitThread(this->hidden->writer, NULL);
+		this->hidden->writer = NULL;
+#if HAVE_STDIO_H
+		if ( (this->hidden->mode != DISKAUD_MODE_DELAY) &&
+		     (this->hidden->played > 1) ) {
+			double frequency = (double)SDL_GetPerformanceFrequency();
+			double seconds = (double)(SDL_GetPerformanceCounter() -
+			                          this->hidden->start) / frequency;
+			double writing = (double)(this->hidden->finish -
+			                          this->hidden->start) / frequency;
+
+			if ( writing <= 0.0 ) {
+				writing = seconds;
+			}
+			fprintf(stderr, "Disk audio callback: %u buffers, "
+			        "%.1f buffers/s, %.0f bytes/s, "
+			        "%u waits for the writer, %u late\n",
+			        this->hidden->played,
+			        this->hidden->played / seconds,
+			        ((double)this->hidden->played *
+			         this->hidden->mixlen) / seconds,
+			        this->hidden->stalls,
+			        this->hidden->pacer.late);
+			fprintf(stderr, "Disk audio writer: %u buffers, "
+			        "%.1f buffers/s, %.0f bytes/s\n",
+			        this->hidden->written,
+			        this->hidden->written / writing,
+			        ((double)this->hidden->written *
+			         this->hidden->mixlen) / writing);
+		}
+#endif
+	}
+	if ( this->hidden->filled != NULL ) {
+		SDL_DestroySemaphore(this->hidden->filled);
+		this->hidden->filled = NULL;
+	}
+	if ( this->hidden->empty != NULL ) {
+		SDL_DestroySemaphore(this->hidden->empty);
+		this->hidden->empty = NULL;
+	}
 	if ( this->hidden->mixbuf != NULL ) {
 		SDL_FreeAudioMem(this->hidden->mixbuf);
 		this->hidden->mixbuf = NULL;
@@ -160,6 +273,8 @@ static void DISKAUD_CloseAudio(_THIS)
 static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
 {
 	const char *fname = DISKAUD_GetOutputFilename();
+	SDL_ThreadAttr attr;
+	int i;
 
 	/* Open the audio device */
 	this->hidden->output = SDL_RWFromFile(fname, "wb");
@@ -172,13 +287,43 @@ static int DISKAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
                     " audio driver!\n Writing to file [%s].\n", fname);
 #endif
 
-	/* Allocate mixing buffer */
+	/* Allocate the ring of mixing buffers */
 	this->hidden->mixlen = spec->size;
-	this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->mixlen);
+	this->hidden->mixbuf = (Uint8 *) SDL_AllocAudioMem(this->hidden->nbuffers *
+	                                                   this->hidden->mixlen);
 	if ( this->hidden->mixbuf == NULL ) {
+		DISKAUD_CloseAudio(this);
 		return(-1);
 	}
-	SDL_memset(this->hidden->mixbuf, spec->silence, spec->size);
+	for ( i = 0; i < this->hidden->nbuffers; ++i ) {
+		SDL_memset(this->hidden->mixbuf + i * this->hidden->mixlen,
+		           spec->silence, spec->size);
+	}
+
+	/* The audio thread starts out holding the first buffer */
+	this->hidden->current = 0;
+	this->hidden->filled = SDL_CreateSemaphore(0);
+	this->hidden->empty = SDL_CreateSemaphore(this->hidden->nbuffers - 1);
+	if ( !this->hidden->filled || !this->hidden->empty ) {
+		DISKAUD_CloseAudio(this);
+		return(-1);
+	}
+	SDL_memset(&attr, 0, sizeof(attr));
+	attr.name = "SDLDiskAudio";
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThreadWithAttr
+	this->hidden->writer = SDL_CreateThreadWithAttr(DISKAUD_WriterThread, this->hidden, &attr, NULL, NULL);
+#else
+	this->hidden->writer = SDL_CreateThreadWithAttr(DISKAUD_WriterThread, this->hidden, &attr);
+#endif
+	if ( this->hidden->writer == NULL ) {
+		DISKAUD_CloseAudio(this);
+		return(-1);
+	}
+	SDL_StartAudioPacer(&this->hidden->pacer, spec);
+
+	/* Running free, the audio thread mustn't starve the writer */
+	this->freerun = (this->hidden->mode == DISKAUD_MODE_FREERUN);
 
 	/* We're ready to rock and roll. :-) */
 	return(0);
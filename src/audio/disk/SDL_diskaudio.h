@@ -25,17 +25,48 @@
 #define _SDL_diskaudio_h
 
 #include "SDL_rwops.h"
+#include "SDL_thread.h"
+#include "SDL_mutex.h"
 #include "../SDL_sysaudio.h"
+#include "../SDL_audio_c.h"
 
 /* Hidden "this" pointer for the video functions */
 #define _THIS	SDL_AudioDevice *this
 
+/* How the audio thread is paced, see SDL_DISKAUDIOMODE */
+enum {
+	DISKAUD_MODE_DELAY,	/* a fixed delay after each buffer */
+	DISKAUD_MODE_PACED,	/* the rate the audio would play at */
+	DISKAUD_MODE_FREERUN	/* as fast as the writer keeps up */
+};
+
 struct SDL_PrivateAudioData {
 	/* The file descriptor for the audio device */
 	SDL_RWops *output;
 	Uint8 *mixbuf;
 	Uint32 mixlen;
 	Uint32 write_delay;
+	int mode;
+	SDL_AudioPacer pacer;
+
+	/* A ring of nbuffers mix buffers, written out by the writer thread.
+	   The audio thread mixes into buffer current, hands it over by
+	   posting filled and takes the next one by waiting on empty.
+	 */
+	int nbuffers;
+	int current;
+	Uint32 queued;
+	SDL_sem *filled;
+	SDL_sem *empty;
+	SDL_Thread *writer;
+	volatile int failed;
+
+	/* Throughput, reported when the device is closed */
+	Uint64 start;
+	Uint32 played;
+	Uint32 stalls;
+	Uint32 written;
+	Uint64 finish;
 };
 
 #endif /* _SDL_diskaudio_h */
@@ -36,6 +36,9 @@
 /* The tag name used by DUMMY audio */
 #define DUMMYAUD_DRIVER_NAME         "dummy"
 
+/* environment variables and defaults. */
+#define DUMMYENVR_MODE               "SDL_DUMMYAUDIOMODE"
+
 /* Audio driver functions */
 static int DUMMYAUD_OpenAudio(_THIS, SDL_AudioSpec *spec);
 static void DUMMYAUD_WaitAudio(_THIS);
@@ -102,8 +105,8 @@ static void DUMMYAUD_WaitAudio(_THIS)
 	/* Don't block on first calls to simulate initial fragment filling. */
 	if (this->hidden->initial_calls)
 		this->hidden->initial_calls--;
-	else
-		SDL_Delay(this->hidden->write_delay);
+	else if (!this->hidden->freerun)
+		SDL_WaitAudioPacer(&this->hidden->pacer);
 }
 
 static void DUMMYAUD_PlayAudio(_THIS)
@@ -126,7 +129,7 @@ static void DUMMYAUD_CloseAudio(_THIS)
 
 static int DUMMYAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
 {
-	float bytes_per_sec = 0.0f;
+	const char *envr = SDL_getenv(DUMMYENVR_MODE);
 
 	/* Allocate mixing buffer */
 	this->hidden->mixlen = spec->size;
@@ -136,19 +139,18 @@ static int DUMMYAUD_OpenAudio(_THIS, SDL_AudioSpec *spec)
 	}
 	SDL_memset(this->hidden->mixbuf, spec->silence, spec->size);
 
-	bytes_per_sec = (float) (((spec->format & 0xFF) / 8) *
-	                   spec->channels * spec->freq);
-
 	/*
 	 * We try to make this request more audio at the correct rate for
-	 *  a given audio spec, so timing stays fairly faithful.
+	 *  a given audio spec, so timing stays fairly faithful, unless
+	 *  SDL_DUMMYAUDIOMODE is "freerun", which mixes as fast as it can.
 	 * Also, we have it not block at all for the first two calls, so
 	 *  it seems like we're filling two audio fragments right out of the
 	 *  gate, like other SDL drivers tend to do.
 	 */
 	this->hidden->initial_calls = 2;
-	this->hidden->write_delay =
-	               (Uint32) ((((float) spec->size) / bytes_per_sec) * 1000.0f);
+	this->hidden->freerun = (envr && (SDL_strcmp(envr, "freerun") == 0));
+	this->freerun = this->hidden->freerun;
+	SDL_StartAudioPacer(&this->hidden->pacer, spec);
 
 	/* We're ready to rock and roll. :-) */
 	return(0);
@@ -25,6 +25,7 @@
 #define _SDL_dummyaudio_h
 
 #include "../SDL_sysaudio.h"
+#include "../SDL_audio_c.h"
 
 /* Hidden "this" pointer for the video functions */
 #define _THIS	SDL_AudioDevice *this
@@ -33,8 +34,9 @@ struct SDL_PrivateAudioData {
 	/* The file descriptor for the audio device */
 	Uint8 *mixbuf;
 	Uint32 mixlen;
-	Uint32 write_delay;
 	Uint32 initial_calls;
+	int freerun;
+	SDL_AudioPacer pacer;
 };
 
 #endif /* _SDL_dummyaudio_h */
@@ -69,6 +69,17 @@
 #include <swis.h>
 #endif
 
+#if defined(_MSC_VER) && (_MSC_VER >= 1600) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>	/* For __cpuidex() and _xgetbv() */
+#endif
+
+#if defined(__WIN32__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>	/* For GetSystemInfo() */
+#elif defined(__unix__) || defined(__unix) || defined(__MACOSX__)
+#include <unistd.h>	/* For sysconf() */
+#endif
+
 #define CPU_HAS_RDTSC	0x00000001
 #define CPU_HAS_MMX	0x00000002
 #define CPU_HAS_MMXEXT	0x00000004
@@ -79,6 +90,8 @@
 #define CPU_HAS_ALTIVEC	0x00000100
 #define CPU_HAS_ARM_SIMD 0x00000200
 #define CPU_HAS_NEON     0x00000400
+#define CPU_HAS_AVX2	0x00000800
+#define CPU_HAS_AVX512VBMI 0x00001000
 
 #if SDL_ALTIVEC_BLITTERS && HAVE_SETJMP && !__MACOSX__ && !__OpenBSD__
 /* This is the brute force way of detecting instruction sets...
@@ -395,6 +408,98 @@ static __inline__ int CPU_haveSSE2(void)
 	return 0;
 }
 
+/* AVX2 and AVX-512 detection
+ * Not public - for internal software gamma use only
+ * These also need CPUID leaf 7 and the OS to save the wider registers.
+ */
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define CPU_HAVE_CPUID_LEAF7
+static __inline__ void CPU_getCPUID(int leaf, int regs[4])
+{
+#if defined(__i386__)
+	/* %ebx may be the PIC register, so swap it out around cpuid */
+	__asm__ (
+"        movl    %%ebx,%1              \n"
+"        cpuid                         \n"
+"        xchgl   %%ebx,%1              \n"
+	: "=a" (regs[0]), "=&r" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (0)
+	);
+#else
+	__asm__ (
+"        cpuid                         \n"
+	: "=a" (regs[0]), "=b" (regs[1]), "=c" (regs[2]), "=d" (regs[3])
+	: "a" (leaf), "c" (0)
+	);
+#endif
+}
+
+static __inline__ Uint32 CPU_getXCR0(void)
+{
+	Uint32 lo, hi;
+
+	/* xgetbv, spelled out for assemblers that don't know it */
+	__asm__ (
+"        .byte   0x0f, 0x01, 0xd0      \n"
+	: "=a" (lo), "=d" (hi)
+	: "c" (0)
+	);
+	return lo;
+}
+#elif defined(_MSC_VER) && (_MSC_VER >= 1600) && (defined(_M_IX86) || defined(_M_X64))
+#define CPU_HAVE_CPUID_LEAF7
+static __inline__ void CPU_getCPUID(int leaf, int regs[4])
+{
+	__cpuidex(regs, leaf, 0);
+}
+
+static __inline__ Uint32 CPU_getXCR0(void)
+{
+	return (Uint32)_xgetbv(0);
+}
+#endif
+
+/* Check the CPUID leaf 7 feature bits, and that the OS saves the
+   register state named by 'xcr0' */
+static __inline__ int CPU_haveLeaf7Features(Uint32 xcr0, int ebx, int ecx)
+{
+#ifdef CPU_HAVE_CPUID_LEAF7
+	int regs[4];
+
+	if ( ! CPU_haveCPUID() ) {
+		return 0;
+	}
+	CPU_getCPUID(0, regs);
+	if ( regs[0] < 7 ) {
+		return 0;
+	}
+	/* OSXSAVE and AVX */
+	CPU_getCPUID(1, regs);
+	if ( (regs[2] & 0x18000000) != 0x18000000 ) {
+		return 0;
+	}
+	if ( (CPU_getXCR0() & xcr0) != xcr0 ) {
+		return 0;
+	}
+	CPU_getCPUID(7, regs);
+	return ((regs[1] & ebx) == ebx) && ((regs[2] & ecx) == ecx);
+#else
+	return 0;
+#endif
+}
+
+static __inline__ int CPU_haveAVX2(void)
+{
+	/* XMM and YMM state; AVX2 */
+	return CPU_haveLeaf7Features(0x06, 0x00000020, 0);
+}
+
+static __inline__ int CPU_haveAVX512VBMI(void)
+{
+	/* XMM, YMM, opmask and ZMM state; AVX512F and AVX512BW; AVX512VBMI */
+	return CPU_haveLeaf7Features(0xE6, 0x40010000, 0x00000002);
+}
+
 static __inline__ int CPU_haveAltiVec(void)
 {
 	volatile int altivec = 0;
@@ -599,6 +704,12 @@ static Uint32 SDL_GetCPUFeatures(void)
 		if ( CPU_haveSSE2() ) {
 			SDL_CPUFeatures |= CPU_HAS_SSE2;
 		}
+		if ( CPU_haveAVX2() ) {
+			SDL_CPUFeatures |= CPU_HAS_AVX2;
+		}
+		if ( CPU_haveAVX512VBMI() ) {
+			SDL_CPUFeatures |= CPU_HAS_AVX512VBMI;
+		}
 		if ( CPU_haveAltiVec() ) {
 			SDL_CPUFeatures |= CPU_HAS_ALTIVEC;
 		}
@@ -668,6 +779,22 @@ SDL_bool SDL_HasSSE2(void)
 	return SDL_FALSE;
 }
 
+SDL_bool SDL_HasAVX2(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_AVX2 ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
+SDL_bool SDL_HasAVX512VBMI(void)
+{
+	if ( SDL_GetCPUFeatures() & CPU_HAS_AVX512VBMI ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
 SDL_bool SDL_HasAltiVec(void)
 {
 	if ( SDL_GetCPUFeatures() & CPU_HAS_ALTIVEC ) {
@@ -692,6 +819,32 @@ SDL_bool SDL_HasNEON(void)
 	return SDL_FALSE;
 }
 
+static int SDL_CPUCount = 0;
+
+int SDL_GetCPUCount(void)
+{
+	if ( SDL_CPUCount <= 0 ) {
+		int count = 1;
+#if defined(__WIN32__)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		count = (int)info.dwNumberOfProcessors;
+#elif defined(__VITA__)
+		/* The fourth core is kept for the system */
+		count = 3;
+#elif defined(_SC_NPROCESSORS_ONLN)
+		count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#elif defined(_SC_NPROCESSORS_CONF)
+		count = (int)sysconf(_SC_NPROCESSORS_CONF);
+#endif
+		if ( count <= 0 ) {
+			count = 1;
+		}
+		SDL_CPUCount = count;
+	}
+	return SDL_CPUCount;
+}
+
 #ifdef TEST_MAIN
 
 #include <stdio.h>
@@ -705,9 +858,12 @@ int main()
 	printf("3DNowExt: %d\n", SDL_Has3DNowExt());
 	printf("SSE: %d\n", SDL_HasSSE());
 	printf("SSE2: %d\n", SDL_HasSSE2());
+	printf("AVX2: %d\n", SDL_HasAVX2());
+	printf("AVX-512 VBMI: %d\n", SDL_HasAVX512VBMI());
 	printf("AltiVec: %d\n", SDL_HasAltiVec());
 	printf("ARM SIMD: %d\n", SDL_HasARMSIMD());
 	printf("NEON: %d\n", SDL_HasNEON());
+	printf("CPU count: %d\n", SDL_GetCPUCount());
 	return 0;
 }
 
@@ -143,6 +143,8 @@ static int SDLCALL SDL_GobbleEvents(void *unused)
 
 static int SDL_StartEventThread(Uint32 flags)
 {
+	SDL_ThreadAttr attr;
+
 	/* Reset everything to zero */
 	SDL_EventThread = NULL;
 	SDL_memset(&SDL_EventLock, 0, sizeof(SDL_EventLock));
@@ -169,11 +171,14 @@ static int SDL_StartEventThread(Uint32 flags)
 
 		/* The event thread will handle timers too */
 		SDL_SetTimerThreaded(2);
+		SDL_memset(&attr, 0, sizeof(attr));
+		attr.name = "SDLEvents";
+		attr.priority = SDL_THREAD_PRIORITY_HIGH;
 #if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
-#undef SDL_CreateThread
-		SDL_EventThread = SDL_CreateThread(SDL_GobbleEvents, NULL, NULL, NULL);
+#undef SDL_CreateThreadWithAttr
+		SDL_EventThread = SDL_CreateThreadWithAttr(SDL_GobbleEvents, NULL, &attr, NULL, NULL);
 #else
-		SDL_EventThread = SDL_CreateThread(SDL_GobbleEvents, NULL);
+		SDL_EventThread = SDL_CreateThreadWithAttr(SDL_GobbleEvents, NULL, &attr);
 #endif
 		if ( SDL_EventThread == NULL ) {
 			return(-1);
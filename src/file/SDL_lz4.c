@@ -0,0 +1,230 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* This is an implementation of the LZ4 block format:
+
+   Each sequence starts with a token byte, the high nibble holding the
+   literal count and the low nibble the match length minus 4, a nibble
+   of 15 meaning more length bytes follow.  The literals come next, then
+   a little-endian 16-bit match offset.  The last sequence of a block
+   only carries literals.
+*/
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+#include "SDL_lz4_c.h"
+
+#define LZ4_MINMATCH		4
+#define LZ4_LASTLITERALS	5	/* The last 5 bytes are always literals */
+#define LZ4_MFLIMIT		12	/* The last match starts 12 bytes before the end */
+#define LZ4_MAXOFFSET		65535
+#define LZ4_HASHLOG		12
+
+static __inline__ Uint32 LZ4_Read32(const Uint8 *p)
+{
+	Uint32 value;
+
+	SDL_memcpy(&value, p, sizeof(value));
+	return(value);
+}
+
+static __inline__ Uint32 LZ4_Hash(Uint32 sequence)
+{
+	return((sequence * 2654435761U) >> (32 - LZ4_HASHLOG));
+}
+
+static Uint8 *LZ4_PutLength(Uint8 *op, int length)
+{
+	length -= 15;
+	while ( length >= 255 ) {
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (Uint8)length;
+	return(op);
+}
+
+static Uint8 *LZ4_PutLiterals(Uint8 *op, const Uint8 *anchor, int length, int matchlength)
+{
+	Uint8 *token = op++;
+
+	if ( length >= 15 ) {
+		*token = (15 << 4);
+		op = LZ4_PutLength(op, length);
+	} else {
+		*token = (Uint8)(length << 4);
+	}
+	SDL_memcpy(op, anchor, length);
+	op += length;
+
+	if ( matchlength >= 0 ) {
+		*token |= (matchlength >= 15) ? 15 : (Uint8)matchlength;
+	}
+	return(op);
+}
+
+int SDL_LZ4_Compress(const void *source, int srclen, void *dest, int dstlen)
+{
+	const Uint8 *src = (const Uint8 *)source;
+	const Uint8 *ip = src;
+	const Uint8 *anchor = src;
+	const Uint8 *iend = src + srclen;
+	const Uint8 *mflimit = iend - LZ4_MFLIMIT;
+	const Uint8 *matchlimit = iend - LZ4_LASTLITERALS;
+	Uint8 *op = (Uint8 *)dest;
+	int *table;
+
+	if ( (srclen < 0) || (dstlen < SDL_LZ4_COMPRESSBOUND(srclen)) ) {
+		SDL_SetError("LZ4 output buffer too small");
+		return(-1);
+	}
+	table = (int *)SDL_malloc(sizeof(*table) << LZ4_HASHLOG);
+	if ( table == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	SDL_memset(table, 0xFF, sizeof(*table) << LZ4_HASHLOG);
+
+	if ( srclen > LZ4_MFLIMIT ) {
+		while ( ip <= mflimit ) {
+			const Uint32 sequence = LZ4_Read32(ip);
+			const Uint32 h = LZ4_Hash(sequence);
+			const Uint8 *match;
+			const Uint8 *mp;
+			int ref = table[h];
+			int matchlength;
+			Uint16 offset;
+
+			table[h] = (int)(ip - src);
+			if ( (ref < 0) || ((ip - src) - ref > LZ4_MAXOFFSET) ||
+			     (LZ4_Read32(src + ref) != sequence) ) {
+				++ip;
+				continue;
+			}
+
+			/* Extend the match as far as the block allows */
+			match = src + ref;
+			mp = ip + LZ4_MINMATCH;
+			while ( (mp < matchlimit) && (*mp == match[mp - ip]) ) {
+				++mp;
+			}
+			matchlength = (int)(mp - ip) - LZ4_MINMATCH;
+
+			op = LZ4_PutLiterals(op, anchor, (int)(ip - anchor), matchlength);
+			offset = (Uint16)(ip - match);
+			*op++ = (Uint8)(offset & 0xFF);
+			*op++ = (Uint8)(offset >> 8);
+			if ( matchlength >= 15 ) {
+				op = LZ4_PutLength(op, matchlength);
+			}
+			ip = mp;
+			anchor = ip;
+		}
+	}
+
+	/* The remaining bytes are stored as the final literal run */
+	op = LZ4_PutLiterals(op, anchor, (int)(iend - anchor), -1);
+
+	SDL_free(table);
+	return((int)(op - (Uint8 *)dest));
+}
+
+int SDL_LZ4_Decompress(const void *source, int srclen, void *dest, int dstlen)
+{
+	const Uint8 *ip = (const Uint8 *)source;
+	const Uint8 *iend = ip + srclen;
+	Uint8 *ostart = (Uint8 *)dest;
+	Uint8 *op = ostart;
+	Uint8 *oend = ostart + dstlen;
+
+	while ( ip < iend ) {
+		const unsigned int token = *ip++;
+		const Uint8 *match;
+		size_t length;
+		size_t offset;
+		Uint8 extra;
+
+		/* Copy the literals */
+		length = (token >> 4);
+		if ( length == 15 ) {
+			do {
+				if ( ip >= iend ) {
+					goto corrupt;
+				}
+				extra = *ip++;
+				length += extra;
+			} while ( extra == 255 );
+		}
+		if ( ((size_t)(iend - ip) < length) ||
+		     ((size_t)(oend - op) < length) ) {
+			goto corrupt;
+		}
+		SDL_memcpy(op, ip, length);
+		op += length;
+		ip += length;
+
+		/* The last sequence has no match part */
+		if ( ip >= iend ) {
+			break;
+		}
+
+		/* Copy the match */
+		if ( (iend - ip) < 2 ) {
+			goto corrupt;
+		}
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if ( (offset == 0) || (offset > (size_t)(op - ostart)) ) {
+			goto corrupt;
+		}
+		length = (token & 15);
+		if ( length == 15 ) {
+			do {
+				if ( ip >= iend ) {
+					goto corrupt;
+				}
+				extra = *ip++;
+				length += extra;
+			} while ( extra == 255 );
+		}
+		length += LZ4_MINMATCH;
+		if ( (size_t)(oend - op) < length ) {
+			goto corrupt;
+		}
+		match = op - offset;
+		if ( offset >= length ) {
+			SDL_memcpy(op, match, length);
+			op += length;
+		} else {
+			/* Overlapping copy, used for runs */
+			while ( length-- ) {
+				*op++ = *match++;
+			}
+		}
+	}
+	return((int)(op - ostart));
+
+corrupt:
+	SDL_SetError("Corrupt LZ4 data");
+	return(-1);
+}
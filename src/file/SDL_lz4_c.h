@@ -0,0 +1,47 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_lz4_c_h
+#define _SDL_lz4_c_h
+
+/* A small LZ4 block format codec, used by the SDL data containers.
+
+   Compression is a greedy single-probe hash search, which trades ratio
+   for speed; decompression is bounds checked and safe on corrupt input.
+*/
+
+/* The largest buffer that compressing 'size' bytes can ever need */
+#define SDL_LZ4_COMPRESSBOUND(size)	((size) + ((size) / 255) + 16)
+
+/* Compress 'srclen' bytes into 'dst', which must have room for at least
+   SDL_LZ4_COMPRESSBOUND(srclen) bytes.
+   Returns the compressed size, or -1 on error.
+ */
+extern int SDL_LZ4_Compress(const void *src, int srclen, void *dst, int dstlen);
+
+/* Decompress 'srclen' bytes into 'dst', which has room for 'dstlen' bytes.
+   Returns the decompressed size, or -1 if the data is corrupt.
+ */
+extern int SDL_LZ4_Decompress(const void *src, int srclen, void *dst, int dstlen);
+
+#endif /* _SDL_lz4_c_h */
@@ -0,0 +1,511 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Asynchronous reads from SDL_RWops data sources, serviced by a small
+   pool of worker threads.  Reads queued for the same source are done
+   one after another by a single worker, so the source is never used by
+   two threads at once, and reads that continue where the previous one
+   stopped are done without seeking in between.
+ */
+
+#include "SDL_rwops.h"
+#include "SDL_events.h"
+#include "SDL_thread.h"
+#include "SDL_atomic.h"
+
+#define RWASYNC_QUEUED	0
+#define RWASYNC_RUNNING	1
+#define RWASYNC_DONE	2
+
+#define RWASYNC_DEFAULT_THREADS	2
+#define RWASYNC_MAX_THREADS	8
+
+/* The most data coalesced into one batch of reads */
+#define RWASYNC_MAX_BATCH	(1024*1024)
+
+struct SDL_RWasync {
+	SDL_RWops *src;
+	Sint64 offset;
+	void *ptr;
+	int size;
+	SDL_RWasyncCallback callback;
+	void *userdata;
+	int state;
+	int result;
+	struct SDL_RWasync *next;
+};
+
+/* Deliver the result of a finished read, on the thread that did it.
+   The request is already marked done and may have been released by now,
+   so only its address is passed on.
+ */
+static void SDL_RWasyncNotify(SDL_RWasync *request, SDL_RWasyncCallback callback, void *userdata, int result)
+{
+	if ( callback ) {
+		callback(userdata, request, result);
+	} else {
+#if !SDL_EVENTS_DISABLED
+		SDL_Event event;
+
+		event.type = SDL_RWASYNCEVENT;
+		event.user.code = result;
+		event.user.data1 = request;
+		event.user.data2 = userdata;
+		SDL_PushEvent(&event);
+#endif
+	}
+}
+
+/* Read one batch of requests on the same source, in offset order */
+static void SDL_RWasyncRead(SDL_RWasync *batch)
+{
+	SDL_RWasync *request;
+	int ok;
+
+	ok = (SDL_RWseek64(batch->src, batch->offset, RW_SEEK_SET) == batch->offset);
+	for ( request = batch; request; request = request->next ) {
+		if ( ok ) {
+			request->result = SDL_RWread(request->src,
+						request->ptr, 1, request->size);
+			/* A short read leaves the source somewhere else */
+			ok = (request->result == request->size);
+		} else {
+			request->result = -1;
+		}
+	}
+}
+
+#if SDL_THREADS_DISABLED
+
+/* Without threads the reads are done right away */
+
+SDL_RWasync *SDL_RWreadAsync(SDL_RWops *src, Sint64 offset, void *ptr, int size, SDL_RWasyncCallback callback, void *userdata)
+{
+	SDL_RWasync *request;
+
+	if ( (src == NULL) || (offset < 0) || (size < 0) ) {
+		SDL_SetError("SDL_RWreadAsync(): Invalid parameter");
+		return(NULL);
+	}
+	request = (SDL_RWasync *)SDL_malloc(sizeof(*request));
+	if ( request == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	request->src = src;
+	request->offset = offset;
+	request->ptr = ptr;
+	request->size = size;
+	request->callback = callback;
+	request->userdata = userdata;
+	request->next = NULL;
+	SDL_RWasyncRead(request);
+	request->state = RWASYNC_DONE;
+	SDL_RWasyncNotify(request, callback, userdata, request->result);
+	return(request);
+}
+
+int SDL_RWcancelAsync(SDL_RWasync *request)
+{
+	return(-1);
+}
+
+int SDL_RWwaitAsync(SDL_RWasync *request)
+{
+	int result;
+
+	if ( request == NULL ) {
+		SDL_SetError("SDL_RWwaitAsync(): Invalid parameter");
+		return(-1);
+	}
+	result = request->result;
+	SDL_free(request);
+	return(result);
+}
+
+void SDL_RWasyncQuit(void)
+{
+}
+
+#else
+
+static SDL_SpinLock async_init_lock = 0;
+static SDL_mutex *async_lock = NULL;
+static SDL_cond *async_work = NULL;
+static SDL_cond *async_done = NULL;
+static SDL_Thread *async_threads[RWASYNC_MAX_THREADS];
+static SDL_RWops *async_busy[RWASYNC_MAX_THREADS];
+static int async_numthreads = 0;
+static int async_waiters = 0;
+static int async_quit = 0;
+static SDL_RWasync *async_queue = NULL;
+static SDL_RWasync *async_queue_tail = NULL;
+
+/* Remove a request from the queue, given the one before it */
+static void SDL_RWasyncUnlink(SDL_RWasync *prev, SDL_RWasync *request)
+{
+	if ( prev ) {
+		prev->next = request->next;
+	} else {
+		async_queue = request->next;
+	}
+	if ( async_queue_tail == request ) {
+		async_queue_tail = prev;
+	}
+	request->next = NULL;
+}
+
+static SDL_bool SDL_RWasyncBusy(SDL_RWops *src)
+{
+	int i;
+
+	for ( i = 0; i < async_numthreads; ++i ) {
+		if ( async_busy[i] == src ) {
+			return(SDL_TRUE);
+		}
+	}
+	return(SDL_FALSE);
+}
+
+/* Take the oldest request on a source nobody is reading from, along with
+   the queued requests that continue it.  Called with the lock held.
+ */
+static SDL_RWasync *SDL_RWasyncTakeBatch(void)
+{
+	SDL_RWasync *prev, *request;
+	SDL_RWasync *batch, *last;
+	Sint64 end;
+	int total;
+
+	prev = NULL;
+	for ( request = async_queue; request; request = request->next ) {
+		if ( ! SDL_RWasyncBusy(request->src) ) {
+			break;
+		}
+		prev = request;
+	}
+	if ( request == NULL ) {
+		return(NULL);
+	}
+	SDL_RWasyncUnlink(prev, request);
+	request->state = RWASYNC_RUNNING;
+	batch = last = request;
+	end = request->offset + request->size;
+	total = request->size;
+
+	while ( total < RWASYNC_MAX_BATCH ) {
+		prev = NULL;
+		for ( request = async_queue; request; request = request->next ) {
+			if ( (request->src == batch->src) &&
+			     (request->offset == end) ) {
+				break;
+			}
+			prev = request;
+		}
+		if ( request == NULL ) {
+			break;
+		}
+		SDL_RWasyncUnlink(prev, request);
+		request->state = RWASYNC_RUNNING;
+		last->next = request;
+		last = request;
+		end += request->size;
+		total += request->size;
+	}
+	return(batch);
+}
+
+/* Mark a request done and deliver its result.  From then on a waiting
+   thread, or the callback itself, may release the request, so nothing in
+   it is touched afterwards.
+ */
+static void SDL_RWasyncFinish(SDL_RWasync *request)
+{
+	SDL_RWasyncCallback callback = request->callback;
+	void *userdata = request->userdata;
+	int result = request->result;
+
+	SDL_mutexP(async_lock);
+	request->next = NULL;
+	request->state = RWASYNC_DONE;
+	SDL_CondBroadcast(async_done);
+	SDL_mutexV(async_lock);
+
+	SDL_RWasyncNotify(request, callback, userdata, result);
+}
+
+static int SDLCALL SDL_RWasyncThread(void *data)
+{
+	int slot = (int)(size_t)data;
+	SDL_RWasync *batch, *request, *next;
+
+	SDL_mutexP(async_lock);
+	while ( ! async_quit ) {
+		batch = SDL_RWasyncTakeBatch();
+		if ( batch == NULL ) {
+			SDL_CondWait(async_work, async_lock);
+			continue;
+		}
+		async_busy[slot] = batch->src;
+		SDL_mutexV(async_lock);
+
+		SDL_RWasyncRead(batch);
+		for ( request = batch; request; request = next ) {
+			next = request->next;
+			SDL_RWasyncFinish(request);
+		}
+
+		SDL_mutexP(async_lock);
+		async_busy[slot] = NULL;
+
+		/* Requests on this source may have been waiting for us */
+		SDL_CondSignal(async_work);
+	}
+	SDL_mutexV(async_lock);
+	return(0);
+}
+
+/* Start the worker threads, called with the lock held */
+static int SDL_RWasyncStart(void)
+{
+	SDL_ThreadAttr attr;
+	const char *env;
+	int i, numthreads;
+
+	numthreads = RWASYNC_DEFAULT_THREADS;
+	env = SDL_getenv("SDL_RWASYNC_THREADS");
+	if ( env ) {
+		numthreads = SDL_atoi(env);
+		if ( numthreads < 1 ) {
+			numthreads = 1;
+		}
+		if ( numthreads > RWASYNC_MAX_THREADS ) {
+			numthreads = RWASYNC_MAX_THREADS;
+		}
+	}
+
+	async_quit = 0;
+	SDL_memset(&attr, 0, sizeof(attr));
+	attr.name = "SDLAsyncIO";
+	for ( i = 0; i < numthreads; ++i ) {
+		async_busy[i] = NULL;
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThreadWithAttr
+		async_threads[i] = SDL_CreateThreadWithAttr(SDL_RWasyncThread, (void *)(size_t)i, &attr, NULL, NULL);
+#else
+		async_threads[i] = SDL_CreateThreadWithAttr(SDL_RWasyncThread, (void *)(size_t)i, &attr);
+#endif
+		if ( async_threads[i] == NULL ) {
+			break;
+		}
+		++async_numthreads;
+	}
+	if ( async_numthreads == 0 ) {
+		SDL_SetError("Couldn't create asynchronous I/O thread");
+		return(-1);
+	}
+	return(0);
+}
+
+/* Take the lock, creating it and the conditions first if 'create' is
+   set.  The first reads may race to create them, and SDL_RWasyncQuit()
+   destroys them, so the pointers are only read under async_init_lock.
+ */
+static int SDL_RWasyncLock(int create)
+{
+	int retval = 0;
+
+	SDL_AtomicLock(&async_init_lock);
+	if ( (async_lock == NULL) && create ) {
+		async_work = SDL_CreateCond();
+		async_done = SDL_CreateCond();
+		async_lock = SDL_CreateMutex();
+		if ( !async_work || !async_done || !async_lock ) {
+			if ( async_work ) {
+				SDL_DestroyCond(async_work);
+				async_work = NULL;
+			}
+			if ( async_done ) {
+				SDL_DestroyCond(async_done);
+				async_done = NULL;
+			}
+			if ( async_lock ) {
+				SDL_DestroyMutex(async_lock);
+				async_lock = NULL;
+			}
+		}
+	}
+	if ( async_lock ) {
+		SDL_mutexP(async_lock);
+	} else {
+		retval = -1;
+	}
+	SDL_AtomicUnlock(&async_init_lock);
+	return(retval);
+}
+
+SDL_RWasync *SDL_RWreadAsync(SDL_RWops *src, Sint64 offset, void *ptr, int size, SDL_RWasyncCallback callback, void *userdata)
+{
+	SDL_RWasync *request;
+
+	if ( (src == NULL) || (offset < 0) || (size < 0) ) {
+		SDL_SetError("SDL_RWreadAsync(): Invalid parameter");
+		return(NULL);
+	}
+
+	request = (SDL_RWasync *)SDL_malloc(sizeof(*request));
+	if ( request == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	request->src = src;
+	request->offset = offset;
+	request->ptr = ptr;
+	request->size = size;
+	request->callback = callback;
+	request->userdata = userdata;
+	request->state = RWASYNC_QUEUED;
+	request->result = -1;
+	request->next = NULL;
+
+	if ( SDL_RWasyncLock(1) < 0 ) {
+		SDL_free(request);
+		return(NULL);
+	}
+	if ( (async_numthreads == 0) && (SDL_RWasyncStart() < 0) ) {
+		SDL_mutexV(async_lock);
+		SDL_free(request);
+		return(NULL);
+	}
+	if ( async_queue_tail ) {
+		async_queue_tail->next = request;
+	} else {
+		async_queue = request;
+	}
+	async_queue_tail = request;
+	SDL_CondSignal(async_work);
+	SDL_mutexV(async_lock);
+
+	return(request);
+}
+
+int SDL_RWcancelAsync(SDL_RWasync *request)
+{
+	SDL_RWasync *prev, *queued;
+	int retval = -1;
+
+	if ( (request == NULL) || (SDL_RWasyncLock(0) < 0) ) {
+		return(-1);
+	}
+	if ( request->state == RWASYNC_QUEUED ) {
+		prev = NULL;
+		for ( queued = async_queue; queued; queued = queued->next ) {
+			if ( queued == request ) {
+				SDL_RWasyncUnlink(prev, request);
+				break;
+			}
+			prev = queued;
+		}
+		request->state = RWASYNC_DONE;
+		request->result = SDL_RWASYNC_CANCELLED;
+		SDL_CondBroadcast(async_done);
+		retval = 0;
+	}
+	SDL_mutexV(async_lock);
+	return(retval);
+}
+
+int SDL_RWwaitAsync(SDL_RWasync *request)
+{
+	int result;
+
+	if ( request == NULL ) {
+		SDL_SetError("SDL_RWwaitAsync(): Invalid parameter");
+		return(-1);
+	}
+	if ( SDL_RWasyncLock(0) == 0 ) {
+		++async_waiters;
+		while ( request->state != RWASYNC_DONE ) {
+			SDL_CondWait(async_done, async_lock);
+		}
+		/* SDL_RWasyncQuit() waits for us to leave */
+		if ( (--async_waiters == 0) && async_quit ) {
+			SDL_CondBroadcast(async_done);
+		}
+		SDL_mutexV(async_lock);
+	}
+	result = request->result;
+	SDL_free(request);
+	return(result);
+}
+
+/* Called by SDL_Quit(), reads that haven't started are cancelled */
+void SDL_RWasyncQuit(void)
+{
+	SDL_RWasync *queue, *request, *next;
+	int i;
+
+	if ( SDL_RWasyncLock(0) < 0 ) {
+		return;
+	}
+	async_quit = 1;
+	SDL_CondBroadcast(async_work);
+	SDL_mutexV(async_lock);
+	for ( i = 0; i < async_numthreads; ++i ) {
+		SDL_WaitThread(async_threads[i], NULL);
+		async_threads[i] = NULL;
+	}
+	async_numthreads = 0;
+
+	SDL_mutexP(async_lock);
+	queue = async_queue;
+	async_queue = NULL;
+	async_queue_tail = NULL;
+	SDL_mutexV(async_lock);
+
+	for ( request = queue; request; request = next ) {
+		next = request->next;
+		request->result = SDL_RWASYNC_CANCELLED;
+		SDL_RWasyncFinish(request);
+	}
+
+	/* Every request is done now, wait for the threads that were
+	   waiting on one to let go of the lock before destroying it.
+	   Holding async_init_lock keeps new waiters out meanwhile.
+	 */
+	SDL_AtomicLock(&async_init_lock);
+	SDL_mutexP(async_lock);
+	while ( async_waiters > 0 ) {
+		SDL_CondWait(async_done, async_lock);
+	}
+	SDL_mutexV(async_lock);
+	SDL_DestroyCond(async_done);
+	async_done = NULL;
+	SDL_DestroyCond(async_work);
+	async_work = NULL;
+	SDL_DestroyMutex(async_lock);
+	async_lock = NULL;
+	SDL_AtomicUnlock(&async_init_lock);
+}
+
+#endif /* SDL_THREADS_DISABLED */
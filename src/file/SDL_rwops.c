@@ -28,6 +28,14 @@
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
 
+#ifdef HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 #if defined(__WIN32__) && !defined(__SYMBIAN32__)
 
@@ -183,10 +191,11 @@ static int SDLCALL win32_file_open(SDL_RWops *context, const char *filename, con
 
 	return 0; /* ok */
 }
-static int SDLCALL win32_file_seek(SDL_RWops *context, int offset, int whence)
+static Sint64 win32_file_seek64(SDL_RWops *context, Sint64 offset, int whence)
 {
 	DWORD win32whence;
-	int   file_pos;
+	LONG  offset_high;
+	DWORD offset_low;
 	
 	if (!context || context->hidden.win32io.h == INVALID_HANDLE_VALUE) {
 		SDL_SetError("win32_file_seek: invalid context/file not opened");
@@ -211,14 +220,26 @@ static int SDLCALL win32_file_seek(SDL_RWops *context, int offset, int whence)
 			return -1;
 	}
 
-	file_pos = SetFilePointer(context->hidden.win32io.h,offset,NULL,win32whence);
+	offset_high = (LONG)(offset >> 32);
+	offset_low = SetFilePointer(context->hidden.win32io.h,(LONG)offset,&offset_high,win32whence);
 
-	if ( file_pos != INVALID_SET_FILE_POINTER )
-		return file_pos; /* success */
+	if ( offset_low != INVALID_SET_FILE_POINTER || GetLastError() == NO_ERROR )
+		return ((Sint64)offset_high << 32) | offset_low; /* success */
 	
 	SDL_Error(SDL_EFSEEK);
 	return -1; /* error */
 }
+static int SDLCALL win32_file_seek(SDL_RWops *context, int offset, int whence)
+{
+	Sint64 file_pos;
+
+	file_pos = win32_file_seek64(context, offset, whence);
+	if ( file_pos > 0x7FFFFFFF ) {
+		SDL_SetError("File offset too large, use SDL_RWseek64()");
+		return -1;
+	}
+	return (int)file_pos;
+}
 static int SDLCALL win32_file_read(SDL_RWops *context, void *ptr, int size, int maxnum)
 {
 	int		total_need; 
@@ -323,12 +344,33 @@ static int SDLCALL win32_file_close(SDL_RWops *context)
 static int SDLCALL stdio_seek(SDL_RWops *context, int offset, int whence)
 {
 	if ( fseek(context->hidden.stdio.fp, offset, whence) == 0 ) {
-		return(ftell(context->hidden.stdio.fp));
+		long pos = ftell(context->hidden.stdio.fp);
+		if ( pos > 0x7FFFFFFF ) {
+			SDL_SetError("File offset too large, use SDL_RWseek64()");
+			return(-1);
+		}
+		return((int)pos);
 	} else {
 		SDL_Error(SDL_EFSEEK);
 		return(-1);
 	}
 }
+static Sint64 stdio_seek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+#ifdef HAVE_FSEEKO
+	if ( (Sint64)(off_t)offset == offset &&
+	     fseeko(context->hidden.stdio.fp, (off_t)offset, whence) == 0 ) {
+		return(ftello(context->hidden.stdio.fp));
+	}
+#else
+	if ( (Sint64)(long)offset == offset &&
+	     fseek(context->hidden.stdio.fp, (long)offset, whence) == 0 ) {
+		return(ftell(context->hidden.stdio.fp));
+	}
+#endif
+	SDL_Error(SDL_EFSEEK);
+	return(-1);
+}
 static int SDLCALL stdio_read(SDL_RWops *context, void *ptr, int size, int maxnum)
 {
 	size_t nread;
@@ -388,9 +430,41 @@ static int SDLCALL mem_seek(SDL_RWops *context, int offset, int whence)
 	if ( newpos > context->hidden.mem.stop ) {
 		newpos = context->hidden.mem.stop;
 	}
+	if ( (size_t)(newpos-context->hidden.mem.base) > 0x7FFFFFFF ) {
+		SDL_SetError("Memory offset too large, use SDL_RWseek64()");
+		return(-1);
+	}
 	context->hidden.mem.here = newpos;
 	return(context->hidden.mem.here-context->hidden.mem.base);
 }
+static Sint64 mem_seek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+	Sint64 size = context->hidden.mem.stop-context->hidden.mem.base;
+	Sint64 newpos;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			newpos = offset;
+			break;
+		case RW_SEEK_CUR:
+			newpos = (context->hidden.mem.here-context->hidden.mem.base)+offset;
+			break;
+		case RW_SEEK_END:
+			newpos = size+offset;
+			break;
+		default:
+			SDL_SetError("Unknown value for 'whence'");
+			return(-1);
+	}
+	if ( newpos < 0 ) {
+		newpos = 0;
+	}
+	if ( newpos > size ) {
+		newpos = size;
+	}
+	context->hidden.mem.here = context->hidden.mem.base+(size_t)newpos;
+	return(newpos);
+}
 static int SDLCALL mem_read(SDL_RWops *context, void *ptr, int size, int maxnum)
 {
 	size_t total_bytes;
@@ -433,6 +507,208 @@ static int SDLCALL mem_close(SDL_RWops *context)
 	return(0);
 }
 
+/* Functions to release memory-mapped files, which are read like memory */
+
+#ifdef HAVE_MMAP
+static int SDLCALL mapped_close(SDL_RWops *context)
+{
+	if ( context ) {
+		if ( context->hidden.mem.base ) {
+			munmap(context->hidden.mem.base,
+			       context->hidden.mem.stop-context->hidden.mem.base);
+		}
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+#else
+static int SDLCALL mapped_close(SDL_RWops *context)
+{
+	if ( context ) {
+		if ( context->hidden.mem.base ) {
+			SDL_free(context->hidden.mem.base);
+		}
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+#endif /* HAVE_MMAP */
+
+
+/* Functions to read ahead from another data source.  The buffer is
+   described by hidden.mem like a memory source, with 'stop' marking the
+   end of the data read so far, so the endian readers can use the same
+   fast path for both.
+ */
+
+#define RW_BUFFERED_DEFAULT	4096
+
+typedef struct {
+	SDL_RWops rwops;
+	SDL_RWops *src;
+	int freesrc;
+	int blocksize;
+	Sint64 pos;	/* offset in 'src' corresponding to hidden.mem.stop */
+} SDL_BufferedRWops;
+
+/* Put the source where the reader is and drop the buffered data */
+static int buffered_sync(SDL_BufferedRWops *buffered)
+{
+	SDL_RWops *context = &buffered->rwops;
+	Sint64 here;
+
+	if ( context->hidden.mem.here != context->hidden.mem.stop ) {
+		here = buffered->pos-(context->hidden.mem.stop-context->hidden.mem.here);
+		if ( SDL_RWseek64(buffered->src, here, RW_SEEK_SET) < 0 ) {
+			return(-1);
+		}
+		buffered->pos = here;
+	}
+	context->hidden.mem.here = context->hidden.mem.base;
+	context->hidden.mem.stop = context->hidden.mem.base;
+	return(0);
+}
+
+static Sint64 buffered_seek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+	SDL_BufferedRWops *buffered = (SDL_BufferedRWops *)context;
+	Sint64 newpos;
+
+	switch (whence) {
+		case RW_SEEK_SET:
+			newpos = offset;
+			break;
+		case RW_SEEK_CUR:
+			newpos = buffered->pos-(context->hidden.mem.stop-
+				context->hidden.mem.here)+offset;
+			break;
+		case RW_SEEK_END:
+			context->hidden.mem.here = context->hidden.mem.stop;
+			newpos = SDL_RWseek64(buffered->src, offset, RW_SEEK_END);
+			if ( newpos >= 0 ) {
+				buffered->pos = newpos;
+				context->hidden.mem.here = context->hidden.mem.base;
+				context->hidden.mem.stop = context->hidden.mem.base;
+			}
+			return(newpos);
+		default:
+			SDL_SetError("Unknown value for 'whence'");
+			return(-1);
+	}
+
+	/* Seeks within the data we already have don't touch the source */
+	if ( (newpos <= buffered->pos) && (newpos >= buffered->pos-
+	      (context->hidden.mem.stop-context->hidden.mem.base)) ) {
+		context->hidden.mem.here = context->hidden.mem.stop-
+					(size_t)(buffered->pos-newpos);
+		return(newpos);
+	}
+
+	newpos = SDL_RWseek64(buffered->src, newpos, RW_SEEK_SET);
+	if ( newpos >= 0 ) {
+		buffered->pos = newpos;
+		context->hidden.mem.here = context->hidden.mem.base;
+		context->hidden.mem.stop = context->hidden.mem.base;
+	}
+	return(newpos);
+}
+static int SDLCALL buffered_seek(SDL_RWops *context, int offset, int whence)
+{
+	Sint64 pos;
+
+	pos = buffered_seek64(context, offset, whence);
+	if ( pos > 0x7FFFFFFF ) {
+		SDL_SetError("File offset too large, use SDL_RWseek64()");
+		return(-1);
+	}
+	return((int)pos);
+}
+static int SDLCALL buffered_read(SDL_RWops *context, void *ptr, int size, int maxnum)
+{
+	SDL_BufferedRWops *buffered = (SDL_BufferedRWops *)context;
+	Uint8 *dst = (Uint8 *)ptr;
+	size_t total_bytes;
+	size_t left, avail;
+	int amount;
+
+	total_bytes = (maxnum * size);
+	if ( (maxnum <= 0) || (size <= 0) || ((total_bytes / maxnum) != (size_t) size) ) {
+		return 0;
+	}
+
+	left = total_bytes;
+	while ( left > 0 ) {
+		avail = (context->hidden.mem.stop - context->hidden.mem.here);
+		if ( avail > 0 ) {
+			if ( avail > left ) {
+				avail = left;
+			}
+			SDL_memcpy(dst, context->hidden.mem.here, avail);
+			context->hidden.mem.here += avail;
+			dst += avail;
+			left -= avail;
+			continue;
+		}
+
+		/* Big reads go straight to the destination */
+		if ( left >= (size_t)buffered->blocksize ) {
+			amount = SDL_RWread(buffered->src, dst, 1, (int)left);
+			if ( amount <= 0 ) {
+				break;
+			}
+			buffered->pos += amount;
+			context->hidden.mem.here = context->hidden.mem.base;
+			context->hidden.mem.stop = context->hidden.mem.base;
+			dst += amount;
+			left -= amount;
+			continue;
+		}
+
+		amount = SDL_RWread(buffered->src, context->hidden.mem.base,
+					1, buffered->blocksize);
+		if ( amount <= 0 ) {
+			break;
+		}
+		buffered->pos += amount;
+		context->hidden.mem.here = context->hidden.mem.base;
+		context->hidden.mem.stop = context->hidden.mem.base+amount;
+	}
+	return ((total_bytes - left) / size);
+}
+static int SDLCALL buffered_write(SDL_RWops *context, const void *ptr, int size, int num)
+{
+	SDL_BufferedRWops *buffered = (SDL_BufferedRWops *)context;
+	int written;
+
+	if ( buffered_sync(buffered) < 0 ) {
+		return(-1);
+	}
+	written = SDL_RWwrite(buffered->src, ptr, size, num);
+	if ( written > 0 ) {
+		buffered->pos += (Sint64)written * size;
+
+		/* stdio needs a seek between writing and reading again */
+		SDL_RWseek64(buffered->src, buffered->pos, RW_SEEK_SET);
+	}
+	return(written);
+}
+static int SDLCALL buffered_close(SDL_RWops *context)
+{
+	SDL_BufferedRWops *buffered = (SDL_BufferedRWops *)context;
+
+	if ( context ) {
+		if ( buffered->freesrc ) {
+			SDL_RWclose(buffered->src);
+		} else {
+			/* Leave the source where our reader stopped */
+			buffered_sync(buffered);
+		}
+		SDL_free(context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -504,6 +780,7 @@ SDL_RWops *SDL_RWFromFile(const char *file, const char *mode)
 	rwops->read  = win32_file_read;
 	rwops->write = win32_file_write;
 	rwops->close = win32_file_close;
+	rwops->type = SDL_RWOPS_WINFILE;
 
 #elif HAVE_STDIO_H
 
@@ -548,6 +825,7 @@ SDL_RWops *SDL_RWFromFP(FILE *fp, int autoclose)
 		rwops->close = stdio_close;
 		rwops->hidden.stdio.fp = fp;
 		rwops->hidden.stdio.autoclose = autoclose;
+		rwops->type = SDL_RWOPS_STDFILE;
 	}
 	return(rwops);
 }
@@ -566,6 +844,7 @@ SDL_RWops *SDL_RWFromMem(void *mem, int size)
 		rwops->hidden.mem.base = (Uint8 *)mem;
 		rwops->hidden.mem.here = rwops->hidden.mem.base;
 		rwops->hidden.mem.stop = rwops->hidden.mem.base+size;
+		rwops->type = SDL_RWOPS_MEMORY;
 	}
 	return(rwops);
 }
@@ -583,10 +862,204 @@ SDL_RWops *SDL_RWFromConstMem(const void *mem, int size)
 		rwops->hidden.mem.base = (Uint8 *)mem;
 		rwops->hidden.mem.here = rwops->hidden.mem.base;
 		rwops->hidden.mem.stop = rwops->hidden.mem.base+size;
+		rwops->type = SDL_RWOPS_MEMORY_RO;
+	}
+	return(rwops);
+}
+
+SDL_RWops *SDL_RWFromBufferedRW(SDL_RWops *src, int blocksize, int freesrc)
+{
+	SDL_BufferedRWops *buffered;
+	SDL_RWops *rwops;
+
+	if ( src == NULL ) {
+		SDL_SetError("SDL_RWFromBufferedRW(): No source specified");
+		return NULL;
+	}
+	if ( blocksize <= 0 ) {
+		blocksize = RW_BUFFERED_DEFAULT;
+	}
+
+	buffered = (SDL_BufferedRWops *)SDL_malloc(sizeof(*buffered));
+	if ( buffered == NULL ) {
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	rwops = &buffered->rwops;
+	rwops->hidden.mem.base = (Uint8 *)SDL_malloc(blocksize);
+	if ( rwops->hidden.mem.base == NULL ) {
+		SDL_free(buffered);
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	rwops->seek = buffered_seek;
+	rwops->read = buffered_read;
+	rwops->write = buffered_write;
+	rwops->close = buffered_close;
+	rwops->hidden.mem.here = rwops->hidden.mem.base;
+	rwops->hidden.mem.stop = rwops->hidden.mem.base;
+	rwops->type = SDL_RWOPS_BUFFERED;
+	buffered->src = src;
+	buffered->freesrc = freesrc;
+	buffered->blocksize = blocksize;
+
+	/* Streams that can't tell their offset are read from where they are */
+	buffered->pos = SDL_RWtell64(src);
+	if ( buffered->pos < 0 ) {
+		buffered->pos = 0;
+	}
+	return(rwops);
+}
+
+SDL_RWops *SDL_RWFromMappedFile(const char *file)
+{
+	SDL_RWops *rwops;
+	Uint8 *base = NULL;
+	size_t size = 0;
+
+	if ( !file || !*file ) {
+		SDL_SetError("SDL_RWFromMappedFile(): No file specified");
+		return NULL;
+	}
+
+#ifdef HAVE_MMAP
+	{
+		struct stat st;
+		int fd;
+
+		fd = open(file, O_RDONLY);
+		if ( fd < 0 ) {
+			SDL_SetError("Couldn't open %s", file);
+			return NULL;
+		}
+		if ( (fstat(fd, &st) < 0) || (st.st_size < 0) ||
+		     ((Uint64)st.st_size > (size_t)-1) ) {
+			close(fd);
+			SDL_SetError("Couldn't get size of %s", file);
+			return NULL;
+		}
+		size = (size_t)st.st_size;
+		if ( size > 0 ) {
+			/* A private writable mapping lets callers scribble on
+			   data they borrowed without touching the file */
+			base = (Uint8 *)mmap(NULL, size, PROT_READ|PROT_WRITE,
+			                     MAP_PRIVATE, fd, 0);
+			if ( base == (Uint8 *)MAP_FAILED ) {
+				close(fd);
+				SDL_SetError("Couldn't map %s", file);
+				return NULL;
+			}
+		}
+		close(fd);
+	}
+#else
+	{
+		SDL_RWops *src;
+		int amount;
+		int filesize;
+
+		src = SDL_RWFromFile(file, "rb");
+		if ( src == NULL ) {
+			return NULL;
+		}
+		filesize = SDL_RWseek(src, 0, RW_SEEK_END);
+		if ( (filesize < 0) || (SDL_RWseek(src, 0, RW_SEEK_SET) < 0) ) {
+			SDL_RWclose(src);
+			SDL_Error(SDL_EFSEEK);
+			return NULL;
+		}
+		size = filesize;
+		if ( size > 0 ) {
+			base = (Uint8 *)SDL_malloc(size);
+			if ( base == NULL ) {
+				SDL_RWclose(src);
+				SDL_OutOfMemory();
+				return NULL;
+			}
+			amount = SDL_RWread(src, base, 1, filesize);
+			if ( amount != filesize ) {
+				SDL_free(base);
+				SDL_RWclose(src);
+				SDL_Error(SDL_EFREAD);
+				return NULL;
+			}
+		}
+		SDL_RWclose(src);
 	}
+#endif /* HAVE_MMAP */
+
+	rwops = SDL_AllocRW();
+	if ( rwops == NULL ) {
+#ifdef HAVE_MMAP
+		if ( base ) {
+			munmap(base, size);
+		}
+#else
+		SDL_free(base);
+#endif
+		return NULL;
+	}
+	rwops->seek = mem_seek;
+	rwops->read = mem_read;
+	rwops->write = mem_writeconst;
+	rwops->close = mapped_close;
+	rwops->hidden.mem.base = base;
+	rwops->hidden.mem.here = base;
+	rwops->hidden.mem.stop = base+size;
+	rwops->type = SDL_RWOPS_MAPPED;
 	return(rwops);
 }
 
+Sint64 SDL_RWseek64(SDL_RWops *context, Sint64 offset, int whence)
+{
+	int pos;
+
+	if ( context->seek == mem_seek ) {
+		return mem_seek64(context, offset, whence);
+	}
+	if ( context->seek == buffered_seek ) {
+		return buffered_seek64(context, offset, whence);
+	}
+#if defined(__WIN32__) && !defined(__SYMBIAN32__)
+	if ( context->seek == win32_file_seek ) {
+		return win32_file_seek64(context, offset, whence);
+	}
+#endif
+#ifdef HAVE_STDIO_H
+	if ( context->seek == stdio_seek ) {
+		return stdio_seek64(context, offset, whence);
+	}
+#endif
+
+	/* Other data sources only know about 32-bit offsets */
+	if ( (offset < -0x7FFFFFFF-1) || (offset > 0x7FFFFFFF) ) {
+		SDL_SetError("Seek offset out of range for this data source");
+		return -1;
+	}
+	pos = context->seek(context, (int)offset, whence);
+	return pos;
+}
+
+void *SDL_RWborrow(SDL_RWops *context, size_t *length, int writable)
+{
+	/* The type field is public, so go by the functions behind it */
+	if ( context->read != mem_read ) {
+		SDL_SetError("Data source isn't held in memory");
+	} else if ( writable && (context->write != mem_write) &&
+	            (context->close != mapped_close) ) {
+		SDL_SetError("Can't borrow read-only memory for writing");
+	} else {
+		if ( length ) {
+			*length = context->hidden.mem.stop-context->hidden.mem.here;
+		}
+		return context->hidden.mem.here;
+	}
+	if ( length ) {
+		*length = 0;
+	}
+	return NULL;
+}
+
 SDL_RWops *SDL_AllocRW(void)
 {
 	SDL_RWops *area;
@@ -594,6 +1067,8 @@ SDL_RWops *SDL_AllocRW(void)
 	area = (SDL_RWops *)SDL_malloc(sizeof *area);
 	if ( area == NULL ) {
 		SDL_OutOfMemory();
+	} else {
+		area->type = SDL_RWOPS_UNKNOWN;
 	}
 	return(area);
 }
@@ -605,46 +1080,60 @@ void SDL_FreeRW(SDL_RWops *area)
 
 /* Functions for dynamically reading and writing endian-specific values */
 
+/* Small reads from memory or a read-ahead buffer skip the function call */
+static __inline__ void SDL_RWreadValue(SDL_RWops *src, void *value, int size)
+{
+	/* Both keep the data ahead of the read position in hidden.mem */
+	if ( (src->read == mem_read) || (src->read == buffered_read) ) {
+		if ( (src->hidden.mem.stop-src->hidden.mem.here) >= size ) {
+			SDL_memcpy(value, src->hidden.mem.here, size);
+			src->hidden.mem.here += size;
+			return;
+		}
+	}
+	SDL_RWread(src, value, size, 1);
+}
+
 Uint16 SDL_ReadLE16 (SDL_RWops *src)
 {
 	Uint16 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapLE16(value));
 }
 Uint16 SDL_ReadBE16 (SDL_RWops *src)
 {
 	Uint16 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapBE16(value));
 }
 Uint32 SDL_ReadLE32 (SDL_RWops *src)
 {
 	Uint32 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapLE32(value));
 }
 Uint32 SDL_ReadBE32 (SDL_RWops *src)
 {
 	Uint32 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapBE32(value));
 }
 Uint64 SDL_ReadLE64 (SDL_RWops *src)
 {
 	Uint64 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapLE64(value));
 }
 Uint64 SDL_ReadBE64 (SDL_RWops *src)
 {
 	Uint64 value;
 
-	SDL_RWread(src, &value, (sizeof value), 1);
+	SDL_RWreadValue(src, &value, (sizeof value));
 	return(SDL_SwapBE64(value));
 }
 
@@ -0,0 +1,596 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/*
+   Code to read and write SDL pack files.
+
+   A pack holds many small data files in one file, so they can be opened
+   without touching the file system each time.  The pack is read from
+   memory or a mapped file, and its entries are handed out as memory
+   data sources pointing into it; compressed entries are unpacked into
+   their own buffer when opened.
+
+   The layout, all values little-endian:
+	 0  magic "SPAK"
+	 4  Uint16 version, Uint16 reserved
+	 8  Uint32 number of entries, Uint32 index size
+	16  Uint64 index offset
+   Entry data starts on a 16 byte boundary.  The index is a list of:
+	 0  Uint64 data offset
+	 8  Uint32 stored size, Uint32 size
+	16  Uint8 encoding, Uint8 reserved, Uint16 name length
+	20  the name, not terminated
+*/
+
+#include "SDL_rwops.h"
+#include "SDL_lz4_c.h"
+
+#define PAK_MAGIC		"SPAK"
+#define PAK_VERSION		1
+#define PAK_HEADER_SIZE		24
+#define PAK_ENTRY_SIZE		20
+#define PAK_DATA_ALIGN		16
+
+/* Entry data encodings */
+#define PAK_ENCODING_STORED	0
+#define PAK_ENCODING_LZ4	1
+
+typedef struct {
+	const char *name;
+	Uint64 offset;
+	Uint32 stored;
+	Uint32 size;
+	Uint8 encoding;
+} SDL_PackEntry;
+
+struct SDL_RWpack {
+	SDL_RWops *rw;		/* The source being read or written */
+	int freerw;
+	SDL_bool writing;
+
+	/* The pack contents, when reading */
+	const Uint8 *base;
+	size_t size;
+	Uint8 *buffer;		/* If the source wasn't in memory */
+	char *names;
+
+	/* Where the pack starts, and where the next entry goes when writing */
+	Sint64 start;
+	Sint64 pos;
+
+	int numentries;
+	int maxentries;
+	SDL_PackEntry *entries;
+
+	/* Open addressed hash of entry names, holding entry index + 1 */
+	int *hash;
+	Uint32 hashmask;
+};
+
+static Uint16 PAK_Get16(const Uint8 *p)
+{
+	return (Uint16)(p[0] | (p[1] << 8));
+}
+static Uint32 PAK_Get32(const Uint8 *p)
+{
+	return (Uint32)p[0] | ((Uint32)p[1] << 8) |
+	       ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+static Uint64 PAK_Get64(const Uint8 *p)
+{
+	return (Uint64)PAK_Get32(p) | ((Uint64)PAK_Get32(p+4) << 32);
+}
+static void PAK_Put16(Uint8 *p, Uint16 value)
+{
+	p[0] = (Uint8)value;
+	p[1] = (Uint8)(value >> 8);
+}
+static void PAK_Put32(Uint8 *p, Uint32 value)
+{
+	p[0] = (Uint8)value;
+	p[1] = (Uint8)(value >> 8);
+	p[2] = (Uint8)(value >> 16);
+	p[3] = (Uint8)(value >> 24);
+}
+static void PAK_Put64(Uint8 *p, Uint64 value)
+{
+	PAK_Put32(p, (Uint32)value);
+	PAK_Put32(p+4, (Uint32)(value >> 32));
+}
+
+/* FNV-1a, over a name of 'len' bytes */
+static Uint32 PAK_Hash(const char *name, size_t len)
+{
+	Uint32 hash = 2166136261u;
+
+	while ( len-- ) {
+		hash ^= (Uint8)*name++;
+		hash *= 16777619u;
+	}
+	return(hash);
+}
+
+/* Find the index of an entry, or -1 */
+static int PAK_Find(SDL_RWpack *pack, const char *name)
+{
+	Uint32 i;
+	int entry;
+
+	if ( pack->hash == NULL ) {
+		return(-1);
+	}
+	i = PAK_Hash(name, SDL_strlen(name)) & pack->hashmask;
+	while ( (entry = pack->hash[i]) != 0 ) {
+		if ( SDL_strcmp(pack->entries[entry-1].name, name) == 0 ) {
+			return(entry-1);
+		}
+		i = (i + 1) & pack->hashmask;
+	}
+	return(-1);
+}
+
+static void PAK_HashInsert(SDL_RWpack *pack, int entry)
+{
+	const char *name = pack->entries[entry].name;
+	Uint32 i;
+
+	i = PAK_Hash(name, SDL_strlen(name)) & pack->hashmask;
+	while ( pack->hash[i] != 0 ) {
+		i = (i + 1) & pack->hashmask;
+	}
+	pack->hash[i] = entry+1;
+}
+
+/* Make sure the hash can hold 'count' entries while at most half full */
+static int PAK_Rehash(SDL_RWpack *pack, int count)
+{
+	Uint32 size;
+	int entry;
+
+	size = 16;
+	while ( size < (Uint32)count*2 ) {
+		size *= 2;
+	}
+	if ( pack->hash && (size <= pack->hashmask+1) ) {
+		return(0);
+	}
+	SDL_free(pack->hash);
+	pack->hash = (int *)SDL_calloc(size, sizeof(*pack->hash));
+	if ( pack->hash == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	pack->hashmask = size-1;
+	for ( entry = 0; entry < pack->numentries; ++entry ) {
+		PAK_HashInsert(pack, entry);
+	}
+	return(0);
+}
+
+static int SDLCALL PAK_CloseUnpacked(SDL_RWops *context)
+{
+	if ( context ) {
+		SDL_free(context->hidden.mem.base);
+		SDL_FreeRW(context);
+	}
+	return(0);
+}
+
+static void PAK_Free(SDL_RWpack *pack)
+{
+	int i;
+
+	if ( pack->writing ) {
+		for ( i = 0; i < pack->numentries; ++i ) {
+			SDL_free((char *)pack->entries[i].name);
+		}
+	}
+	if ( pack->freerw && pack->rw ) {
+		SDL_RWclose(pack->rw);
+	}
+	SDL_free(pack->entries);
+	SDL_free(pack->names);
+	SDL_free(pack->hash);
+	SDL_free(pack->buffer);
+	SDL_free(pack);
+}
+
+SDL_RWpack *SDL_OpenPackRW(SDL_RWops *src, int freesrc)
+{
+	SDL_RWpack *pack;
+	const Uint8 *header, *index, *p;
+	Uint32 indexsize;
+	Uint64 indexoffset;
+	char *name;
+	int i;
+
+	/* Whatever made the source has already said why there isn't one */
+	if ( src == NULL ) {
+		return(NULL);
+	}
+	pack = (SDL_RWpack *)SDL_calloc(1, sizeof(*pack));
+	if ( pack == NULL ) {
+		if ( freesrc ) {
+			SDL_RWclose(src);
+		}
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	pack->rw = src;
+	pack->freerw = freesrc;
+
+	/* The entries are handed out as pointers into the pack */
+	pack->base = (const Uint8 *)SDL_RWborrow(src, &pack->size, 0);
+	if ( pack->base == NULL ) {
+		Sint64 start, end;
+
+		start = SDL_RWtell64(src);
+		end = SDL_RWseek64(src, 0, RW_SEEK_END);
+		if ( (start < 0) || (end < start) ||
+		     (SDL_RWseek64(src, start, RW_SEEK_SET) != start) ) {
+			SDL_Error(SDL_EFSEEK);
+			PAK_Free(pack);
+			return(NULL);
+		}
+		if ( (Uint64)(end-start) > 0x7FFFFFFF ) {
+			SDL_SetError("Pack file too large to read into memory");
+			PAK_Free(pack);
+			return(NULL);
+		}
+		pack->size = (size_t)(end-start);
+		pack->buffer = (Uint8 *)SDL_malloc(pack->size ? pack->size : 1);
+		if ( pack->buffer == NULL ) {
+			SDL_OutOfMemory();
+			PAK_Free(pack);
+			return(NULL);
+		}
+		if ( SDL_RWread(src, pack->buffer, 1, (int)pack->size) != (int)pack->size ) {
+			SDL_Error(SDL_EFREAD);
+			PAK_Free(pack);
+			return(NULL);
+		}
+		pack->base = pack->buffer;
+	}
+
+	/* Read the header */
+	header = pack->base;
+	if ( (pack->size < PAK_HEADER_SIZE) ||
+	     (SDL_memcmp(header, PAK_MAGIC, 4) != 0) ) {
+		SDL_SetError("File is not an SDL pack file");
+		PAK_Free(pack);
+		return(NULL);
+	}
+	if ( PAK_Get16(&header[4]) != PAK_VERSION ) {
+		SDL_SetError("Unsupported pack file version %d", PAK_Get16(&header[4]));
+		PAK_Free(pack);
+		return(NULL);
+	}
+	pack->numentries = (int)PAK_Get32(&header[8]);
+	indexsize = PAK_Get32(&header[12]);
+	indexoffset = PAK_Get64(&header[16]);
+	if ( (pack->numentries < 0) ||
+	     ((Uint32)pack->numentries > indexsize/PAK_ENTRY_SIZE) ||
+	     (indexoffset > pack->size) || (indexsize > pack->size-indexoffset) ) {
+		SDL_SetError("Corrupt pack file");
+		PAK_Free(pack);
+		return(NULL);
+	}
+
+	/* Read the index, the names all go in one block */
+	index = pack->base+(size_t)indexoffset;
+	pack->entries = (SDL_PackEntry *)SDL_malloc(
+			(pack->numentries ? pack->numentries : 1)*sizeof(*pack->entries));
+	pack->names = (char *)SDL_malloc(indexsize+1);
+	if ( !pack->entries || !pack->names ) {
+		SDL_OutOfMemory();
+		PAK_Free(pack);
+		return(NULL);
+	}
+	pack->maxentries = pack->numentries;
+	p = index;
+	name = pack->names;
+	for ( i = 0; i < pack->numentries; ++i ) {
+		SDL_PackEntry *entry = &pack->entries[i];
+		Uint16 namelen;
+
+		if ( (size_t)(index+indexsize-p) < PAK_ENTRY_SIZE ) {
+			break;
+		}
+		entry->offset = PAK_Get64(&p[0]);
+		entry->stored = PAK_Get32(&p[8]);
+		entry->size = PAK_Get32(&p[12]);
+		entry->encoding = p[16];
+		namelen = PAK_Get16(&p[18]);
+		p += PAK_ENTRY_SIZE;
+		if ( ((size_t)(index+indexsize-p) < namelen) ||
+		     (entry->offset > pack->size) ||
+		     (entry->stored > pack->size-entry->offset) ||
+		     (entry->size > 0x7FFFFFFF) ||
+		     (entry->encoding > PAK_ENCODING_LZ4) ||
+		     ((entry->encoding == PAK_ENCODING_STORED) &&
+		      (entry->stored != entry->size)) ) {
+			break;
+		}
+		SDL_memcpy(name, p, namelen);
+		name[namelen] = '\0';
+		entry->name = name;
+		name += namelen+1;
+		p += namelen;
+	}
+	if ( i < pack->numentries ) {
+		SDL_SetError("Corrupt pack file");
+		PAK_Free(pack);
+		return(NULL);
+	}
+	if ( PAK_Rehash(pack, pack->numentries) < 0 ) {
+		PAK_Free(pack);
+		return(NULL);
+	}
+	return(pack);
+}
+
+SDL_RWpack *SDL_CreatePackRW(SDL_RWops *dst, int freedst)
+{
+	SDL_RWpack *pack;
+	Uint8 header[PAK_HEADER_SIZE];
+
+	/* Whatever made the destination has already said why there isn't one */
+	if ( dst == NULL ) {
+		return(NULL);
+	}
+	pack = (SDL_RWpack *)SDL_calloc(1, sizeof(*pack));
+	if ( pack == NULL ) {
+		if ( freedst ) {
+			SDL_RWclose(dst);
+		}
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	pack->rw = dst;
+	pack->freerw = freedst;
+	pack->writing = SDL_TRUE;
+
+	/* The header is filled in when the pack is closed */
+	pack->start = SDL_RWtell64(dst);
+	SDL_memset(header, 0, sizeof(header));
+	if ( (pack->start < 0) ||
+	     (SDL_RWwrite(dst, header, sizeof(header), 1) != 1) ) {
+		SDL_Error(SDL_EFWRITE);
+		PAK_Free(pack);
+		return(NULL);
+	}
+	pack->pos = PAK_HEADER_SIZE;
+	return(pack);
+}
+
+int SDL_AddPackEntry(SDL_RWpack *pack, const char *name, const void *data, int size, int compress)
+{
+	static const Uint8 padding[PAK_DATA_ALIGN];
+	SDL_PackEntry *entry;
+	Uint8 *compressed = NULL;
+	const void *stored;
+	int storedsize;
+	int pad;
+
+	if ( !pack || !pack->writing || !name || !*name || (size < 0) ||
+	     (!data && size) ) {
+		SDL_SetError("SDL_AddPackEntry(): Invalid parameter");
+		return(-1);
+	}
+	if ( SDL_strlen(name) > 0xFFFF ) {
+		SDL_SetError("Pack entry name too long");
+		return(-1);
+	}
+	if ( PAK_Find(pack, name) >= 0 ) {
+		SDL_SetError("Pack already has an entry named %s", name);
+		return(-1);
+	}
+	if ( pack->numentries == pack->maxentries ) {
+		int maxentries = pack->maxentries ? pack->maxentries*2 : 64;
+		SDL_PackEntry *entries;
+
+		entries = (SDL_PackEntry *)SDL_realloc(pack->entries,
+					maxentries*sizeof(*entries));
+		if ( entries == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		pack->entries = entries;
+		pack->maxentries = maxentries;
+	}
+	if ( PAK_Rehash(pack, pack->numentries+1) < 0 ) {
+		return(-1);
+	}
+
+	/* Keep the compressed data only if it is smaller */
+	stored = data;
+	storedsize = size;
+	if ( compress && (size > 0) ) {
+		int bound = SDL_LZ4_COMPRESSBOUND(size);
+
+		compressed = (Uint8 *)SDL_malloc(bound);
+		if ( compressed == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		storedsize = SDL_LZ4_Compress(data, size, compressed, bound);
+		if ( (storedsize > 0) && (storedsize < size) ) {
+			stored = compressed;
+		} else {
+			storedsize = size;
+		}
+	}
+
+	/* Nothing can fail once the data is written, or the offsets of the
+	   entries after this one would be wrong */
+	entry = &pack->entries[pack->numentries];
+	entry->name = SDL_strdup(name);
+	if ( entry->name == NULL ) {
+		SDL_free(compressed);
+		SDL_OutOfMemory();
+		return(-1);
+	}
+
+	pad = (int)(-pack->pos & (PAK_DATA_ALIGN-1));
+	if ( (pad && (SDL_RWwrite(pack->rw, padding, pad, 1) != 1)) ||
+	     (storedsize && (SDL_RWwrite(pack->rw, stored, storedsize, 1) != 1)) ) {
+		SDL_free((char *)entry->name);
+		SDL_free(compressed);
+		SDL_Error(SDL_EFWRITE);
+		return(-1);
+	}
+	SDL_free(compressed);
+
+	entry->offset = pack->pos+pad;
+	entry->stored = storedsize;
+	entry->size = size;
+	entry->encoding = (stored == data) ? PAK_ENCODING_STORED : PAK_ENCODING_LZ4;
+	pack->pos += pad+storedsize;
+	PAK_HashInsert(pack, pack->numentries);
+	++pack->numentries;
+	return(0);
+}
+
+SDL_RWops *SDL_RWFromPack(SDL_RWpack *pack, const char *name)
+{
+	SDL_PackEntry *entry;
+	SDL_RWops *rwops;
+	Uint8 *data;
+	int i;
+
+	if ( !pack || pack->writing || !name ) {
+		SDL_SetError("SDL_RWFromPack(): Invalid parameter");
+		return(NULL);
+	}
+	i = PAK_Find(pack, name);
+	if ( i < 0 ) {
+		SDL_SetError("Pack has no entry named %s", name);
+		return(NULL);
+	}
+	entry = &pack->entries[i];
+
+	if ( entry->encoding == PAK_ENCODING_STORED ) {
+		return(SDL_RWFromConstMem(pack->base+(size_t)entry->offset,
+					(int)entry->size));
+	}
+
+	/* Compressed entries get their own copy, freed when closed */
+	data = (Uint8 *)SDL_malloc(entry->size ? entry->size : 1);
+	if ( data == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	if ( SDL_LZ4_Decompress(pack->base+(size_t)entry->offset, entry->stored,
+				data, entry->size) != (int)entry->size ) {
+		SDL_free(data);
+		SDL_SetError("Corrupt pack entry %s", name);
+		return(NULL);
+	}
+	rwops = SDL_RWFromMem(data, (int)entry->size);
+	if ( rwops == NULL ) {
+		SDL_free(data);
+		return(NULL);
+	}
+	rwops->close = PAK_CloseUnpacked;
+	return(rwops);
+}
+
+int SDL_PackNumEntries(SDL_RWpack *pack)
+{
+	if ( pack == NULL ) {
+		SDL_SetError("SDL_PackNumEntries(): Invalid parameter");
+		return(-1);
+	}
+	return(pack->numentries);
+}
+
+const char *SDL_PackEntryName(SDL_RWpack *pack, int index)
+{
+	if ( !pack || (index < 0) || (index >= pack->numentries) ) {
+		SDL_SetError("SDL_PackEntryName(): Invalid parameter");
+		return(NULL);
+	}
+	return(pack->entries[index].name);
+}
+
+int SDL_ClosePack(SDL_RWpack *pack)
+{
+	Uint8 header[PAK_HEADER_SIZE];
+	Uint8 *index, *p;
+	Uint32 indexsize;
+	int i, retval;
+
+	if ( pack == NULL ) {
+		SDL_SetError("SDL_ClosePack(): Invalid parameter");
+		return(-1);
+	}
+	if ( ! pack->writing ) {
+		PAK_Free(pack);
+		return(0);
+	}
+
+	/* Write the index after the data, then the header */
+	indexsize = 0;
+	for ( i = 0; i < pack->numentries; ++i ) {
+		indexsize += PAK_ENTRY_SIZE+SDL_strlen(pack->entries[i].name);
+	}
+	index = (Uint8 *)SDL_malloc(indexsize ? indexsize : 1);
+	if ( index == NULL ) {
+		SDL_OutOfMemory();
+		PAK_Free(pack);
+		return(-1);
+	}
+	p = index;
+	for ( i = 0; i < pack->numentries; ++i ) {
+		SDL_PackEntry *entry = &pack->entries[i];
+		size_t namelen = SDL_strlen(entry->name);
+
+		PAK_Put64(&p[0], entry->offset);
+		PAK_Put32(&p[8], entry->stored);
+		PAK_Put32(&p[12], entry->size);
+		p[16] = entry->encoding;
+		p[17] = 0;
+		PAK_Put16(&p[18], (Uint16)namelen);
+		SDL_memcpy(&p[PAK_ENTRY_SIZE], entry->name, namelen);
+		p += PAK_ENTRY_SIZE+namelen;
+	}
+
+	SDL_memcpy(&header[0], PAK_MAGIC, 4);
+	PAK_Put16(&header[4], PAK_VERSION);
+	PAK_Put16(&header[6], 0);
+	PAK_Put32(&header[8], pack->numentries);
+	PAK_Put32(&header[12], indexsize);
+	PAK_Put64(&header[16], pack->pos);
+
+	retval = 0;
+	if ( (indexsize && (SDL_RWwrite(pack->rw, index, indexsize, 1) != 1)) ||
+	     (SDL_RWseek64(pack->rw, pack->start, RW_SEEK_SET) != pack->start) ||
+	     (SDL_RWwrite(pack->rw, header, sizeof(header), 1) != 1) ||
+	     (SDL_RWseek64(pack->rw, pack->start+pack->pos+indexsize, RW_SEEK_SET) < 0) ) {
+		SDL_Error(SDL_EFWRITE);
+		retval = -1;
+	}
+	SDL_free(index);
+	PAK_Free(pack);
+	return(retval);
+}
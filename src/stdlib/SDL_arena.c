@@ -0,0 +1,146 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* This file contains a linear allocator for short-lived memory */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#define ARENA_ALIGN		16
+#define ARENA_ROUND(x)		(((x) + (ARENA_ALIGN-1)) & ~(size_t)(ARENA_ALIGN-1))
+#define ARENA_DEFAULT_BLOCK	(64*1024)
+
+typedef struct SDL_ArenaBlock {
+	struct SDL_ArenaBlock *next;
+	size_t size;
+} SDL_ArenaBlock;
+
+/* Block data starts here, past the header */
+#define ARENA_DATA(block)	((Uint8 *)(block) + ARENA_ROUND(sizeof(SDL_ArenaBlock)))
+
+struct SDL_Arena {
+	SDL_ArenaBlock *blocks;	/* The block being filled, then older ones */
+	size_t used;		/* Bytes used in the first block */
+	size_t total;		/* Bytes allocated since the last reset */
+	size_t blocksize;
+};
+
+static SDL_ArenaBlock *SDL_AllocArenaBlock(size_t size)
+{
+	SDL_ArenaBlock *block;
+
+	/* SDL_malloc() only guarantees 8 byte alignment, so pad for 16 */
+	block = (SDL_ArenaBlock *)SDL_malloc(ARENA_ROUND(sizeof(*block)) +
+					size + ARENA_ALIGN);
+	if ( block ) {
+		block->next = NULL;
+		block->size = size;
+	}
+	return(block);
+}
+
+static void SDL_FreeArenaBlocks(SDL_Arena *arena)
+{
+	SDL_ArenaBlock *block;
+
+	while ( arena->blocks ) {
+		block = arena->blocks;
+		arena->blocks = block->next;
+		SDL_free(block);
+	}
+}
+
+SDL_Arena *SDL_CreateArena(size_t blocksize)
+{
+	SDL_Arena *arena;
+
+	arena = (SDL_Arena *)SDL_malloc(sizeof(*arena));
+	if ( arena == NULL ) {
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	arena->blocks = NULL;
+	arena->used = 0;
+	arena->total = 0;
+	arena->blocksize = blocksize ? ARENA_ROUND(blocksize) : ARENA_DEFAULT_BLOCK;
+	return(arena);
+}
+
+void *SDL_ArenaAlloc(SDL_Arena *arena, size_t size)
+{
+	SDL_ArenaBlock *block;
+	Uint8 *mem;
+
+	size = ARENA_ROUND(size ? size : 1);
+	block = arena->blocks;
+	if ( !block || (block->size - arena->used) < size ) {
+		block = SDL_AllocArenaBlock(size > arena->blocksize ?
+						size : arena->blocksize);
+		if ( block == NULL ) {
+			SDL_OutOfMemory();
+			return(NULL);
+		}
+		block->next = arena->blocks;
+		arena->blocks = block;
+		arena->used = 0;
+	}
+	mem = ARENA_DATA(block);
+	mem += (ARENA_ALIGN - ((size_t)mem & (ARENA_ALIGN-1))) & (ARENA_ALIGN-1);
+	mem += arena->used;
+	arena->used += size;
+	arena->total += size;
+	return(mem);
+}
+
+void SDL_ResetArena(SDL_Arena *arena)
+{
+	size_t size;
+
+	if ( arena->blocks && arena->blocks->next ) {
+		/* Replace the chain with one block that fits this cycle */
+		size = arena->total > arena->blocksize ?
+			arena->total : arena->blocksize;
+		SDL_FreeArenaBlocks(arena);
+		arena->blocks = SDL_AllocArenaBlock(size);
+	}
+	arena->used = 0;
+	arena->total = 0;
+}
+
+void SDL_TrimArena(SDL_Arena *arena)
+{
+	if ( arena->blocks &&
+	     (arena->blocks->next || (arena->blocks->size > arena->blocksize)) ) {
+		SDL_FreeArenaBlocks(arena);
+	}
+	arena->used = 0;
+	arena->total = 0;
+}
+
+void SDL_FreeArena(SDL_Arena *arena)
+{
+	if ( arena ) {
+		SDL_FreeArenaBlocks(arena);
+		SDL_free(arena);
+	}
+}
@@ -23,92 +23,316 @@
 
 #include "SDL_stdinc.h"
 
-#ifndef HAVE_GETENV
+/* Functions watching environment variables, see SDL_AddEnvCallback() */
+typedef struct SDL_EnvWatch {
+	char *name;
+	SDL_EnvCallback callback;
+	void *userdata;
+	struct SDL_EnvWatch *next;
+} SDL_EnvWatch;
+
+static SDL_EnvWatch *SDL_envwatch = NULL;
+static int SDL_envnotifying = 0;
+
+/* Call the functions watching the variable of the form "name=value".
+   Removed watches are only unlinked afterwards, so any of them may go.
+ */
+static void SDL_NotifyEnv(const char *variable)
+{
+	SDL_EnvWatch *watch, **prev;
+	const char *value = SDL_strchr(variable, '=');
+	size_t namelen = (value - variable);
+
+	if ( !SDL_envwatch ) {
+		return;
+	}
+	++value;
+	++SDL_envnotifying;
+	for ( watch = SDL_envwatch; watch; watch = watch->next ) {
+		if ( watch->callback &&
+		     (SDL_strncmp(watch->name, variable, namelen) == 0) &&
+		     (watch->name[namelen] == '\0') ) {
+			watch->callback(watch->userdata, watch->name, value);
+		}
+	}
+	if ( --SDL_envnotifying == 0 ) {
+		prev = &SDL_envwatch;
+		while ( (watch = *prev) != NULL ) {
+			if ( watch->callback ) {
+				prev = &watch->next;
+			} else {
+				*prev = watch->next;
+				SDL_free(watch->name);
+				SDL_free(watch);
+			}
+		}
+	}
+}
+
+int SDL_AddEnvCallback(const char *name, SDL_EnvCallback callback, void *userdata)
+{
+	SDL_EnvWatch *watch;
+
+	watch = (SDL_EnvWatch *)SDL_malloc(sizeof(*watch));
+	if ( watch ) {
+		watch->name = SDL_strdup(name);
+		if ( !watch->name ) {
+			SDL_free(watch);
+			watch = NULL;
+		}
+	}
+	if ( !watch ) {
+		return(-1);
+	}
+	watch->callback = callback;
+	watch->userdata = userdata;
+	watch->next = SDL_envwatch;
+	SDL_envwatch = watch;
+	return(0);
+}
+
+void SDL_DelEnvCallback(const char *name, SDL_EnvCallback callback, void *userdata)
+{
+	SDL_EnvWatch *watch, **prev;
+
+	for ( prev = &SDL_envwatch; (watch = *prev) != NULL; prev = &watch->next ) {
+		if ( (watch->callback == callback) &&
+		     (watch->userdata == userdata) &&
+		     (SDL_strcmp(watch->name, name) == 0) ) {
+			break;
+		}
+	}
+	if ( !watch ) {
+		return;
+	}
+	if ( SDL_envnotifying ) {
+		watch->callback = NULL;
+	} else {
+		*prev = watch->next;
+		SDL_free(watch->name);
+		SDL_free(watch);
+	}
+}
+
+#if defined(HAVE_GETENV) && defined(HAVE_PUTENV)
+
+int SDL_putenv(const char *variable)
+{
+	if ( putenv((char *)variable) != 0 ) {
+		return(-1);
+	}
+	if ( SDL_strchr(variable, '=') ) {
+		SDL_NotifyEnv(variable);
+	}
+	return(0);
+}
+
+#else
+
+/* Note this isn't thread-safe! */
+
+/* The variables are kept as "name=value" strings in a hash table on the
+   name, which doubles in size to keep the chains short.  With getenv()
+   but no putenv(), the table holds what SDL_putenv() sets, and anything
+   else comes from the C library.
+ */
+typedef struct SDL_EnvVar {
+	Uint32 hash;
+	size_t namelen;
+	char *variable;
+	struct SDL_EnvVar *next;
+} SDL_EnvVar;
+
+static SDL_EnvVar **SDL_env = NULL;
+static Uint32 SDL_envsize = 0;
+static Uint32 SDL_envcount = 0;
+
+/* FNV-1a hash of a name ending at '=' or the end of the string */
+static Uint32 SDL_HashEnv(const char *name, size_t *namelen)
+{
+	const char *p;
+	Uint32 hash = 2166136261u;
+
+	for ( p = name; *p && (*p != '='); ++p ) {
+		hash ^= (Uint8)*p;
+		hash *= 16777619;
+	}
+	*namelen = (p - name);
+	return(hash);
+}
+
+static SDL_EnvVar *SDL_FindEnv(const char *name, size_t namelen, Uint32 hash)
+{
+	SDL_EnvVar *var;
+
+	if ( !SDL_env ) {
+		return(NULL);
+	}
+	for ( var = SDL_env[hash & (SDL_envsize-1)]; var; var = var->next ) {
+		if ( (var->hash == hash) && (var->namelen == namelen) &&
+		     (SDL_strncmp(var->variable, name, namelen) == 0) ) {
+			return(var);
+		}
+	}
+	return(NULL);
+}
+
+/* Add or replace a variable, taking over the "name=value" string */
+static int SDL_StoreEnv(char *variable, size_t namelen, Uint32 hash)
+{
+	SDL_EnvVar *var, **env;
+	Uint32 i, size;
+
+	var = SDL_FindEnv(variable, namelen, hash);
+	if ( var ) {
+		SDL_free(var->variable);
+		var->variable = variable;
+		return(0);
+	}
+
+	if ( SDL_envcount >= SDL_envsize ) {
+		size = SDL_envsize ? (SDL_envsize * 2) : 32;
+		env = (SDL_EnvVar **)SDL_calloc(size, sizeof(*env));
+		if ( !env ) {
+			return(-1);
+		}
+		for ( i = 0; i < SDL_envsize; ++i ) {
+			while ( (var = SDL_env[i]) != NULL ) {
+				SDL_env[i] = var->next;
+				var->next = env[var->hash & (size-1)];
+				env[var->hash & (size-1)] = var;
+			}
+		}
+		SDL_free(SDL_env);
+		SDL_env = env;
+		SDL_envsize = size;
+	}
+
+	var = (SDL_EnvVar *)SDL_malloc(sizeof(*var));
+	if ( !var ) {
+		return(-1);
+	}
+	var->hash = hash;
+	var->namelen = namelen;
+	var->variable = variable;
+	var->next = SDL_env[hash & (SDL_envsize-1)];
+	SDL_env[hash & (SDL_envsize-1)] = var;
+	++SDL_envcount;
+	return(0);
+}
 
 #if defined(__WIN32__) && !defined(_WIN32_WCE) && !defined(__SYMBIAN32__)
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
-/* Note this isn't thread-safe! */
+/* The table caches the variables SDL has looked up or set, so a variable
+   changed with SetEnvironmentVariable() after SDL has seen it keeps the
+   value it had.  Missing variables aren't cached.
+ */
 
-static char *SDL_envmem = NULL;	/* Ugh, memory leak */
-static size_t SDL_envmemlen = 0;
+static void SDL_UncacheEnv(const char *name, size_t namelen, Uint32 hash)
+{
+	SDL_EnvVar *var, **prev;
+
+	if ( !SDL_env ) {
+		return;
+	}
+	prev = &SDL_env[hash & (SDL_envsize-1)];
+	while ( (var = *prev) != NULL ) {
+		if ( (var->hash == hash) && (var->namelen == namelen) &&
+		     (SDL_strncmp(var->variable, name, namelen) == 0) ) {
+			*prev = var->next;
+			SDL_free(var->variable);
+			SDL_free(var);
+			--SDL_envcount;
+			return;
+		}
+		prev = &var->next;
+	}
+}
 
 /* Put a variable of the form "name=value" into the environment */
 int SDL_putenv(const char *variable)
 {
-	size_t bufferlen;
+	char *new_variable;
 	char *value;
-	const char *sep;
+	size_t namelen;
+	Uint32 hash;
 
-	sep = SDL_strchr(variable, '=');
-	if ( sep == NULL ) {
+	if ( !variable || !SDL_strchr(variable, '=') ) {
 		return -1;
 	}
-	bufferlen = SDL_strlen(variable)+1;
-	if ( bufferlen > SDL_envmemlen ) {
-		char *newmem = (char *)SDL_realloc(SDL_envmem, bufferlen);
-		if ( newmem == NULL ) {
-			return -1;
-		}
-		SDL_envmem = newmem;
-		SDL_envmemlen = bufferlen;
+	new_variable = SDL_strdup(variable);
+	if ( new_variable == NULL ) {
+		return -1;
 	}
-	SDL_strlcpy(SDL_envmem, variable, bufferlen);
-	value = SDL_envmem + (sep - variable);
+	hash = SDL_HashEnv(new_variable, &namelen);
+	value = new_variable + namelen;
 	*value++ = '\0';
-	if ( !SetEnvironmentVariable(SDL_envmem, *value ? value : NULL) ) {
+	if ( !SetEnvironmentVariable(new_variable, *value ? value : NULL) ) {
+		SDL_free(new_variable);
 		return -1;
 	}
+	new_variable[namelen] = '=';
+
+	/* An empty value removes the variable, and one that can't be cached
+	   is looked up again next time.
+	 */
+	if ( !*value || SDL_StoreEnv(new_variable, namelen, hash) < 0 ) {
+		SDL_UncacheEnv(new_variable, namelen, hash);
+		SDL_NotifyEnv(new_variable);
+		SDL_free(new_variable);
+	} else {
+		SDL_NotifyEnv(new_variable);
+	}
 	return 0;
 }
 
 /* Retrieve a variable named "name" from the environment */
 char *SDL_getenv(const char *name)
 {
-	size_t bufferlen;
+	SDL_EnvVar *var;
+	char *variable;
+	size_t namelen;
+	DWORD bufferlen;
+	Uint32 hash;
+
+	hash = SDL_HashEnv(name, &namelen);
+	var = SDL_FindEnv(name, namelen, hash);
+	if ( var ) {
+		return var->variable + namelen + 1;
+	}
 
-	bufferlen = GetEnvironmentVariable(name, SDL_envmem, (DWORD)SDL_envmemlen);
+	bufferlen = GetEnvironmentVariable(name, NULL, 0);
 	if ( bufferlen == 0 ) {
 		return NULL;
 	}
-	if ( bufferlen > SDL_envmemlen ) {
-		char *newmem = (char *)SDL_realloc(SDL_envmem, bufferlen);
-		if ( newmem == NULL ) {
-			return NULL;
-		}
-		SDL_envmem = newmem;
-		SDL_envmemlen = bufferlen;
-		GetEnvironmentVariable(name, SDL_envmem, (DWORD)SDL_envmemlen);
+	variable = (char *)SDL_malloc(namelen + 1 + bufferlen);
+	if ( variable == NULL ) {
+		return NULL;
+	}
+	SDL_memcpy(variable, name, namelen);
+	variable[namelen] = '=';
+	if ( GetEnvironmentVariable(name, variable + namelen + 1, bufferlen) == 0 ||
+	     SDL_StoreEnv(variable, namelen, hash) < 0 ) {
+		SDL_free(variable);
+		return NULL;
 	}
-	return SDL_envmem;
+	return variable + namelen + 1;
 }
 
 #else /* roll our own */
 
-static char **SDL_env = (char **)0;
-
 /* Put a variable of the form "name=value" into the environment */
 int SDL_putenv(const char *variable)
 {
-	const char *name, *value;
-	int added;
-	int len, i;
-	char **new_env;
 	char *new_variable;
+	size_t namelen;
+	Uint32 hash;
 
 	/* A little error checking */
-	if ( ! variable ) {
-		return(-1);
-	}
-	name = variable;
-	for ( value=variable; *value && (*value != '='); ++value ) {
-		/* Keep looking for '=' */ ;
-	}
-	if ( *value ) {
-		++value;
-	} else {
+	if ( ! variable || ! SDL_strchr(variable, '=') ) {
 		return(-1);
 	}
 
@@ -119,68 +343,57 @@ int SDL_putenv(const char *variable)
 	}
 
 	/* Actually put it into the environment */
-	added = 0;
-	i = 0;
-	if ( SDL_env ) {
-		/* Check to see if it's already there... */
-		len = (value - name);
-		for ( ; SDL_env[i]; ++i ) {
-			if ( SDL_strncmp(SDL_env[i], name, len) == 0 ) {
-				break;
-			}
-		}
-		/* If we found it, just replace the entry */
-		if ( SDL_env[i] ) {
-			SDL_free(SDL_env[i]);
-			SDL_env[i] = new_variable;
-			added = 1;
-		}
-	}
-
-	/* Didn't find it in the environment, expand and add */
-	if ( ! added ) {
-		new_env = SDL_realloc(SDL_env, (i+2)*sizeof(char *));
-		if ( new_env ) {
-			SDL_env = new_env;
-			SDL_env[i++] = new_variable;
-			SDL_env[i++] = (char *)0;
-			added = 1;
-		} else {
-			SDL_free(new_variable);
-		}
+	hash = SDL_HashEnv(new_variable, &namelen);
+	if ( SDL_StoreEnv(new_variable, namelen, hash) < 0 ) {
+		SDL_free(new_variable);
+		return(-1);
 	}
-	return (added ? 0 : -1);
+	SDL_NotifyEnv(new_variable);
+	return(0);
 }
 
 /* Retrieve a variable named "name" from the environment */
 char *SDL_getenv(const char *name)
 {
-	int len, i;
-	char *value;
+	SDL_EnvVar *var;
+	size_t namelen;
+	Uint32 hash;
 
-	value = (char *)0;
-	if ( SDL_env ) {
-		len = SDL_strlen(name);
-		for ( i=0; SDL_env[i] && !value; ++i ) {
-			if ( (SDL_strncmp(SDL_env[i], name, len) == 0) &&
-			     (SDL_env[i][len] == '=') ) {
-				value = &SDL_env[i][len+1];
-			}
-		}
+	hash = SDL_HashEnv(name, &namelen);
+	var = SDL_FindEnv(name, namelen, hash);
+	if ( !var ) {
+#ifdef HAVE_GETENV
+		return(getenv(name));
+#else
+		return((char *)0);
+#endif
 	}
-	return value;
+	return(var->variable + namelen + 1);
 }
 
 #endif /* __WIN32__ */
 
-#endif /* !HAVE_GETENV */
+#endif /* HAVE_GETENV && HAVE_PUTENV */
 
 #ifdef TEST_MAIN
 #include <stdio.h>
 
+static int callbacks = 0;
+
+static void SDLCALL watch_first(void *userdata, const char *name, const char *value)
+{
+	if ( (SDL_strcmp(name, "FIRST") == 0) &&
+	     (SDL_strcmp(value, (const char *)userdata) == 0) ) {
+		++callbacks;
+	}
+	SDL_DelEnvCallback(name, watch_first, userdata);
+}
+
 int main(int argc, char *argv[])
 {
+	char variable[32];
 	char *value;
+	int i;
 
 	printf("Checking for non-existent variable... ");
 	fflush(stdout);
@@ -221,11 +434,20 @@ int main(int argc, char *argv[])
 	}
 	printf("Setting FIRST=NOVALUE in the environment... ");
 	fflush(stdout);
+	SDL_AddEnvCallback("FIRST", watch_first, "NOVALUE");
 	if ( SDL_putenv("FIRST=NOVALUE") == 0 ) {
 		printf("okay\n");
 	} else {
 		printf("failed\n");
 	}
+	printf("Checking the FIRST callback ran once... ");
+	fflush(stdout);
+	SDL_putenv("FIRST=NOVALUE");
+	if ( callbacks == 1 ) {
+		printf("okay\n");
+	} else {
+		printf("failed\n");
+	}
 	printf("Getting FIRST from the environment... ");
 	fflush(stdout);
 	value = SDL_getenv("FIRST");
@@ -241,6 +463,29 @@ int main(int argc, char *argv[])
 	} else {
 		printf("failed\n");
 	}
+	printf("Setting and getting 1000 variables... ");
+	fflush(stdout);
+	for ( i = 0; i < 1000; ++i ) {
+		SDL_snprintf(variable, sizeof(variable), "VAR%d=%d", i, i);
+#if defined(HAVE_GETENV) && defined(HAVE_PUTENV)
+		/* putenv() keeps the string itself */
+		SDL_putenv(SDL_strdup(variable));
+#else
+		SDL_putenv(variable);
+#endif
+	}
+	for ( i = 0; i < 1000; ++i ) {
+		SDL_snprintf(variable, sizeof(variable), "VAR%d", i);
+		value = SDL_getenv(variable);
+		if ( !value || (SDL_atoi(value) != i) ) {
+			break;
+		}
+	}
+	if ( i == 1000 ) {
+		printf("okay\n");
+	} else {
+		printf("failed\n");
+	}
 	return(0);
 }
 #endif /* TEST_MAIN */
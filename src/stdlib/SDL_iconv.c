@@ -64,6 +64,9 @@ size_t SDL_iconv(SDL_iconv_t cd,
 	return retCode;
 }
 
+/* There's no telling how much the C library iconv() will write */
+#define SDL_iconv_outsize(cd, inbuf, inbytesleft)	0
+
 #else
 
 /* Lots of useful information on Unicode at:
@@ -75,6 +78,40 @@ size_t SDL_iconv(SDL_iconv_t cd,
 #define UNKNOWN_ASCII	'?'
 #define UNKNOWN_UNICODE	0xFFFD
 
+/* Vector versions of the ASCII runs in the UTF-8 converters, following
+   SDL_string.c: SSE2 is always there on x86_64, 32-bit Visual C++ builds
+   check for it at run time.
+ */
+#if SDL_ASSEMBLY_ROUTINES
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SDL_ICONV_SSE2	1
+#define SDL_ICONV_VECTOR()	1
+#elif defined(_MSC_VER) && defined(_M_IX86)
+#define SDL_ICONV_SSE2	1
+#define SDL_ICONV_VECTOR()	SDL_HasSSE2()
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SDL_ICONV_NEON	1
+#define SDL_ICONV_VECTOR()	1
+#endif
+#endif /* SDL_ASSEMBLY_ROUTINES */
+
+#if SDL_ICONV_SSE2
+#include <emmintrin.h>
+#include "SDL_cpuinfo.h"
+#elif SDL_ICONV_NEON
+#include <arm_neon.h>
+
+/* Nonzero if any of the bits in mask are set in any lane of v */
+static int neon_anybits(uint8x16_t v, uint8x16_t mask)
+{
+	uint8x8_t bits;
+
+	v = vandq_u8(v, mask);
+	bits = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+	return vget_lane_u64(vreinterpret_u64_u8(bits), 0) != 0;
+}
+#endif
+
 enum {
 	ENCODING_UNKNOWN,
 	ENCODING_ASCII,
@@ -204,6 +241,625 @@ SDL_iconv_t SDL_iconv_open(const char *tocode, const char *fromcode)
 	return (SDL_iconv_t)-1;
 }
 
+/* Decode one UTF-8 sequence (RFC 3629) at p, returning the number of bytes
+   used, or 0 if the sequence runs past the end of the buffer.  Illegal and
+   overlong sequences decode as UNKNOWN_UNICODE instead of failing with
+   SDL_ICONV_EILSEQ, which skips them.
+ */
+static size_t utf8_decode(const Uint8 *p, size_t srclen, Uint32 *chp)
+{
+	static const Uint32 minimum[] = {
+		0, 0x80, 0x800, 0x10000, 0x200000, 0x4000000
+	};
+	Uint32 ch;
+	size_t left = 0;
+	size_t i;
+
+	if ( p[0] >= 0xFE ) {
+		ch = UNKNOWN_UNICODE;
+	} else if ( p[0] >= 0xFC ) {
+		ch = (Uint32)(p[0] & 0x01);
+		left = 5;
+	} else if ( p[0] >= 0xF8 ) {
+		ch = (Uint32)(p[0] & 0x03);
+		left = 4;
+	} else if ( p[0] >= 0xF0 ) {
+		ch = (Uint32)(p[0] & 0x07);
+		left = 3;
+	} else if ( p[0] >= 0xE0 ) {
+		ch = (Uint32)(p[0] & 0x0F);
+		left = 2;
+	} else if ( p[0] >= 0xC0 ) {
+		ch = (Uint32)(p[0] & 0x1F);
+		left = 1;
+	} else if ( p[0] >= 0x80 ) {
+		ch = UNKNOWN_UNICODE;
+	} else {
+		ch = (Uint32)p[0];
+	}
+	if ( srclen - 1 < left ) {
+		return 0;
+	}
+	for ( i = 1; i <= left; ++i ) {
+		if ( (p[i] & 0xC0) != 0x80 ) {
+			*chp = UNKNOWN_UNICODE;
+			return i;
+		}
+		ch <<= 6;
+		ch |= (p[i] & 0x3F);
+	}
+	if ( ch < minimum[left] ) {
+		/* Overlong, a potential security risk */
+		ch = UNKNOWN_UNICODE;
+	}
+	if ( (ch >= 0xD800 && ch <= 0xDFFF) ||
+	     (ch == 0xFFFE || ch == 0xFFFF) ||
+	     ch > 0x10FFFF ) {
+		ch = UNKNOWN_UNICODE;
+	}
+	*chp = ch;
+	return left + 1;
+}
+
+/* Encode a character of at most 0x10FFFF as UTF-8, returning its length */
+static size_t utf8_encode(Uint32 ch, Uint8 *p)
+{
+	if ( ch <= 0x7F ) {
+		p[0] = (Uint8)ch;
+		return 1;
+	} else if ( ch <= 0x7FF ) {
+		p[0] = 0xC0 | (Uint8)(ch >> 6);
+		p[1] = 0x80 | (Uint8)(ch & 0x3F);
+		return 2;
+	} else if ( ch <= 0xFFFF ) {
+		p[0] = 0xE0 | (Uint8)(ch >> 12);
+		p[1] = 0x80 | (Uint8)((ch >> 6) & 0x3F);
+		p[2] = 0x80 | (Uint8)(ch & 0x3F);
+		return 3;
+	} else {
+		p[0] = 0xF0 | (Uint8)(ch >> 18);
+		p[1] = 0x80 | (Uint8)((ch >> 12) & 0x3F);
+		p[2] = 0x80 | (Uint8)((ch >> 6) & 0x3F);
+		p[3] = 0x80 | (Uint8)(ch & 0x3F);
+		return 4;
+	}
+}
+
+#define UTF8_LENGTH(ch) \
+	((ch) <= 0x7F ? 1 : (ch) <= 0x7FF ? 2 : (ch) <= 0xFFFF ? 3 : 4)
+
+/* The ASCII helpers handle the leading ASCII characters of a buffer of len
+   characters, 16 at a time where there are vector instructions, and return
+   how many they handled.
+ */
+static size_t ascii_count(const Uint8 *src, size_t len)
+{
+	size_t i = 0;
+#if SDL_ICONV_SSE2
+	if ( SDL_ICONV_VECTOR() ) {
+		for ( ; i + 16 <= len; i += 16 ) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			if ( _mm_movemask_epi8(v) ) {
+				break;
+			}
+		}
+	}
+#elif SDL_ICONV_NEON
+	for ( ; i + 16 <= len; i += 16 ) {
+		if ( neon_anybits(vld1q_u8(src + i), vdupq_n_u8(0x80)) ) {
+			break;
+		}
+	}
+#endif
+	while ( i < len && src[i] < 0x80 ) {
+		++i;
+	}
+	return i;
+}
+
+static size_t ascii_to_16(const Uint8 *src, Uint16 *dst, size_t len)
+{
+	size_t i = 0;
+#if SDL_ICONV_SSE2
+	if ( SDL_ICONV_VECTOR() ) {
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; i + 16 <= len; i += 16 ) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			if ( _mm_movemask_epi8(v) ) {
+				break;
+			}
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(v, zero));
+			_mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+		}
+	}
+#elif SDL_ICONV_NEON
+	for ( ; i + 16 <= len; i += 16 ) {
+		uint8x16_t v = vld1q_u8(src + i);
+		if ( neon_anybits(v, vdupq_n_u8(0x80)) ) {
+			break;
+		}
+		vst1q_u16(dst + i, vmovl_u8(vget_low_u8(v)));
+		vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(v)));
+	}
+#endif
+	while ( i < len && src[i] < 0x80 ) {
+		dst[i] = src[i];
+		++i;
+	}
+	return i;
+}
+
+static size_t ascii_to_32(const Uint8 *src, Uint32 *dst, size_t len)
+{
+	size_t i = 0;
+#if SDL_ICONV_SSE2
+	if ( SDL_ICONV_VECTOR() ) {
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; i + 16 <= len; i += 16 ) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i lo, hi;
+			if ( _mm_movemask_epi8(v) ) {
+				break;
+			}
+			lo = _mm_unpacklo_epi8(v, zero);
+			hi = _mm_unpackhi_epi8(v, zero);
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(lo, zero));
+			_mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+			_mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+			_mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+		}
+	}
+#elif SDL_ICONV_NEON
+	for ( ; i + 16 <= len; i += 16 ) {
+		uint8x16_t v = vld1q_u8(src + i);
+		uint16x8_t lo, hi;
+		if ( neon_anybits(v, vdupq_n_u8(0x80)) ) {
+			break;
+		}
+		lo = vmovl_u8(vget_low_u8(v));
+		hi = vmovl_u8(vget_high_u8(v));
+		vst1q_u32(dst + i, vmovl_u16(vget_low_u16(lo)));
+		vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(lo)));
+		vst1q_u32(dst + i + 8, vmovl_u16(vget_low_u16(hi)));
+		vst1q_u32(dst + i + 12, vmovl_u16(vget_high_u16(hi)));
+	}
+#endif
+	while ( i < len && src[i] < 0x80 ) {
+		dst[i] = src[i];
+		++i;
+	}
+	return i;
+}
+
+static size_t ascii_from_16(const Uint16 *src, Uint8 *dst, size_t len)
+{
+	size_t i = 0;
+#if SDL_ICONV_SSE2
+	if ( SDL_ICONV_VECTOR() ) {
+		const __m128i mask = _mm_set1_epi16((short)0xFF80);
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; i + 16 <= len; i += 16 ) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(src + i + 8));
+			__m128i high = _mm_and_si128(_mm_or_si128(a, b), mask);
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF ) {
+				break;
+			}
+			_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(a, b));
+		}
+	}
+#elif SDL_ICONV_NEON
+	for ( ; i + 16 <= len; i += 16 ) {
+		uint16x8_t a = vld1q_u16(src + i);
+		uint16x8_t b = vld1q_u16(src + i + 8);
+		if ( neon_anybits(vreinterpretq_u8_u16(vorrq_u16(a, b)),
+		                  vreinterpretq_u8_u16(vdupq_n_u16(0xFF80))) ) {
+			break;
+		}
+		vst1q_u8(dst + i, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+	}
+#endif
+	while ( i < len && src[i] < 0x80 ) {
+		dst[i] = (Uint8)src[i];
+		++i;
+	}
+	return i;
+}
+
+static size_t ascii_from_32(const Uint32 *src, Uint8 *dst, size_t len)
+{
+	size_t i = 0;
+#if SDL_ICONV_SSE2
+	if ( SDL_ICONV_VECTOR() ) {
+		const __m128i mask = _mm_set1_epi32((int)0xFFFFFF80);
+		const __m128i zero = _mm_setzero_si128();
+		for ( ; i + 16 <= len; i += 16 ) {
+			__m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+			__m128i b = _mm_loadu_si128((const __m128i *)(src + i + 4));
+			__m128i c = _mm_loadu_si128((const __m128i *)(src + i + 8));
+			__m128i d = _mm_loadu_si128((const __m128i *)(src + i + 12));
+			__m128i high = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+			high = _mm_and_si128(high, mask);
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi8(high, zero)) != 0xFFFF ) {
+				break;
+			}
+			_mm_storeu_si128((__m128i *)(dst + i),
+				_mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+	}
+#elif SDL_ICONV_NEON
+	for ( ; i + 16 <= len; i += 16 ) {
+		uint32x4_t a = vld1q_u32(src + i);
+		uint32x4_t b = vld1q_u32(src + i + 4);
+		uint32x4_t c = vld1q_u32(src + i + 8);
+		uint32x4_t d = vld1q_u32(src + i + 12);
+		uint32x4_t high = vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d));
+		uint16x8_t lo, hi;
+		if ( neon_anybits(vreinterpretq_u8_u32(high),
+		                  vreinterpretq_u8_u32(vdupq_n_u32(0xFFFFFF80))) ) {
+			break;
+		}
+		lo = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+		hi = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+		vst1q_u8(dst + i, vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+	}
+#endif
+	while ( i < len && src[i] < 0x80 ) {
+		dst[i] = (Uint8)src[i];
+		++i;
+	}
+	return i;
+}
+
+/* The pairs with a dedicated converter, all in native byte order */
+enum {
+	FASTPATH_NONE,
+	FASTPATH_UTF8_UCS2,
+	FASTPATH_UTF8_UTF16,
+	FASTPATH_UTF8_UCS4,
+	FASTPATH_UCS2_UTF8,
+	FASTPATH_UTF16_UTF8,
+	FASTPATH_UCS4_UTF8
+};
+
+static int getfastpath(int src_fmt, int dst_fmt)
+{
+	if ( src_fmt == ENCODING_UTF8 ) {
+		switch ( dst_fmt ) {
+		    case ENCODING_UCS2:
+			return FASTPATH_UTF8_UCS2;
+		    case ENCODING_UTF16NATIVE:
+			return FASTPATH_UTF8_UTF16;
+		    case ENCODING_UCS4:
+		    case ENCODING_UTF32NATIVE:
+			return FASTPATH_UTF8_UCS4;
+		}
+	} else if ( dst_fmt == ENCODING_UTF8 ) {
+		switch ( src_fmt ) {
+		    case ENCODING_UCS2:
+			return FASTPATH_UCS2_UTF8;
+		    case ENCODING_UTF16NATIVE:
+			return FASTPATH_UTF16_UTF8;
+		    case ENCODING_UCS4:
+		    case ENCODING_UTF32NATIVE:
+			return FASTPATH_UCS4_UTF8;
+		}
+	}
+	return FASTPATH_NONE;
+}
+
+/* The converters below give the same results as the character at a time
+   loop in SDL_iconv(), but stop short of any character that is cut off or
+   doesn't fit, leaving SDL_iconv() to report it.  They return the number
+   of characters converted.
+ */
+static size_t utf8_to_utf16(const Uint8 **srcp, size_t *srclenp,
+                            Uint16 **dstp, size_t *dstlenp, SDL_bool ucs2)
+{
+	const Uint8 *src = *srcp;
+	size_t srclen = *srclenp;
+	Uint16 *dst = *dstp;
+	size_t dstlen = *dstlenp / 2;
+	size_t total = 0;
+	size_t n;
+	Uint32 ch;
+
+	while ( srclen > 0 && dstlen > 0 ) {
+		if ( src[0] < 0x80 ) {
+			n = ascii_to_16(src, dst, SDL_min(srclen, dstlen));
+			src += n;
+			srclen -= n;
+			dst += n;
+			dstlen -= n;
+			total += n;
+			continue;
+		}
+		n = utf8_decode(src, srclen, &ch);
+		if ( n == 0 ) {
+			break;
+		}
+		if ( ch <= 0xFFFF ) {
+			*dst++ = (Uint16)ch;
+			--dstlen;
+		} else if ( ucs2 ) {
+			*dst++ = UNKNOWN_UNICODE;
+			--dstlen;
+		} else {
+			if ( dstlen < 2 ) {
+				break;
+			}
+			ch -= 0x10000;
+			dst[0] = 0xD800 | (Uint16)(ch >> 10);
+			dst[1] = 0xDC00 | (Uint16)(ch & 0x3FF);
+			dst += 2;
+			dstlen -= 2;
+		}
+		src += n;
+		srclen -= n;
+		++total;
+	}
+	*srcp = src;
+	*srclenp = srclen;
+	*dstlenp -= (dst - *dstp) * 2;
+	*dstp = dst;
+	return total;
+}
+
+static size_t utf8_to_ucs4(const Uint8 **srcp, size_t *srclenp,
+                           Uint32 **dstp, size_t *dstlenp)
+{
+	const Uint8 *src = *srcp;
+	size_t srclen = *srclenp;
+	Uint32 *dst = *dstp;
+	size_t dstlen = *dstlenp / 4;
+	size_t total = 0;
+	size_t n;
+	Uint32 ch;
+
+	while ( srclen > 0 && dstlen > 0 ) {
+		if ( src[0] < 0x80 ) {
+			n = ascii_to_32(src, dst, SDL_min(srclen, dstlen));
+			src += n;
+			srclen -= n;
+			dst += n;
+			dstlen -= n;
+			total += n;
+			continue;
+		}
+		n = utf8_decode(src, srclen, &ch);
+		if ( n == 0 ) {
+			break;
+		}
+		*dst++ = ch;
+		--dstlen;
+		src += n;
+		srclen -= n;
+		++total;
+	}
+	*srcp = src;
+	*srclenp = srclen;
+	*dstlenp -= (dst - *dstp) * 4;
+	*dstp = dst;
+	return total;
+}
+
+static size_t utf16_to_utf8(const Uint16 **srcp, size_t *srclenp,
+                            Uint8 **dstp, size_t *dstlenp, SDL_bool ucs2)
+{
+	const Uint16 *src = *srcp;
+	size_t srclen = *srclenp / 2;
+	Uint8 *dst = *dstp;
+	size_t dstlen = *dstlenp;
+	size_t total = 0;
+	size_t n, used;
+	Uint32 ch;
+
+	while ( srclen > 0 && dstlen > 0 ) {
+		if ( src[0] < 0x80 ) {
+			n = ascii_from_16(src, dst, SDL_min(srclen, dstlen));
+			src += n;
+			srclen -= n;
+			dst += n;
+			dstlen -= n;
+			total += n;
+			continue;
+		}
+		ch = src[0];
+		used = 1;
+		if ( !ucs2 && ch >= 0xD800 && ch <= 0xDFFF ) {
+			if ( ch > 0xDBFF ) {
+				ch = UNKNOWN_UNICODE;
+			} else if ( srclen < 2 ) {
+				break;
+			} else if ( src[1] < 0xDC00 || src[1] > 0xDFFF ) {
+				ch = UNKNOWN_UNICODE;
+				used = 2;
+			} else {
+				ch = (((ch & 0x3FF) << 10) | (src[1] & 0x3FF)) + 0x10000;
+				used = 2;
+			}
+		}
+		if ( dstlen < UTF8_LENGTH(ch) ) {
+			break;
+		}
+		n = utf8_encode(ch, dst);
+		dst += n;
+		dstlen -= n;
+		src += used;
+		srclen -= used;
+		++total;
+	}
+	*srclenp -= (src - *srcp) * 2;
+	*srcp = src;
+	*dstp = dst;
+	*dstlenp = dstlen;
+	return total;
+}
+
+static size_t ucs4_to_utf8(const Uint32 **srcp, size_t *srclenp,
+                           Uint8 **dstp, size_t *dstlenp)
+{
+	const Uint32 *src = *srcp;
+	size_t srclen = *srclenp / 4;
+	Uint8 *dst = *dstp;
+	size_t dstlen = *dstlenp;
+	size_t total = 0;
+	size_t n;
+	Uint32 ch;
+
+	while ( srclen > 0 && dstlen > 0 ) {
+		if ( src[0] < 0x80 ) {
+			n = ascii_from_32(src, dst, SDL_min(srclen, dstlen));
+			src += n;
+			srclen -= n;
+			dst += n;
+			dstlen -= n;
+			total += n;
+			continue;
+		}
+		ch = src[0];
+		if ( ch > 0x10FFFF ) {
+			ch = UNKNOWN_UNICODE;
+		}
+		if ( dstlen < UTF8_LENGTH(ch) ) {
+			break;
+		}
+		n = utf8_encode(ch, dst);
+		dst += n;
+		dstlen -= n;
+		++src;
+		--srclen;
+		++total;
+	}
+	*srclenp -= (src - *srcp) * 4;
+	*srcp = src;
+	*dstp = dst;
+	*dstlenp = dstlen;
+	return total;
+}
+
+static size_t convert_fast(int fastpath,
+                           const char **src, size_t *srclen,
+                           char **dst, size_t *dstlen)
+{
+	switch ( fastpath ) {
+	    case FASTPATH_UTF8_UCS2:
+	    case FASTPATH_UTF8_UTF16:
+		return utf8_to_utf16((const Uint8 **)src, srclen,
+		                     (Uint16 **)dst, dstlen,
+		                     (fastpath == FASTPATH_UTF8_UCS2));
+	    case FASTPATH_UTF8_UCS4:
+		return utf8_to_ucs4((const Uint8 **)src, srclen,
+		                    (Uint32 **)dst, dstlen);
+	    case FASTPATH_UCS2_UTF8:
+	    case FASTPATH_UTF16_UTF8:
+		return utf16_to_utf8((const Uint16 **)src, srclen,
+		                     (Uint8 **)dst, dstlen,
+		                     (fastpath == FASTPATH_UCS2_UTF8));
+	    case FASTPATH_UCS4_UTF8:
+		return ucs4_to_utf8((const Uint32 **)src, srclen,
+		                    (Uint8 **)dst, dstlen);
+	}
+	return 0;
+}
+
+/* Return the exact number of bytes SDL_iconv() will write converting all
+   of inbuf, or 0 if it can't be worked out ahead of time.
+ */
+static size_t SDL_iconv_outsize(SDL_iconv_t cd, const char *inbuf, size_t inbytesleft)
+{
+	int dst_fmt = cd->dst_fmt;
+	int fastpath;
+	size_t size = 0;
+	size_t n;
+	Uint32 ch;
+
+	/* A byte order marker goes out ahead of everything else */
+	if ( dst_fmt == ENCODING_UTF16 ) {
+		dst_fmt = ENCODING_UTF16NATIVE;
+		size += 2;
+	} else if ( dst_fmt == ENCODING_UTF32 ) {
+		dst_fmt = ENCODING_UTF32NATIVE;
+		size += 4;
+	}
+
+	fastpath = getfastpath(cd->src_fmt, dst_fmt);
+	switch ( fastpath ) {
+	    case FASTPATH_UTF8_UCS2:
+	    case FASTPATH_UTF8_UTF16:
+	    case FASTPATH_UTF8_UCS4:
+		{
+			const Uint8 *p = (const Uint8 *)inbuf;
+			size_t unit = (fastpath == FASTPATH_UTF8_UCS4) ? 4 : 2;
+
+			while ( inbytesleft > 0 ) {
+				n = ascii_count(p, inbytesleft);
+				size += n * unit;
+				p += n;
+				inbytesleft -= n;
+				if ( inbytesleft == 0 ) {
+					break;
+				}
+				n = utf8_decode(p, inbytesleft, &ch);
+				if ( n == 0 ) {
+					break;
+				}
+				size += unit;
+				if ( ch > 0xFFFF && fastpath == FASTPATH_UTF8_UTF16 ) {
+					size += 2;
+				}
+				p += n;
+				inbytesleft -= n;
+			}
+		}
+		break;
+	    case FASTPATH_UCS2_UTF8:
+	    case FASTPATH_UTF16_UTF8:
+		{
+			const Uint16 *p = (const Uint16 *)inbuf;
+			size_t left = inbytesleft / 2;
+
+			while ( left > 0 ) {
+				ch = *p++;
+				--left;
+				if ( fastpath == FASTPATH_UTF16_UTF8 &&
+				     ch >= 0xD800 && ch <= 0xDFFF ) {
+					if ( ch <= 0xDBFF ) {
+						if ( left == 0 ) {
+							break;
+						}
+						if ( *p >= 0xDC00 && *p <= 0xDFFF ) {
+							ch = 0x10000;
+						}
+						++p;
+						--left;
+					}
+				}
+				size += UTF8_LENGTH(ch);
+			}
+		}
+		break;
+	    case FASTPATH_UCS4_UTF8:
+		{
+			const Uint32 *p = (const Uint32 *)inbuf;
+			size_t left = inbytesleft / 4;
+
+			while ( left > 0 ) {
+				ch = *p++;
+				--left;
+				if ( ch > 0x10FFFF ) {
+					ch = UNKNOWN_UNICODE;
+				}
+				size += UTF8_LENGTH(ch);
+			}
+		}
+		break;
+	    default:
+		return 0;
+	}
+	return size;
+}
+
 size_t SDL_iconv(SDL_iconv_t cd,
                  const char **inbuf, size_t *inbytesleft,
                  char **outbuf, size_t *outbytesleft)
@@ -214,6 +870,7 @@ size_t SDL_iconv(SDL_iconv_t cd,
 	size_t srclen, dstlen;
 	Uint32 ch = 0;
 	size_t total;
+	int fastpath;
 
 	if ( !inbuf || !*inbuf ) {
 		/* Reset the context */
@@ -298,9 +955,24 @@ size_t SDL_iconv(SDL_iconv_t cd,
 		cd->dst_fmt = ENCODING_UTF32NATIVE;
 		break;
 	}
+	/* Keep the byte order marker even if nothing else fits */
+	*outbuf = dst;
+	*outbytesleft = dstlen;
 
 	total = 0;
+	fastpath = getfastpath(cd->src_fmt, cd->dst_fmt);
 	while ( srclen > 0 ) {
+		if ( fastpath != FASTPATH_NONE ) {
+			total += convert_fast(fastpath, &src, &srclen, &dst, &dstlen);
+			*inbuf = src;
+			*inbytesleft = srclen;
+			*outbuf = dst;
+			*outbytesleft = dstlen;
+			if ( srclen == 0 ) {
+				break;
+			}
+		}
+
 		/* Decode a character */
 		switch ( cd->src_fmt ) {
 		    case ENCODING_ASCII:
@@ -321,117 +993,12 @@ size_t SDL_iconv(SDL_iconv_t cd,
 			break;
 		    case ENCODING_UTF8: /* RFC 3629 */
 			{
-				Uint8 *p = (Uint8 *)src;
-				size_t left = 0;
-				SDL_bool overlong = SDL_FALSE;
-				if ( p[0] >= 0xFC ) {
-					if ( (p[0] & 0xFE) != 0xFC ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						if ( p[0] == 0xFC ) {
-							overlong = SDL_TRUE;
-						}
-						ch = (Uint32)(p[0] & 0x01);
-						left = 5;
-					}
-				} else if ( p[0] >= 0xF8 ) {
-					if ( (p[0] & 0xFC) != 0xF8 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						if ( p[0] == 0xF8 ) {
-							overlong = SDL_TRUE;
-						}
-						ch = (Uint32)(p[0] & 0x03);
-						left = 4;
-					}
-				} else if ( p[0] >= 0xF0 ) {
-					if ( (p[0] & 0xF8) != 0xF0 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						if ( p[0] == 0xF0 ) {
-							overlong = SDL_TRUE;
-						}
-						ch = (Uint32)(p[0] & 0x07);
-						left = 3;
-					}
-				} else if ( p[0] >= 0xE0 ) {
-					if ( (p[0] & 0xF0) != 0xE0 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						if ( p[0] == 0xE0 ) {
-							overlong = SDL_TRUE;
-						}
-						ch = (Uint32)(p[0] & 0x0F);
-						left = 2;
-					}
-				} else if ( p[0] >= 0xC0 ) {
-					if ( (p[0] & 0xE0) != 0xC0 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						if ( (p[0] & 0xDE) == 0xC0 ) {
-							overlong = SDL_TRUE;
-						}
-						ch = (Uint32)(p[0] & 0x1F);
-						left = 1;
-					}
-				} else {
-					if ( (p[0] & 0x80) != 0x00 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-					} else {
-						ch = (Uint32)p[0];
-					}
-				}
-				++src;
-				--srclen;
-				if ( srclen < left ) {
+				size_t n = utf8_decode((const Uint8 *)src, srclen, &ch);
+				if ( n == 0 ) {
 					return SDL_ICONV_EINVAL;
 				}
-				while ( left-- ) {
-					++p;
-					if ( (p[0] & 0xC0) != 0x80 ) {
-						/* Skip illegal sequences
-						return SDL_ICONV_EILSEQ;
-						*/
-						ch = UNKNOWN_UNICODE;
-						break;
-					}
-					ch <<= 6;
-					ch |= (p[0] & 0x3F);
-					++src;
-					--srclen;
-				}
-				if ( overlong ) {
-					/* Potential security risk
-					return SDL_ICONV_EILSEQ;
-					*/
-					ch = UNKNOWN_UNICODE;
-				}
-				if ( (ch >= 0xD800 && ch <= 0xDFFF) ||
-				     (ch == 0xFFFE || ch == 0xFFFF) ||
-				     ch > 0x10FFFF ) {
-					/* Skip illegal sequences
-					return SDL_ICONV_EILSEQ;
-					*/
-					ch = UNKNOWN_UNICODE;
-				}
+				src += n;
+				srclen -= n;
 			}
 			break;
 		    case ENCODING_UTF16BE: /* RFC 2781 */
@@ -836,7 +1403,15 @@ char *SDL_iconv_string(const char *tocode, const char *fromcode, const char *inb
 		return NULL;
 	}
 
-	stringsize = inbytesleft > 4 ? inbytesleft : 4;
+	/* Allocate the output once when its size is known, with room for a
+	   terminator in any encoding, or grow it as needed otherwise.
+	 */
+	stringsize = SDL_iconv_outsize(cd, inbuf, inbytesleft);
+	if ( stringsize ) {
+		stringsize += 4;
+	} else {
+		stringsize = inbytesleft > 4 ? inbytesleft : 4;
+	}
 	string = SDL_malloc(stringsize);
 	if ( !string ) {
 		SDL_iconv_close(cd);
@@ -845,6 +1420,7 @@ char *SDL_iconv_string(const char *tocode, const char *fromcode, const char *inb
 	outbuf = string;
 	outbytesleft = stringsize;
 	SDL_memset(outbuf, 0, 4);
+	SDL_memset(outbuf + stringsize - 4, 0, 4);
 
 	while ( inbytesleft > 0 ) {
 		retCode = SDL_iconv(cd, &inbuf, &inbytesleft, &outbuf, &outbytesleft);
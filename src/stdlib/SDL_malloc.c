@@ -33,6 +33,28 @@
 #define LACKS_STDLIB_H
 #define ABORT
 
+/* SDL_MALLOC_ARENAS is the number of independent heaps SDL_malloc()
+   spreads threads across.  Each thread is handed a home heap in turn,
+   kept with its thread local data, and moves to another one while that
+   is busy, so threads rarely wait on each other.  Memory is freed back to the heap
+   it came from, found through the chunk footer.  Without an atomic
+   exchange to build the heap locks there is a single unlocked heap.
+*/
+#ifndef SDL_MALLOC_ARENAS
+#if defined(SDL_THREADS_DISABLED)
+#define SDL_MALLOC_ARENAS	1
+#elif defined(__GNUC__) || defined(_WIN32)
+#define SDL_MALLOC_ARENAS	4
+#else
+#define SDL_MALLOC_ARENAS	1
+#endif
+#endif
+#if SDL_MALLOC_ARENAS > 1
+#define ONLY_MSPACES 1
+#define FOOTERS 1
+#endif
+#define USE_DL_PREFIX
+
 /*
   This is a version (aka dlmalloc) of malloc/free/realloc written by
   Doug Lea and released to the public domain, as explained at
@@ -4858,23 +4880,27 @@ void mspace_malloc_stats(mspace msp) {
 }
 
 size_t mspace_footprint(mspace msp) {
-  size_t result;
+  size_t result = 0;
   mstate ms = (mstate)msp;
   if (ok_magic(ms)) {
     result = ms->footprint;
   }
-  USAGE_ERROR_ACTION(ms,ms);
+  else {
+    USAGE_ERROR_ACTION(ms,ms);
+  }
   return result;
 }
 
 
 size_t mspace_max_footprint(mspace msp) {
-  size_t result;
+  size_t result = 0;
   mstate ms = (mstate)msp;
   if (ok_magic(ms)) {
     result = ms->max_footprint;
   }
-  USAGE_ERROR_ACTION(ms,ms);
+  else {
+    USAGE_ERROR_ACTION(ms,ms);
+  }
   return result;
 }
 
@@ -5168,4 +5194,321 @@ History:
  
 */
 
+
+/* ---------------------------- SDL entry points ------------------------- */
+
+#include "SDL_error.h"
+#include "SDL_thread.h"
+#include "SDL_atomic.h"
+#include "../thread/SDL_systhread.h"
+
+typedef struct SDL_MallocArena {
+	SDL_SpinLock lock;
+	mstate space;
+	size_t in_use;
+	size_t peak;
+	Uint32 allocations;
+	Uint32 frees;
+	Uint32 size_class[SDL_MALLOC_SIZE_CLASSES];
+} SDL_MallocArena;
+
+/* Live allocation statistics, including the peak across all arenas.
+   Each arena's counters are guarded by its lock, the peak by its own.
+ */
+static SDL_MallocArena arenas[SDL_MALLOC_ARENAS];
+static size_t malloc_peak;
+#if SDL_MALLOC_ARENAS > 1
+static SDL_SpinLock malloc_peak_lock;
+#define PEAK_LOCK()	SDL_AtomicLock(&malloc_peak_lock)
+#define PEAK_UNLOCK()	SDL_AtomicUnlock(&malloc_peak_lock)
+#else
+#define PEAK_LOCK()
+#define PEAK_UNLOCK()
+#endif
+
+static int malloc_size_class(size_t size)
+{
+	int sizeclass = 0;
+
+	size = (size - 1) >> 4;
+	while ( size && (sizeclass < SDL_MALLOC_SIZE_CLASSES-1) ) {
+		size >>= 1;
+		++sizeclass;
+	}
+	return(sizeclass);
+}
+
+static size_t malloc_chunk_size(void *mem)
+{
+	mchunkptr p = mem2chunk(mem);
+	return(chunksize(p) - overhead_for(p));
+}
+
+/* Called with the caller's arena locked.  The other arenas can't be
+   locked from here without risking a deadlock, so their totals are
+   read as they stand; each is a single aligned word.
+ */
+static void malloc_peak_check(void)
+{
+	size_t in_use = 0;
+	int i;
+
+	for ( i = 0; i < SDL_MALLOC_ARENAS; ++i ) {
+		in_use += *(volatile size_t *)&arenas[i].in_use;
+	}
+	PEAK_LOCK();
+	if ( in_use > malloc_peak ) {
+		malloc_peak = in_use;
+	}
+	PEAK_UNLOCK();
+}
+
+static void malloc_count(SDL_MallocArena *arena, void *mem)
+{
+	size_t size = malloc_chunk_size(mem);
+
+	arena->in_use += size;
+	++arena->allocations;
+	++arena->size_class[malloc_size_class(size)];
+	/* The arenas are only summed when this one reaches a new high,
+	   so the peak is exact for one arena and sampled across several.
+	 */
+	if ( arena->in_use > arena->peak ) {
+		arena->peak = arena->in_use;
+		malloc_peak_check();
+	}
+}
+
+static void malloc_uncount(SDL_MallocArena *arena, void *mem)
+{
+	size_t size = malloc_chunk_size(mem);
+
+	arena->in_use -= size;
+	++arena->frees;
+	--arena->size_class[malloc_size_class(size)];
+}
+
+#if SDL_MALLOC_ARENAS > 1
+
+#define ARENA_TRYLOCK(arena)	SDL_AtomicTryLock(&(arena)->lock)
+#define ARENA_UNLOCK(arena)	SDL_AtomicUnlock(&(arena)->lock)
+
+static void arena_lock(SDL_MallocArena *arena)
+{
+	SDL_AtomicLock(&arena->lock);
+}
+
+/* The calling thread's home arena.  Threads get one in turn when their
+   thread local data is first seen, and threads without any yet start
+   from the first arena.  The data is only looked at here, creating it
+   would allocate.
+ */
+static int arena_home(void)
+{
+	static SDL_atomic_t next_arena;
+	SDL_TLSData *data = SDL_SYS_GetTLSData();
+
+	if ( !data ) {
+		return(0);
+	}
+	if ( !data->malloc_arena ) {
+		data->malloc_arena = 1 + (int)((unsigned int)SDL_AtomicIncRef(&next_arena) % SDL_MALLOC_ARENAS);
+	}
+	return(data->malloc_arena - 1);
+}
+
+/* Lock and return an arena for the calling thread, creating it if needed */
+static SDL_MallocArena *arena_acquire(void)
+{
+	static SDL_MallocArena init;
+	SDL_MallocArena *arena;
+	int i, home;
+
+	home = arena_home();
+	for ( i = 0; i < SDL_MALLOC_ARENAS; ++i ) {
+		arena = &arenas[(home + i) % SDL_MALLOC_ARENAS];
+		if ( ARENA_TRYLOCK(arena) ) {
+			break;
+		}
+	}
+	if ( i == SDL_MALLOC_ARENAS ) {
+		arena = &arenas[home];
+		arena_lock(arena);
+	}
+	if ( !arena->space ) {
+		/* dlmalloc sets up its parameters on first use, unlocked */
+		arena_lock(&init);
+		arena->space = (mstate)create_mspace(0, 0);
+		ARENA_UNLOCK(&init);
+		if ( !arena->space ) {
+			ARENA_UNLOCK(arena);
+			return(NULL);
+		}
+	}
+	return(arena);
+}
+
+/* Lock and return the arena that owns an allocation */
+static SDL_MallocArena *arena_owner(void *mem)
+{
+	mstate space = get_mstate_for(mem2chunk(mem));
+	int i;
+
+	for ( i = 0; i < SDL_MALLOC_ARENAS; ++i ) {
+		if ( arenas[i].space == space ) {
+			arena_lock(&arenas[i]);
+			return(&arenas[i]);
+		}
+	}
+	USAGE_ERROR_ACTION(space, mem);
+	return(NULL);
+}
+
+void *SDL_malloc(size_t size)
+{
+	SDL_MallocArena *arena = arena_acquire();
+	void *mem = NULL;
+
+	if ( arena ) {
+		mem = mspace_malloc(arena->space, size);
+		if ( mem ) {
+			malloc_count(arena, mem);
+		}
+		ARENA_UNLOCK(arena);
+	}
+	return(mem);
+}
+
+void *SDL_calloc(size_t nmemb, size_t size)
+{
+	SDL_MallocArena *arena = arena_acquire();
+	void *mem = NULL;
+
+	if ( arena ) {
+		mem = mspace_calloc(arena->space, nmemb, size);
+		if ( mem ) {
+			malloc_count(arena, mem);
+		}
+		ARENA_UNLOCK(arena);
+	}
+	return(mem);
+}
+
+void *SDL_realloc(void *mem, size_t size)
+{
+	SDL_MallocArena *arena;
+	void *newmem;
+
+	if ( !mem ) {
+		return(SDL_malloc(size));
+	}
+	arena = arena_owner(mem);
+	if ( !arena ) {
+		return(NULL);
+	}
+	malloc_uncount(arena, mem);
+	newmem = mspace_realloc(arena->space, mem, size);
+	malloc_count(arena, newmem ? newmem : mem);
+	ARENA_UNLOCK(arena);
+	return(newmem);
+}
+
+void SDL_free(void *mem)
+{
+	SDL_MallocArena *arena;
+
+	if ( !mem ) {
+		return;
+	}
+	arena = arena_owner(mem);
+	if ( arena ) {
+		malloc_uncount(arena, mem);
+		mspace_free(arena->space, mem);
+		ARENA_UNLOCK(arena);
+	}
+}
+
+#else /* SDL_MALLOC_ARENAS == 1 */
+
+void *SDL_malloc(size_t size)
+{
+	void *mem = dlmalloc(size);
+	if ( mem ) {
+		malloc_count(&arenas[0], mem);
+	}
+	return(mem);
+}
+
+void *SDL_calloc(size_t nmemb, size_t size)
+{
+	void *mem = dlcalloc(nmemb, size);
+	if ( mem ) {
+		malloc_count(&arenas[0], mem);
+	}
+	return(mem);
+}
+
+void *SDL_realloc(void *mem, size_t size)
+{
+	void *newmem;
+
+	if ( !mem ) {
+		return(SDL_malloc(size));
+	}
+	malloc_uncount(&arenas[0], mem);
+	newmem = dlrealloc(mem, size);
+	malloc_count(&arenas[0], newmem ? newmem : mem);
+	return(newmem);
+}
+
+void SDL_free(void *mem)
+{
+	if ( mem ) {
+		malloc_uncount(&arenas[0], mem);
+		dlfree(mem);
+	}
+}
+
+#endif /* SDL_MALLOC_ARENAS > 1 */
+
+int SDL_GetMallocStats(SDL_MallocStats *stats)
+{
+	int i, j;
+
+	memset(stats, 0, sizeof(*stats));
+	for ( i = 0; i < SDL_MALLOC_ARENAS; ++i ) {
+#if SDL_MALLOC_ARENAS > 1
+		arena_lock(&arenas[i]);
+#endif
+		stats->in_use += arenas[i].in_use;
+		stats->allocations += arenas[i].allocations;
+		stats->frees += arenas[i].frees;
+		for ( j = 0; j < SDL_MALLOC_SIZE_CLASSES; ++j ) {
+			stats->size_class[j] += arenas[i].size_class[j];
+		}
+#if SDL_MALLOC_ARENAS > 1
+		ARENA_UNLOCK(&arenas[i]);
+#endif
+	}
+	PEAK_LOCK();
+	stats->peak = malloc_peak;
+	PEAK_UNLOCK();
+	if ( stats->peak < stats->in_use ) {
+		stats->peak = stats->in_use;
+	}
+	stats->arenas = SDL_MALLOC_ARENAS;
+	return(0);
+}
+
+#else /* HAVE_MALLOC */
+
+#include "SDL_error.h"
+
+int SDL_GetMallocStats(SDL_MallocStats *stats)
+{
+	SDL_memset(stats, 0, sizeof(*stats));
+	SDL_SetError("Allocation statistics need SDL's built-in malloc");
+	return(-1);
+}
+
 #endif /* !HAVE_MALLOC */
@@ -0,0 +1,299 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Radix sorts for integer keys, with an optional threaded merge sort on top */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+#include "SDL_job.h"
+
+/* Arrays this short are insertion sorted without a scratch buffer */
+#define SORT_INSERTION_MAX	32
+
+/* Arrays shorter than this aren't worth splitting across threads */
+#define SORT_PARALLEL_MIN	(64*1024)
+
+#define SORT_MAX_THREADS	16
+
+/* Operations on one item type, so the threading code can be shared */
+typedef struct SDL_SortOps {
+	size_t size;
+	void (*sort)(void *items, void *tmp, size_t n, int sign);
+	void (*merge)(const void *a, size_t na, const void *b, size_t nb,
+	              void *dst, int sign);
+} SDL_SortOps;
+
+/* Stable LSD radix sort, one byte of the key per pass.  A single pass
+   counts every digit, and a pass is skipped when all the keys share its
+   digit.  Signed keys get the top bit of their last digit flipped so
+   negative keys sort first.
+ */
+#define DEFINE_SORT(BITS)						\
+static void InsertionSort##BITS(SDL_SortKey##BITS *items, size_t n, int sign) \
+{									\
+	SDL_SortKey##BITS item;						\
+	size_t i, j;							\
+									\
+	for ( i = 1; i < n; ++i ) {					\
+		item = items[i];					\
+		j = i;							\
+		while ( j > 0 && (sign ?				\
+		        (Sint##BITS)items[j-1].key > (Sint##BITS)item.key : \
+		        items[j-1].key > item.key) ) {			\
+			items[j] = items[j-1];				\
+			--j;						\
+		}							\
+		items[j] = item;					\
+	}								\
+}									\
+									\
+static void RadixSort##BITS(void *data, void *scratch, size_t n, int sign) \
+{									\
+	SDL_SortKey##BITS *src = (SDL_SortKey##BITS *)data;		\
+	SDL_SortKey##BITS *dst = (SDL_SortKey##BITS *)scratch;		\
+	SDL_SortKey##BITS *swap;					\
+	size_t count[BITS/8][256];					\
+	size_t i, offset, total;					\
+	Uint##BITS topbit = sign ? ((Uint##BITS)0x80 << (BITS-8)) : 0;	\
+	Uint##BITS key;							\
+	int pass;							\
+									\
+	if ( n <= SORT_INSERTION_MAX ) {				\
+		InsertionSort##BITS(src, n, sign);			\
+		return;							\
+	}								\
+	SDL_memset(count, 0, sizeof(count));				\
+	for ( i = 0; i < n; ++i ) {					\
+		key = src[i].key ^ topbit;				\
+		for ( pass = 0; pass < BITS/8; ++pass ) {		\
+			++count[pass][(key >> (pass*8)) & 0xFF];	\
+		}							\
+	}								\
+	for ( pass = 0; pass < BITS/8; ++pass ) {			\
+		key = src[0].key ^ topbit;				\
+		if ( count[pass][(key >> (pass*8)) & 0xFF] == n ) {	\
+			continue;					\
+		}							\
+		total = 0;						\
+		for ( i = 0; i < 256; ++i ) {				\
+			offset = count[pass][i];			\
+			count[pass][i] = total;				\
+			total += offset;				\
+		}							\
+		for ( i = 0; i < n; ++i ) {				\
+			key = src[i].key ^ topbit;			\
+			dst[count[pass][(key >> (pass*8)) & 0xFF]++] = src[i]; \
+		}							\
+		swap = src;						\
+		src = dst;						\
+		dst = swap;						\
+	}								\
+	if ( src != (SDL_SortKey##BITS *)data ) {			\
+		SDL_memcpy(data, src, n * sizeof(*src));		\
+	}								\
+}									\
+									\
+static void Merge##BITS(const void *adata, size_t na,			\
+                        const void *bdata, size_t nb, void *out, int sign) \
+{									\
+	const SDL_SortKey##BITS *a = (const SDL_SortKey##BITS *)adata;	\
+	const SDL_SortKey##BITS *b = (const SDL_SortKey##BITS *)bdata;	\
+	SDL_SortKey##BITS *dst = (SDL_SortKey##BITS *)out;		\
+	size_t i = 0, j = 0;						\
+									\
+	while ( i < na && j < nb ) {					\
+		if ( sign ? (Sint##BITS)b[j].key < (Sint##BITS)a[i].key : \
+		            b[j].key < a[i].key ) {			\
+			*dst++ = b[j++];				\
+		} else {						\
+			*dst++ = a[i++];				\
+		}							\
+	}								\
+	SDL_memcpy(dst, &a[i], (na - i) * sizeof(*a));			\
+	dst += (na - i);						\
+	SDL_memcpy(dst, &b[j], (nb - j) * sizeof(*b));			\
+}									\
+									\
+static const SDL_SortOps ops##BITS = {					\
+	sizeof(SDL_SortKey##BITS), RadixSort##BITS, Merge##BITS		\
+};
+
+DEFINE_SORT(32)
+DEFINE_SORT(64)
+
+/* One part of a parallel sort: sorting a chunk, or merging two chunks */
+typedef struct SDL_SortJob {
+	const SDL_SortOps *ops;
+	Uint8 *src;
+	Uint8 *dst;
+	size_t n;
+	size_t n2;
+	int sign;
+	int merge;
+} SDL_SortJob;
+
+static void RunSortJob(SDL_SortJob *job)
+{
+	if ( job->merge ) {
+		job->ops->merge(job->src, job->n, job->src + job->n * job->ops->size,
+		                job->n2, job->dst, job->sign);
+	} else {
+		job->ops->sort(job->src, job->dst, job->n, job->sign);
+	}
+}
+
+static void SDLCALL RunSortJobRange(void *data, int start, int end)
+{
+	SDL_SortJob *jobs = (SDL_SortJob *)data;
+	int i;
+
+	for ( i = start; i < end; ++i ) {
+		RunSortJob(&jobs[i]);
+	}
+}
+
+/* Run the jobs on the job pool, this thread taking its share */
+static void RunSortJobs(SDL_SortJob *jobs, int numjobs)
+{
+	SDL_ParallelFor(0, numjobs, 1, RunSortJobRange, jobs);
+}
+
+/* A chunk for each job worker and this thread, unless overridden */
+static int SortThreads(void)
+{
+	const char *env;
+	int numthreads;
+
+	env = SDL_getenv("SDL_SORT_THREADS");
+	if ( env ) {
+		numthreads = SDL_atoi(env);
+	} else {
+		numthreads = SDL_GetJobThreadCount() + 1;
+	}
+	if ( numthreads < 1 ) {
+		numthreads = 1;
+	}
+	if ( numthreads > SORT_MAX_THREADS ) {
+		numthreads = SORT_MAX_THREADS;
+	}
+	return(numthreads);
+}
+
+/* Radix sort a chunk per thread, then merge pairs of chunks in parallel,
+   bouncing between the array and the scratch buffer, until one is left.
+ */
+static void ParallelSort(const SDL_SortOps *ops, Uint8 *items, Uint8 *tmp,
+                         size_t n, int sign, int numchunks)
+{
+	SDL_SortJob jobs[SORT_MAX_THREADS];
+	size_t bounds[SORT_MAX_THREADS+1];
+	Uint8 *src = items, *dst = tmp, *swap;
+	size_t size = ops->size;
+	int i, numjobs;
+
+	for ( i = 0; i <= numchunks; ++i ) {
+		bounds[i] = (n * i) / numchunks;
+	}
+	for ( i = 0; i < numchunks; ++i ) {
+		jobs[i].ops = ops;
+		jobs[i].src = items + bounds[i] * size;
+		jobs[i].dst = tmp + bounds[i] * size;
+		jobs[i].n = bounds[i+1] - bounds[i];
+		jobs[i].sign = sign;
+		jobs[i].merge = 0;
+	}
+	RunSortJobs(jobs, numchunks);
+
+	while ( numchunks > 1 ) {
+		numjobs = 0;
+		for ( i = 0; i + 1 < numchunks; i += 2 ) {
+			jobs[numjobs].ops = ops;
+			jobs[numjobs].src = src + bounds[i] * size;
+			jobs[numjobs].dst = dst + bounds[i] * size;
+			jobs[numjobs].n = bounds[i+1] - bounds[i];
+			jobs[numjobs].n2 = bounds[i+2] - bounds[i+1];
+			jobs[numjobs].sign = sign;
+			jobs[numjobs].merge = 1;
+			++numjobs;
+		}
+		if ( i < numchunks ) {
+			/* The odd chunk out moves across unmerged */
+			SDL_memcpy(dst + bounds[i] * size, src + bounds[i] * size,
+			           (bounds[i+1] - bounds[i]) * size);
+		}
+		RunSortJobs(jobs, numjobs);
+
+		for ( i = 0; i < numjobs; ++i ) {
+			bounds[i] = bounds[i*2];
+		}
+		bounds[numjobs] = bounds[numchunks & ~1];
+		if ( numchunks & 1 ) {
+			bounds[numjobs+1] = bounds[numchunks];
+		}
+		numchunks = numjobs + (numchunks & 1);
+
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+	if ( src != items ) {
+		SDL_memcpy(items, src, n * size);
+	}
+}
+
+static int SortKeys(const SDL_SortOps *ops, void *items, size_t n, Uint32 flags)
+{
+	int sign = (flags & SDL_SORT_SIGNED) ? 1 : 0;
+	int numthreads = 1;
+	void *tmp;
+
+	if ( n <= SORT_INSERTION_MAX ) {
+		ops->sort(items, NULL, n, sign);
+		return(0);
+	}
+	tmp = SDL_malloc(n * ops->size);
+	if ( tmp == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	if ( (flags & SDL_SORT_PARALLEL) && (n >= SORT_PARALLEL_MIN) ) {
+		numthreads = SortThreads();
+	}
+	if ( numthreads > 1 ) {
+		ParallelSort(ops, (Uint8 *)items, (Uint8 *)tmp, n, sign, numthreads);
+	} else {
+		ops->sort(items, tmp, n, sign);
+	}
+	SDL_free(tmp);
+	return(0);
+}
+
+int SDL_SortKeys32(SDL_SortKey32 *items, size_t nitems, Uint32 flags)
+{
+	return(SortKeys(&ops32, items, nitems, flags));
+}
+
+int SDL_SortKeys64(SDL_SortKey64 *items, size_t nitems, Uint32 flags)
+{
+	return(SortKeys(&ops64, items, nitems, flags));
+}
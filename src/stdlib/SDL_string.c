@@ -239,26 +239,343 @@ static size_t SDL_ScanFloat(const char *text, double *valuep)
 }
 #endif
 
+/* Vector versions of the memory routines, used when there is no C library.
+   SSE2 is always there on x86_64; 32-bit Visual C++ builds check for it
+   at run time.  GCC and clang builds also carry 32-byte AVX2 loops, used
+   when SDL_HasAVX2() says the CPU and OS support them.  The memory
+   routines fall back to the plain loops below for short lengths.
+ */
+#if SDL_ASSEMBLY_ROUTINES
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SDL_STRING_SSE2	1
+#define SDL_STRING_VECTOR()	1
+#elif defined(_MSC_VER) && defined(_M_IX86)
+#define SDL_STRING_SSE2	1
+#define SDL_STRING_VECTOR()	SDL_HasSSE2()
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SDL_STRING_NEON	1
+#define SDL_STRING_VECTOR()	1
+#endif
+#if SDL_STRING_SSE2 && (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define SDL_STRING_AVX2	1
+#endif
+#endif /* SDL_ASSEMBLY_ROUTINES */
+
+#if SDL_STRING_SSE2 || SDL_STRING_NEON
+
+#if SDL_STRING_SSE2
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#if SDL_STRING_AVX2
+#include <immintrin.h>
+extern SDL_bool SDL_HasAVX2(void);	/* from SDL_cpuinfo.c */
+#endif
+#include "SDL_cpuinfo.h"
+
+/* Anything shorter than this isn't worth the alignment work */
+#define SDL_VECTOR_MIN		64
+
+/* Fills and copies at least this large bypass the cache with non-temporal
+   stores, since they would only evict everything else from it.
+ */
+#define SDL_STREAM_THRESHOLD	(1024*1024)
+
+/* Below this the wider stores don't make up for the extra call */
+#define SDL_AVX2_MIN		1024
+
+#define SDL_ALIGNED16(p)	((((size_t)(p)) & 15) == 0)
+#define SDL_ALIGNED32(p)	((((size_t)(p)) & 31) == 0)
+
+#ifndef SDL_memset
+#if SDL_STRING_AVX2
+/* Fill len bytes at a 16-byte aligned dstp with 32-byte stores, returning
+   the number of bytes (less than 16) left at the end.
+ */
+__attribute__((target("avx2")))
+static size_t SDL_memset_avx2(Uint8 *dstp, Uint32 val, size_t len)
+{
+    __m256i v = _mm256_set1_epi32((int)val);
+
+    if ( !SDL_ALIGNED32(dstp) && len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp, _mm256_castsi256_si128(v));
+        dstp += 16;
+        len -= 16;
+    }
+    while ( len >= 128 ) {
+        _mm256_store_si256((__m256i *)dstp, v);
+        _mm256_store_si256((__m256i *)(dstp+32), v);
+        _mm256_store_si256((__m256i *)(dstp+64), v);
+        _mm256_store_si256((__m256i *)(dstp+96), v);
+        dstp += 128;
+        len -= 128;
+    }
+    while ( len >= 32 ) {
+        _mm256_store_si256((__m256i *)dstp, v);
+        dstp += 32;
+        len -= 32;
+    }
+    if ( len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp, _mm256_castsi256_si128(v));
+        len -= 16;
+    }
+    return len;
+}
+#endif /* SDL_STRING_AVX2 */
+
+/* Fill len bytes at dst with val in 16-byte stores, returning the number
+   of bytes (less than 16) left at the end.
+ */
+static size_t SDL_memset_vector(Uint8 *dstp, Uint32 val, size_t len)
+{
+#if SDL_STRING_SSE2
+    __m128i v = _mm_set1_epi32((int)val);
+
+    if ( !SDL_ALIGNED16(dstp) ) {
+        while ( len >= 16 ) {
+            _mm_storeu_si128((__m128i *)dstp, v);
+            dstp += 16;
+            len -= 16;
+        }
+        return len;
+    }
+#if SDL_STRING_AVX2
+    /* Large fills stream past the cache, where wider stores don't help */
+    if ( len >= SDL_AVX2_MIN && len < SDL_STREAM_THRESHOLD && SDL_HasAVX2() ) {
+        return SDL_memset_avx2(dstp, val, len);
+    }
+#endif
+    if ( len >= SDL_STREAM_THRESHOLD ) {
+        while ( len >= 64 ) {
+            _mm_stream_si128((__m128i *)dstp, v);
+            _mm_stream_si128((__m128i *)(dstp+16), v);
+            _mm_stream_si128((__m128i *)(dstp+32), v);
+            _mm_stream_si128((__m128i *)(dstp+48), v);
+            dstp += 64;
+            len -= 64;
+        }
+        _mm_sfence();
+    }
+    while ( len >= 64 ) {
+        _mm_store_si128((__m128i *)dstp, v);
+        _mm_store_si128((__m128i *)(dstp+16), v);
+        _mm_store_si128((__m128i *)(dstp+32), v);
+        _mm_store_si128((__m128i *)(dstp+48), v);
+        dstp += 64;
+        len -= 64;
+    }
+    while ( len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp, v);
+        dstp += 16;
+        len -= 16;
+    }
+#else
+    uint8x16_t v = vreinterpretq_u8_u32(vdupq_n_u32(val));
+
+    while ( len >= 64 ) {
+        vst1q_u8(dstp, v);
+        vst1q_u8(dstp+16, v);
+        vst1q_u8(dstp+32, v);
+        vst1q_u8(dstp+48, v);
+        dstp += 64;
+        len -= 64;
+    }
+    while ( len >= 16 ) {
+        vst1q_u8(dstp, v);
+        dstp += 16;
+        len -= 16;
+    }
+#endif
+    return len;
+}
+
+#endif /* !SDL_memset */
+
+#ifndef SDL_memcpy
+#if SDL_STRING_AVX2
+/* Copy len bytes from srcp to a 16-byte aligned dstp in 32-byte blocks,
+   returning the number of bytes (less than 16) left at the end.
+ */
+__attribute__((target("avx2")))
+static size_t SDL_memcpy_avx2(Uint8 *dstp, const Uint8 *srcp, size_t len)
+{
+    __m256i a, b, c, d;
+
+    if ( !SDL_ALIGNED32(dstp) && len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp,
+                        _mm_loadu_si128((const __m128i *)srcp));
+        srcp += 16;
+        dstp += 16;
+        len -= 16;
+    }
+    while ( len >= 128 ) {
+        a = _mm256_loadu_si256((const __m256i *)srcp);
+        b = _mm256_loadu_si256((const __m256i *)(srcp+32));
+        c = _mm256_loadu_si256((const __m256i *)(srcp+64));
+        d = _mm256_loadu_si256((const __m256i *)(srcp+96));
+        _mm256_store_si256((__m256i *)dstp, a);
+        _mm256_store_si256((__m256i *)(dstp+32), b);
+        _mm256_store_si256((__m256i *)(dstp+64), c);
+        _mm256_store_si256((__m256i *)(dstp+96), d);
+        srcp += 128;
+        dstp += 128;
+        len -= 128;
+    }
+    while ( len >= 32 ) {
+        _mm256_store_si256((__m256i *)dstp,
+                           _mm256_loadu_si256((const __m256i *)srcp));
+        srcp += 32;
+        dstp += 32;
+        len -= 32;
+    }
+    if ( len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp,
+                        _mm_loadu_si128((const __m128i *)srcp));
+        len -= 16;
+    }
+    return len;
+}
+#endif /* SDL_STRING_AVX2 */
+
+/* Copy len bytes from srcp to a 16-byte aligned dstp in 16-byte blocks,
+   returning the number of bytes (less than 16) left at the end.
+ */
+static size_t SDL_memcpy_vector(Uint8 *dstp, const Uint8 *srcp, size_t len)
+{
+#if SDL_STRING_SSE2
+    __m128i a, b, c, d;
+
+#if SDL_STRING_AVX2
+    /* Large copies stream past the cache, where wider stores don't help */
+    if ( len >= SDL_AVX2_MIN && len < SDL_STREAM_THRESHOLD && SDL_HasAVX2() ) {
+        return SDL_memcpy_avx2(dstp, srcp, len);
+    }
+#endif
+    if ( len >= SDL_STREAM_THRESHOLD ) {
+        while ( len >= 64 ) {
+            a = _mm_loadu_si128((const __m128i *)srcp);
+            b = _mm_loadu_si128((const __m128i *)(srcp+16));
+            c = _mm_loadu_si128((const __m128i *)(srcp+32));
+            d = _mm_loadu_si128((const __m128i *)(srcp+48));
+            _mm_stream_si128((__m128i *)dstp, a);
+            _mm_stream_si128((__m128i *)(dstp+16), b);
+            _mm_stream_si128((__m128i *)(dstp+32), c);
+            _mm_stream_si128((__m128i *)(dstp+48), d);
+            srcp += 64;
+            dstp += 64;
+            len -= 64;
+        }
+        _mm_sfence();
+    }
+    while ( len >= 64 ) {
+        a = _mm_loadu_si128((const __m128i *)srcp);
+        b = _mm_loadu_si128((const __m128i *)(srcp+16));
+        c = _mm_loadu_si128((const __m128i *)(srcp+32));
+        d = _mm_loadu_si128((const __m128i *)(srcp+48));
+        _mm_store_si128((__m128i *)dstp, a);
+        _mm_store_si128((__m128i *)(dstp+16), b);
+        _mm_store_si128((__m128i *)(dstp+32), c);
+        _mm_store_si128((__m128i *)(dstp+48), d);
+        srcp += 64;
+        dstp += 64;
+        len -= 64;
+    }
+    while ( len >= 16 ) {
+        _mm_store_si128((__m128i *)dstp,
+                        _mm_loadu_si128((const __m128i *)srcp));
+        srcp += 16;
+        dstp += 16;
+        len -= 16;
+    }
+#else
+    uint8x16_t a, b, c, d;
+
+    while ( len >= 64 ) {
+        a = vld1q_u8(srcp);
+        b = vld1q_u8(srcp+16);
+        c = vld1q_u8(srcp+32);
+        d = vld1q_u8(srcp+48);
+        vst1q_u8(dstp, a);
+        vst1q_u8(dstp+16, b);
+        vst1q_u8(dstp+32, c);
+        vst1q_u8(dstp+48, d);
+        srcp += 64;
+        dstp += 64;
+        len -= 64;
+    }
+    while ( len >= 16 ) {
+        vst1q_u8(dstp, vld1q_u8(srcp));
+        srcp += 16;
+        dstp += 16;
+        len -= 16;
+    }
+#endif
+    return len;
+}
+
+#endif /* !SDL_memcpy */
+
+/* Copy len bytes backwards, ending at a 16-byte aligned dstp, in 16-byte
+   blocks.  Each block is loaded before it is stored, so overlapping
+   buffers with dst above src are safe.  Returns the bytes left to copy
+   at the start of the buffers.
+ */
+static size_t SDL_revcpy_vector(Uint8 *dstp, const Uint8 *srcp, size_t len)
+{
+    while ( len >= 16 ) {
+        srcp -= 16;
+        dstp -= 16;
+#if SDL_STRING_SSE2
+        _mm_store_si128((__m128i *)dstp,
+                        _mm_loadu_si128((const __m128i *)srcp));
+#else
+        vst1q_u8(dstp, vld1q_u8(srcp));
+#endif
+        len -= 16;
+    }
+    return len;
+}
+
+#endif /* SDL_STRING_SSE2 || SDL_STRING_NEON */
+
 #ifndef SDL_memset
 void *SDL_memset(void *dst, int c, size_t len)
 {
-    size_t left = (len % 4);
-    if ( len >= 4 ) {
+    size_t left;
+#if SDL_STRING_SSE2 || SDL_STRING_NEON
+    if ( len >= SDL_VECTOR_MIN && SDL_STRING_VECTOR() ) {
+        Uint8 *dstp = (Uint8 *)dst;
+        while ( !SDL_ALIGNED16(dstp) ) {
+            *dstp++ = (Uint8)c;
+            --len;
+        }
+        left = SDL_memset_vector(dstp, 0x01010101 * (Uint8)c, len);
+        dstp += len - left;
+        while ( left-- ) {
+            *dstp++ = (Uint8)c;
+        }
+        return dst;
+    }
+#endif
+    left = (len % 4);
+    len /= 4;
+    if ( len > 0 ) {
         Uint32 value = 0;
         Uint32 *dstp = (Uint32 *)dst;
-        int i;
+        size_t i;
         for (i = 0; i < 4; ++i) {
             value <<= 8;
-            value |= c;
+            value |= (Uint8)c;
         }
-        len /= 4;
-        while ( len-- ) {
-            *dstp++ = value;
+        for (i = 0; i < len; ++i) {
+            dstp[i] = value;
         }
     }
     if ( left > 0 ) {
         Uint8 value = (Uint8)c;
-        Uint8 *dstp = (Uint8 *)dst;
+        Uint8 *dstp = (Uint8 *)dst + (len * 4);
 	switch(left) {
 	case 3:
             *dstp++ = value;
@@ -272,11 +589,47 @@ void *SDL_memset(void *dst, int c, size_t len)
 }
 #endif
 
+#if !defined(HAVE_MEMSET) && !(defined(__GNUC__) && defined(__i386__))
+void SDL_memset4(void *dst, Uint32 val, size_t len)
+{
+    Uint32 *dstp = (Uint32 *)dst;
+#if SDL_STRING_SSE2 || SDL_STRING_NEON
+    if ( len >= SDL_VECTOR_MIN/4 && SDL_STRING_VECTOR() ) {
+        size_t left;
+        /* Only a 4-byte aligned buffer can be brought to 16 bytes */
+        while ( !SDL_ALIGNED16(dstp) && ((((size_t)dstp) & 3) == 0) ) {
+            *dstp++ = val;
+            --len;
+        }
+        left = SDL_memset_vector((Uint8 *)dstp, val, len * 4) / 4;
+        dstp += len - left;
+        len = left;
+    }
+#endif
+    while ( len-- ) {
+        *dstp++ = val;
+    }
+}
+#endif
+
 #ifndef SDL_memcpy
 void *SDL_memcpy(void *dst, const void *src, size_t len)
 {
     char *srcp = (char *)src;
     char *dstp = (char *)dst;
+#if SDL_STRING_SSE2 || SDL_STRING_NEON
+    if ( len >= SDL_VECTOR_MIN && SDL_STRING_VECTOR() ) {
+        size_t left;
+        while ( !SDL_ALIGNED16(dstp) ) {
+            *dstp++ = *srcp++;
+            --len;
+        }
+        left = SDL_memcpy_vector((Uint8 *)dstp, (const Uint8 *)srcp, len);
+        dstp += len - left;
+        srcp += len - left;
+        len = left;
+    }
+#endif
     while ( len-- ) {
         *dstp++ = *srcp++;
     }
@@ -321,6 +674,17 @@ void *SDL_revcpy(void *dst, const void *src, size_t len)
 {
     char *srcp = (char *)src;
     char *dstp = (char *)dst;
+#if SDL_STRING_SSE2 || SDL_STRING_NEON
+    if ( len >= SDL_VECTOR_MIN && SDL_STRING_VECTOR() ) {
+        Uint8 *dend = (Uint8 *)dst + len;
+        const Uint8 *send = (const Uint8 *)src + len;
+        while ( !SDL_ALIGNED16(dend) ) {
+            *--dend = *--send;
+            --len;
+        }
+        len = SDL_revcpy_vector(dend, send, len);
+    }
+#endif
     srcp += len-1;
     dstp += len-1;
     while ( len-- ) {
@@ -0,0 +1,382 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Atomic operations and spinlocks */
+
+#include "SDL_atomic.h"
+#include "SDL_mutex.h"
+#include "SDL_timer.h"
+
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 7))))
+#define HAVE_GCC_ATOMICS	1
+#elif defined(__GNUC__) && (__GNUC__ == 4) && (__GNUC_MINOR__ >= 1)
+#define HAVE_GCC_SYNC		1
+#elif defined(_MSC_VER) && (_MSC_VER >= 1400)
+#define HAVE_MSC_ATOMICS	1
+#include <intrin.h>
+#endif
+
+#if SDL_THREAD_PTHREAD
+#include <sched.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define PAUSE_INSTRUCTION()	__asm__ __volatile__("pause" ::: "memory")
+#elif defined(__GNUC__) && (defined(__aarch64__) || (defined(__ARM_ARCH) && (__ARM_ARCH >= 7)))
+#define PAUSE_INSTRUCTION()	__asm__ __volatile__("yield" ::: "memory")
+#elif HAVE_MSC_ATOMICS && (defined(_M_IX86) || defined(_M_X64))
+#define PAUSE_INSTRUCTION()	_mm_pause()
+#else
+#define PAUSE_INSTRUCTION()
+#endif
+
+/* SDL_AtomicLock() spins this many rounds, doubling the number of pauses
+   each round up to a limit, before it starts yielding the CPU.
+ */
+#define SPIN_ROUNDS		8
+#define SPIN_MAX_PAUSES		64
+
+#if !HAVE_GCC_ATOMICS && !HAVE_GCC_SYNC && !HAVE_MSC_ATOMICS
+/* Without atomic instructions everything goes through one mutex, which
+   is created on first use.  Creating it can set an error, which can need
+   a spinlock, so a failed attempt carries on unlocked rather than recurse.
+ */
+static SDL_mutex *atomic_lock = NULL;
+
+static void SDL_LockAtomics(void)
+{
+	static int creating = 0;
+
+	if ( !atomic_lock && !creating ) {
+		creating = 1;
+		atomic_lock = SDL_CreateMutex();
+		creating = 0;
+	}
+	if ( atomic_lock ) {
+		SDL_mutexP(atomic_lock);
+	}
+}
+
+static void SDL_UnlockAtomics(void)
+{
+	if ( atomic_lock ) {
+		SDL_mutexV(atomic_lock);
+	}
+}
+#endif
+
+SDL_bool SDL_AtomicTryLock(SDL_SpinLock *lock)
+{
+#if HAVE_GCC_ATOMICS
+	return (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) == 0) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_GCC_SYNC
+	return (__sync_lock_test_and_set(lock, 1) == 0) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_MSC_ATOMICS
+	return (_InterlockedExchange((volatile long *)lock, 1) == 0) ? SDL_TRUE : SDL_FALSE;
+#else
+	SDL_bool taken = SDL_FALSE;
+
+	SDL_LockAtomics();
+	if ( *lock == 0 ) {
+		*lock = 1;
+		taken = SDL_TRUE;
+	}
+	SDL_UnlockAtomics();
+	return(taken);
+#endif
+}
+
+void SDL_AtomicLock(SDL_SpinLock *lock)
+{
+	int rounds = 0;
+	int pauses = 1;
+	int i;
+
+	while ( !SDL_AtomicTryLock(lock) ) {
+		/* Wait until it looks free, so waiters only read the lock */
+		while ( *(volatile SDL_SpinLock *)lock ) {
+			if ( rounds < SPIN_ROUNDS ) {
+				for ( i = 0; i < pauses; ++i ) {
+					PAUSE_INSTRUCTION();
+				}
+				if ( pauses < SPIN_MAX_PAUSES ) {
+					pauses *= 2;
+				}
+				++rounds;
+			} else {
+				SDL_ThreadYield();
+			}
+		}
+	}
+}
+
+void SDL_AtomicUnlock(SDL_SpinLock *lock)
+{
+#if HAVE_GCC_ATOMICS
+	__atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+#elif HAVE_GCC_SYNC
+	__sync_lock_release(lock);
+#elif HAVE_MSC_ATOMICS
+	_InterlockedExchange((volatile long *)lock, 0);
+#else
+	SDL_LockAtomics();
+	*lock = 0;
+	SDL_UnlockAtomics();
+#endif
+}
+
+void SDL_CPUPause(void)
+{
+	PAUSE_INSTRUCTION();
+}
+
+void SDL_ThreadYield(void)
+{
+#if SDL_THREAD_PTHREAD
+	sched_yield();
+#else
+	SDL_Delay(0);
+#endif
+}
+
+SDL_bool SDL_AtomicCAS(SDL_atomic_t *a, int oldval, int newval)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_compare_exchange_n(&a->value, &oldval, newval, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_GCC_SYNC
+	return __sync_bool_compare_and_swap(&a->value, oldval, newval) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_MSC_ATOMICS
+	return (_InterlockedCompareExchange((volatile long *)&a->value,
+			newval, oldval) == oldval) ? SDL_TRUE : SDL_FALSE;
+#else
+	SDL_bool swapped = SDL_FALSE;
+
+	SDL_LockAtomics();
+	if ( a->value == oldval ) {
+		a->value = newval;
+		swapped = SDL_TRUE;
+	}
+	SDL_UnlockAtomics();
+	return(swapped);
+#endif
+}
+
+int SDL_AtomicSet(SDL_atomic_t *a, int value)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_exchange_n(&a->value, value, __ATOMIC_SEQ_CST);
+#elif HAVE_GCC_SYNC
+	/* The exchange is only an acquire barrier */
+	__sync_synchronize();
+	return __sync_lock_test_and_set(&a->value, value);
+#elif HAVE_MSC_ATOMICS
+	return _InterlockedExchange((volatile long *)&a->value, value);
+#else
+	int oldval;
+
+	SDL_LockAtomics();
+	oldval = a->value;
+	a->value = value;
+	SDL_UnlockAtomics();
+	return(oldval);
+#endif
+}
+
+int SDL_AtomicAdd(SDL_atomic_t *a, int value)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_fetch_add(&a->value, value, __ATOMIC_SEQ_CST);
+#elif HAVE_GCC_SYNC
+	return __sync_fetch_and_add(&a->value, value);
+#elif HAVE_MSC_ATOMICS
+	return _InterlockedExchangeAdd((volatile long *)&a->value, value);
+#else
+	int oldval;
+
+	SDL_LockAtomics();
+	oldval = a->value;
+	a->value += value;
+	SDL_UnlockAtomics();
+	return(oldval);
+#endif
+}
+
+int SDL_AtomicLoad(SDL_atomic_t *a, SDL_MemoryOrder order)
+{
+#if HAVE_GCC_ATOMICS
+	switch (order) {
+	    case SDL_MEMORY_ORDER_ACQUIRE:
+		return __atomic_load_n(&a->value, __ATOMIC_ACQUIRE);
+	    case SDL_MEMORY_ORDER_SEQ_CST:
+		return __atomic_load_n(&a->value, __ATOMIC_SEQ_CST);
+	    default:
+		return __atomic_load_n(&a->value, __ATOMIC_RELAXED);
+	}
+#elif HAVE_GCC_SYNC
+	int value;
+
+	if ( order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		__sync_synchronize();
+	}
+	value = a->value;
+	if ( order == SDL_MEMORY_ORDER_ACQUIRE || order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		__sync_synchronize();
+	}
+	return(value);
+#elif HAVE_MSC_ATOMICS
+	if ( order == SDL_MEMORY_ORDER_ACQUIRE || order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		return _InterlockedCompareExchange((volatile long *)&a->value, 0, 0);
+	}
+	return(a->value);
+#else
+	int value;
+
+	SDL_LockAtomics();
+	value = a->value;
+	SDL_UnlockAtomics();
+	return(value);
+#endif
+}
+
+void SDL_AtomicStore(SDL_atomic_t *a, int value, SDL_MemoryOrder order)
+{
+#if HAVE_GCC_ATOMICS
+	switch (order) {
+	    case SDL_MEMORY_ORDER_RELEASE:
+		__atomic_store_n(&a->value, value, __ATOMIC_RELEASE);
+		break;
+	    case SDL_MEMORY_ORDER_SEQ_CST:
+		__atomic_store_n(&a->value, value, __ATOMIC_SEQ_CST);
+		break;
+	    default:
+		__atomic_store_n(&a->value, value, __ATOMIC_RELAXED);
+		break;
+	}
+#elif HAVE_GCC_SYNC
+	if ( order == SDL_MEMORY_ORDER_RELEASE || order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		__sync_synchronize();
+	}
+	a->value = value;
+	if ( order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		__sync_synchronize();
+	}
+#elif HAVE_MSC_ATOMICS
+	if ( order == SDL_MEMORY_ORDER_RELEASE || order == SDL_MEMORY_ORDER_SEQ_CST ) {
+		_InterlockedExchange((volatile long *)&a->value, value);
+	} else {
+		a->value = value;
+	}
+#else
+	SDL_LockAtomics();
+	a->value = value;
+	SDL_UnlockAtomics();
+#endif
+}
+
+SDL_bool SDL_AtomicCASPtr(void **a, void *oldval, void *newval)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_compare_exchange_n(a, &oldval, newval, 0,
+			__ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_GCC_SYNC
+	return __sync_bool_compare_and_swap(a, oldval, newval) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_MSC_ATOMICS && defined(_WIN64)
+	return (_InterlockedCompareExchangePointer(a, newval, oldval) == oldval) ? SDL_TRUE : SDL_FALSE;
+#elif HAVE_MSC_ATOMICS
+	return (_InterlockedCompareExchange((volatile long *)a, (long)newval,
+			(long)oldval) == (long)oldval) ? SDL_TRUE : SDL_FALSE;
+#else
+	SDL_bool swapped = SDL_FALSE;
+
+	SDL_LockAtomics();
+	if ( *a == oldval ) {
+		*a = newval;
+		swapped = SDL_TRUE;
+	}
+	SDL_UnlockAtomics();
+	return(swapped);
+#endif
+}
+
+void *SDL_AtomicSetPtr(void **a, void *value)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_exchange_n(a, value, __ATOMIC_SEQ_CST);
+#elif HAVE_GCC_SYNC
+	__sync_synchronize();
+	return __sync_lock_test_and_set(a, value);
+#elif HAVE_MSC_ATOMICS && defined(_WIN64)
+	return _InterlockedExchangePointer(a, value);
+#elif HAVE_MSC_ATOMICS
+	return (void *)_InterlockedExchange((volatile long *)a, (long)value);
+#else
+	void *oldval;
+
+	SDL_LockAtomics();
+	oldval = *a;
+	*a = value;
+	SDL_UnlockAtomics();
+	return(oldval);
+#endif
+}
+
+void *SDL_AtomicGetPtr(void **a)
+{
+#if HAVE_GCC_ATOMICS
+	return __atomic_load_n(a, __ATOMIC_SEQ_CST);
+#elif HAVE_GCC_SYNC
+	void *value;
+
+	__sync_synchronize();
+	value = *(void * volatile *)a;
+	__sync_synchronize();
+	return(value);
+#elif HAVE_MSC_ATOMICS && defined(_WIN64)
+	return _InterlockedCompareExchangePointer(a, NULL, NULL);
+#elif HAVE_MSC_ATOMICS
+	return (void *)_InterlockedCompareExchange((volatile long *)a, 0, 0);
+#else
+	void *value;
+
+	SDL_LockAtomics();
+	value = *a;
+	SDL_UnlockAtomics();
+	return(value);
+#endif
+}
+
+void SDL_MemoryBarrier(void)
+{
+#if HAVE_GCC_ATOMICS
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif HAVE_GCC_SYNC
+	__sync_synchronize();
+#elif HAVE_MSC_ATOMICS
+	long barrier = 0;
+	_InterlockedExchange(&barrier, 1);
+#else
+	SDL_LockAtomics();
+	SDL_UnlockAtomics();
+#endif
+}
@@ -0,0 +1,617 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* A work-stealing pool of worker threads */
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_job.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+
+#define JOB_MAX_THREADS		64
+
+/* An idle worker checks for work this many times before going to sleep */
+#define JOB_IDLE_ROUNDS		32
+
+/* Queues start with room for this many jobs and double as needed */
+#define JOB_QUEUE_SIZE		64
+
+typedef struct SDL_Job {
+	SDL_JobFunction func;
+	void *data;
+	SDL_JobCounter *counter;
+	struct SDL_Job *next;
+} SDL_Job;
+
+/* The jobs on the waiting list are queued when pending drops to 0.
+   Finishing a job decrements pending with the lock held, so taking the
+   lock once pending is 0 means nothing is still using the counter.
+   Threads sleeping in SDL_WaitJobs() are woken through 'done', which
+   the first of them creates.
+ */
+struct SDL_JobCounter {
+	SDL_atomic_t pending;
+	SDL_SpinLock lock;
+	SDL_Job *waiting;
+	SDL_sem *done;
+	int sleepers;
+};
+
+/* A double-ended queue in a ring buffer.  The owner pushes and pops at the
+   tail, so it works on its most recent (and cache-warm) jobs, while
+   thieves take the oldest jobs from the head.
+ */
+typedef struct SDL_JobQueue {
+	SDL_SpinLock lock;
+	SDL_Job **jobs;
+	int size;
+	volatile int head;
+	volatile int tail;
+} SDL_JobQueue;
+
+typedef struct SDL_JobWorker {
+	SDL_JobQueue queue;
+	SDL_Thread *thread;
+	Uint32 seed;
+} SDL_JobWorker;
+
+static SDL_SpinLock pool_lock = 0;
+static SDL_atomic_t pool_running;
+static SDL_atomic_t pool_quitting;
+static SDL_JobWorker *workers = NULL;
+static int numworkers = 0;
+static SDL_JobQueue shared_queue;
+static SDL_sem *wakeup = NULL;
+static SDL_atomic_t sleepers;
+static SDL_TLSID worker_id = 0;
+
+static SDL_SpinLock free_lock = 0;
+static SDL_Job *free_jobs = NULL;
+
+
+static int SDL_PushJob(SDL_JobQueue *queue, SDL_Job *job)
+{
+	SDL_AtomicLock(&queue->lock);
+	if ( (queue->tail - queue->head) == queue->size ) {
+		SDL_Job **jobs;
+		int i, size;
+
+		size = queue->size ? queue->size * 2 : JOB_QUEUE_SIZE;
+		jobs = (SDL_Job **)SDL_malloc(size * sizeof(*jobs));
+		if ( jobs == NULL ) {
+			SDL_AtomicUnlock(&queue->lock);
+			return(-1);
+		}
+		for ( i = 0; i < queue->size; ++i ) {
+			jobs[i] = queue->jobs[(queue->head + i) & (queue->size - 1)];
+		}
+		SDL_free(queue->jobs);
+		queue->jobs = jobs;
+		queue->head = 0;
+		queue->tail = queue->size;
+		queue->size = size;
+	}
+	queue->jobs[queue->tail & (queue->size - 1)] = job;
+	++queue->tail;
+	SDL_AtomicUnlock(&queue->lock);
+	return(0);
+}
+
+/* Take the newest job, for the queue's owner */
+static SDL_Job *SDL_PopJob(SDL_JobQueue *queue)
+{
+	SDL_Job *job = NULL;
+
+	if ( queue->head == queue->tail ) {
+		return(NULL);
+	}
+	SDL_AtomicLock(&queue->lock);
+	if ( queue->head != queue->tail ) {
+		--queue->tail;
+		job = queue->jobs[queue->tail & (queue->size - 1)];
+	}
+	SDL_AtomicUnlock(&queue->lock);
+	return(job);
+}
+
+/* Take the oldest job, for other threads */
+static SDL_Job *SDL_StealJob(SDL_JobQueue *queue)
+{
+	SDL_Job *job = NULL;
+
+	if ( queue->head == queue->tail ) {
+		return(NULL);
+	}
+	SDL_AtomicLock(&queue->lock);
+	if ( queue->head != queue->tail ) {
+		job = queue->jobs[queue->head & (queue->size - 1)];
+		++queue->head;
+	}
+	SDL_AtomicUnlock(&queue->lock);
+	return(job);
+}
+
+static SDL_Job *SDL_AllocJob(void)
+{
+	SDL_Job *job;
+
+	SDL_AtomicLock(&free_lock);
+	job = free_jobs;
+	if ( job ) {
+		free_jobs = job->next;
+	}
+	SDL_AtomicUnlock(&free_lock);
+	if ( job == NULL ) {
+		job = (SDL_Job *)SDL_malloc(sizeof(*job));
+	}
+	return(job);
+}
+
+static void SDL_FreeJob(SDL_Job *job)
+{
+	SDL_AtomicLock(&free_lock);
+	job->next = free_jobs;
+	free_jobs = job;
+	SDL_AtomicUnlock(&free_lock);
+}
+
+/* Find a job for a worker, or for another thread if self is NULL */
+static SDL_Job *SDL_FindJob(SDL_JobWorker *self)
+{
+	SDL_Job *job = NULL;
+	int i, victim;
+
+	if ( self ) {
+		job = SDL_PopJob(&self->queue);
+	}
+	if ( job == NULL ) {
+		job = SDL_StealJob(&shared_queue);
+	}
+	if ( (job == NULL) && (numworkers > 0) ) {
+		/* Start at a different worker each time to spread the thefts */
+		if ( self ) {
+			self->seed = self->seed * 1103515245 + 12345;
+			victim = (int)((self->seed >> 16) % numworkers);
+		} else {
+			victim = (int)(SDL_ThreadID() % numworkers);
+		}
+		for ( i = 0; (job == NULL) && (i < numworkers); ++i ) {
+			if ( &workers[victim] != self ) {
+				job = SDL_StealJob(&workers[victim].queue);
+			}
+			victim = (victim + 1) % numworkers;
+		}
+	}
+	return(job);
+}
+
+static void SDL_QueueJob(SDL_Job *job);
+
+static void SDL_RunJob(SDL_Job *job)
+{
+	SDL_JobCounter *counter = job->counter;
+	SDL_Job *waiting = NULL, *next;
+
+	job->func(job->data);
+	SDL_FreeJob(job);
+
+	if ( counter ) {
+		SDL_AtomicLock(&counter->lock);
+		if ( SDL_AtomicDecRef(&counter->pending) ) {
+			waiting = counter->waiting;
+			counter->waiting = NULL;
+			/* Post with the lock held, the counter may be freed
+			   as soon as it's released */
+			for ( ; counter->sleepers > 0; --counter->sleepers ) {
+				SDL_SemPost(counter->done);
+			}
+		}
+		SDL_AtomicUnlock(&counter->lock);
+
+		/* Release the jobs that were waiting for this group */
+		while ( waiting ) {
+			next = waiting->next;
+			SDL_QueueJob(waiting);
+			waiting = next;
+		}
+	}
+}
+
+static void SDL_QueueJob(SDL_Job *job)
+{
+	SDL_JobWorker *self;
+	int asleep;
+
+	if ( numworkers == 0 ) {
+		SDL_RunJob(job);
+		return;
+	}
+	self = (SDL_JobWorker *)SDL_TLSGet(worker_id);
+	if ( SDL_PushJob(self ? &self->queue : &shared_queue, job) < 0 ) {
+		SDL_RunJob(job);
+		return;
+	}
+
+	/* Wake a worker, unless enough wakeups are already on the way */
+	asleep = SDL_AtomicGet(&sleepers);
+	if ( (asleep > 0) && (SDL_SemValue(wakeup) < (Uint32)asleep) ) {
+		SDL_SemPost(wakeup);
+	}
+}
+
+static int SDLCALL SDL_JobThread(void *data)
+{
+	SDL_JobWorker *self = (SDL_JobWorker *)data;
+	SDL_Job *job;
+	int idle = 0;
+
+	SDL_TLSSet(worker_id, self, NULL);
+	for ( ; ; ) {
+		job = SDL_FindJob(self);
+		if ( job ) {
+			SDL_RunJob(job);
+			idle = 0;
+			continue;
+		}
+		if ( SDL_AtomicGet(&pool_quitting) ) {
+			break;
+		}
+		if ( ++idle < JOB_IDLE_ROUNDS ) {
+			SDL_ThreadYield();
+			continue;
+		}
+
+		/* Check once more after saying we're asleep, so a job added in
+		   the meantime either gets seen here or posts a wakeup.
+		 */
+		SDL_AtomicIncRef(&sleepers);
+		job = SDL_FindJob(self);
+		if ( (job == NULL) && !SDL_AtomicGet(&pool_quitting) ) {
+			SDL_SemWait(wakeup);
+		}
+		SDL_AtomicAdd(&sleepers, -1);
+		if ( job ) {
+			SDL_RunJob(job);
+		}
+		idle = 0;
+	}
+	return(0);
+}
+
+static int SDL_DefaultJobThreads(void)
+{
+	const char *env;
+	int numthreads;
+
+	env = SDL_getenv("SDL_JOB_THREADS");
+	if ( env ) {
+		numthreads = SDL_atoi(env);
+	} else {
+		/* The thread waiting on the jobs helps run them */
+		numthreads = SDL_GetCPUCount() - 1;
+	}
+	if ( numthreads < 0 ) {
+		numthreads = 0;
+	}
+	if ( numthreads > JOB_MAX_THREADS ) {
+		numthreads = JOB_MAX_THREADS;
+	}
+	return(numthreads);
+}
+
+/* Start the pool with this many threads, or the default if negative */
+static int SDL_StartJobs(int numthreads)
+{
+	SDL_ThreadAttr attr;
+	int i, retval = 0;
+
+	if ( SDL_AtomicLoad(&pool_running, SDL_MEMORY_ORDER_ACQUIRE) ) {
+		if ( (numthreads >= 0) && (numthreads != numworkers) ) {
+			SDL_SetError("The job threads are already running");
+			return(-1);
+		}
+		return(0);
+	}
+
+	SDL_AtomicLock(&pool_lock);
+	if ( SDL_AtomicGet(&pool_running) ) {
+		SDL_AtomicUnlock(&pool_lock);
+		return SDL_StartJobs(numthreads);
+	}
+	if ( numthreads < 0 ) {
+		numthreads = SDL_DefaultJobThreads();
+	}
+	if ( worker_id == 0 ) {
+		worker_id = SDL_TLSCreate();
+	}
+	SDL_memset(&shared_queue, 0, sizeof(shared_queue));
+	SDL_AtomicSet(&pool_quitting, 0);
+	SDL_AtomicSet(&sleepers, 0);
+	numworkers = 0;
+	if ( numthreads > 0 ) {
+		wakeup = SDL_CreateSemaphore(0);
+		workers = (SDL_JobWorker *)SDL_calloc(numthreads, sizeof(*workers));
+		if ( !wakeup || !workers ) {
+			SDL_OutOfMemory();
+			retval = -1;
+			numthreads = 0;
+		}
+	}
+	SDL_memset(&attr, 0, sizeof(attr));
+	attr.name = "SDLJob";
+	for ( i = 0; i < numthreads; ++i ) {
+		workers[i].seed = (Uint32)i + 1;
+#if (defined(__WIN32__) && !defined(_WIN32_WCE)) && !defined(HAVE_LIBC) && !defined(__SYMBIAN32__)
+#undef SDL_CreateThreadWithAttr
+		workers[i].thread = SDL_CreateThreadWithAttr(SDL_JobThread, &workers[i], &attr, NULL, NULL);
+#else
+		workers[i].thread = SDL_CreateThreadWithAttr(SDL_JobThread, &workers[i], &attr);
+#endif
+		if ( workers[i].thread == NULL ) {
+			retval = -1;
+			break;
+		}
+		/* Workers read numworkers, so only count those already running */
+		numworkers = i + 1;
+	}
+	SDL_AtomicStore(&pool_running, 1, SDL_MEMORY_ORDER_RELEASE);
+	SDL_AtomicUnlock(&pool_lock);
+	return(retval);
+}
+
+int SDL_InitJobs(int numthreads)
+{
+	if ( numthreads <= 0 ) {
+		numthreads = -1;
+	}
+	return SDL_StartJobs(numthreads);
+}
+
+void SDL_QuitJobs(void)
+{
+	SDL_Job *job;
+	int i;
+
+	SDL_AtomicLock(&pool_lock);
+	if ( !SDL_AtomicGet(&pool_running) ) {
+		SDL_AtomicUnlock(&pool_lock);
+		return;
+	}
+
+	/* The workers drain the queues before they notice this */
+	SDL_AtomicSet(&pool_quitting, 1);
+	for ( i = 0; i < numworkers; ++i ) {
+		SDL_SemPost(wakeup);
+	}
+	for ( i = 0; i < numworkers; ++i ) {
+		SDL_WaitThread(workers[i].thread, NULL);
+	}
+	while ( (job = SDL_StealJob(&shared_queue)) != NULL ) {
+		SDL_RunJob(job);
+	}
+	for ( i = 0; i < numworkers; ++i ) {
+		SDL_free(workers[i].queue.jobs);
+	}
+	SDL_free(shared_queue.jobs);
+	SDL_free(workers);
+	workers = NULL;
+	numworkers = 0;
+	if ( wakeup ) {
+		SDL_DestroySemaphore(wakeup);
+		wakeup = NULL;
+	}
+	while ( free_jobs ) {
+		job = free_jobs;
+		free_jobs = job->next;
+		SDL_free(job);
+	}
+	SDL_AtomicSet(&pool_running, 0);
+	SDL_AtomicUnlock(&pool_lock);
+}
+
+int SDL_GetJobThreadCount(void)
+{
+	SDL_StartJobs(-1);
+	return(numworkers);
+}
+
+SDL_JobCounter *SDL_CreateJobCounter(void)
+{
+	SDL_JobCounter *counter;
+
+	counter = (SDL_JobCounter *)SDL_calloc(1, sizeof(*counter));
+	if ( counter == NULL ) {
+		SDL_OutOfMemory();
+	}
+	return(counter);
+}
+
+void SDL_DestroyJobCounter(SDL_JobCounter *counter)
+{
+	if ( counter ) {
+		/* Wait for the last job to finish with it */
+		SDL_AtomicLock(&counter->lock);
+		SDL_AtomicUnlock(&counter->lock);
+		if ( counter->done ) {
+			SDL_DestroySemaphore(counter->done);
+		}
+		SDL_free(counter);
+	}
+}
+
+int SDL_AddJob(SDL_JobFunction func, void *data, SDL_JobCounter *counter, SDL_JobCounter *after)
+{
+	SDL_Job *job;
+
+	SDL_StartJobs(-1);
+	job = SDL_AllocJob();
+	if ( job == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	job->func = func;
+	job->data = data;
+	job->counter = counter;
+	job->next = NULL;
+	if ( counter ) {
+		SDL_AtomicIncRef(&counter->pending);
+	}
+	if ( after ) {
+		SDL_AtomicLock(&after->lock);
+		if ( SDL_AtomicGet(&after->pending) > 0 ) {
+			job->next = after->waiting;
+			after->waiting = job;
+			job = NULL;
+		}
+		SDL_AtomicUnlock(&after->lock);
+	}
+	if ( job ) {
+		SDL_QueueJob(job);
+	}
+	return(0);
+}
+
+/* Sleep until the counter's last job finishes, or return right away if
+   it already has */
+static void SDL_SleepOnCounter(SDL_JobCounter *counter)
+{
+	SDL_sem *unused = NULL;
+	int sleep = 0;
+
+	SDL_AtomicLock(&counter->lock);
+	if ( counter->done == NULL ) {
+		SDL_AtomicUnlock(&counter->lock);
+		unused = SDL_CreateSemaphore(0);
+		if ( unused == NULL ) {
+			SDL_ThreadYield();
+			return;
+		}
+		SDL_AtomicLock(&counter->lock);
+		if ( counter->done == NULL ) {
+			counter->done = unused;
+			unused = NULL;
+		}
+	}
+	if ( SDL_AtomicGet(&counter->pending) > 0 ) {
+		++counter->sleepers;
+		sleep = 1;
+	}
+	SDL_AtomicUnlock(&counter->lock);
+
+	if ( unused ) {
+		/* Another thread made one first */
+		SDL_DestroySemaphore(unused);
+	}
+	if ( sleep ) {
+		SDL_SemWait(counter->done);
+	}
+}
+
+void SDL_WaitJobs(SDL_JobCounter *counter)
+{
+	SDL_JobWorker *self;
+	SDL_Job *job;
+	int idle = 0;
+
+	self = (SDL_JobWorker *)SDL_TLSGet(worker_id);
+	while ( SDL_AtomicGet(&counter->pending) > 0 ) {
+		job = SDL_FindJob(self);
+		if ( job ) {
+			SDL_RunJob(job);
+			idle = 0;
+		} else if ( ++idle < JOB_IDLE_ROUNDS ) {
+			SDL_CPUPause();
+		} else if ( self ) {
+			/* Workers keep looking, if they all slept here there
+			   might be nobody left to run the jobs they wait for */
+			SDL_ThreadYield();
+		} else {
+			SDL_SleepOnCounter(counter);
+			idle = 0;
+		}
+	}
+	/* Wait for the last job to finish with the counter */
+	SDL_AtomicLock(&counter->lock);
+	SDL_AtomicUnlock(&counter->lock);
+}
+
+typedef struct SDL_JobRange {
+	SDL_JobRangeFunction func;
+	void *data;
+	int start;
+	int end;
+} SDL_JobRange;
+
+static void SDLCALL SDL_RunJobRange(void *data)
+{
+	SDL_JobRange *range = (SDL_JobRange *)data;
+
+	range->func(range->data, range->start, range->end);
+}
+
+void SDL_ParallelFor(int start, int end, int grain, SDL_JobRangeFunction func, void *data)
+{
+	SDL_JobCounter counter;
+	SDL_JobRange *ranges;
+	int i, numranges;
+
+	if ( end <= start ) {
+		return;
+	}
+	SDL_StartJobs(-1);
+	if ( grain <= 0 ) {
+		grain = (end - start) / ((numworkers + 1) * 4);
+		if ( grain < 1 ) {
+			grain = 1;
+		}
+	}
+	numranges = (end - start + grain - 1) / grain;
+	if ( (numworkers == 0) || (numranges == 1) ) {
+		func(data, start, end);
+		return;
+	}
+	ranges = (SDL_JobRange *)SDL_malloc(numranges * sizeof(*ranges));
+	if ( ranges == NULL ) {
+		func(data, start, end);
+		return;
+	}
+
+	/* Queue all but the first range, which this thread runs itself */
+	SDL_memset(&counter, 0, sizeof(counter));
+	for ( i = 0; i < numranges; ++i ) {
+		ranges[i].func = func;
+		ranges[i].data = data;
+		ranges[i].start = start + i * grain;
+		ranges[i].end = (i == numranges - 1) ? end : ranges[i].start + grain;
+		if ( (i > 0) && (SDL_AddJob(SDL_RunJobRange, &ranges[i], &counter, NULL) < 0) ) {
+			SDL_RunJobRange(&ranges[i]);
+		}
+	}
+	SDL_RunJobRange(&ranges[0]);
+	SDL_WaitJobs(&counter);
+	if ( counter.done ) {
+		SDL_DestroySemaphore(counter.done);
+	}
+	SDL_free(ranges);
+}
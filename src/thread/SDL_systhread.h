@@ -27,10 +27,11 @@
 #define _SDL_systhread_h
 
 #include "SDL_thread.h"
+#include "SDL_thread_c.h"
 
 /* This function creates a thread, passing args to SDL_RunThread(),
    saves a system-dependent thread id in thread->id, and returns 0
-   on success.
+   on success.  It should use thread->stacksize if it isn't 0.
 */
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
 extern int SDL_SYS_CreateThread(SDL_Thread *thread, void *args, pfnSDL_CurrentBeginThread pfnBeginThread, pfnSDL_CurrentEndThread pfnEndThread);
@@ -38,8 +39,10 @@ extern int SDL_SYS_CreateThread(SDL_Thread *thread, void *args, pfnSDL_CurrentBe
 extern int SDL_SYS_CreateThread(SDL_Thread *thread, void *args);
 #endif
 
-/* This function does any necessary setup in the child thread */
-extern void SDL_SYS_SetupThread(void);
+/* This function does any necessary setup in the child thread, including
+   applying whichever of thread->name, priority and affinity it can.
+ */
+extern void SDL_SYS_SetupThread(SDL_Thread *thread);
 
 /* This function waits for the thread to finish and frees any data
    allocated by SDL_SYS_CreateThread()
@@ -49,4 +52,11 @@ extern void SDL_SYS_WaitThread(SDL_Thread *thread);
 /* This function kills the thread and returns */
 extern void SDL_SYS_KillThread(SDL_Thread *thread);
 
+/* These functions get and set the calling thread's data block, which is
+   NULL until it is set.  Systems without thread local storage can pass
+   these through to SDL_Generic_GetTLSData() and SDL_Generic_SetTLSData().
+ */
+extern SDL_TLSData *SDL_SYS_GetTLSData(void);
+extern int SDL_SYS_SetTLSData(SDL_TLSData *data);
+
 #endif /* _SDL_systhread_h */
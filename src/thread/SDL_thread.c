@@ -23,148 +23,331 @@
 
 /* System independent thread management routines for SDL */
 
+#include "SDL_atomic.h"
 #include "SDL_mutex.h"
 #include "SDL_thread.h"
+#include "SDL_timer.h"
 #include "SDL_thread_c.h"
 #include "SDL_systhread.h"
 
-#define ARRAY_CHUNKSIZE	32
-/* The array of threads currently active in the application
-   (except the main thread)
-   The manipulation of an array here is safer than using a linked list.
-*/
-static int SDL_maxthreads = 0;
+/* The threads SDL created and hasn't waited for yet, except the main
+   thread, hashed by thread ID.  Threads add themselves as they start, so
+   the ID is known.  The lock is a spinlock because it needs no setup, so
+   there's no race when the first threads start at the same time.
+ */
+#define THREAD_HASH_BITS	6
+#define THREAD_HASH_SIZE	(1 << THREAD_HASH_BITS)
+#define THREAD_HASH(id)		((((Uint32)(id)) * 0x9E3779B1) >> (32 - THREAD_HASH_BITS))
+
+static SDL_Thread *SDL_Threads[THREAD_HASH_SIZE];
+static SDL_SpinLock SDL_threads_lock = 0;
 static int SDL_numthreads = 0;
-static SDL_Thread **SDL_Threads = NULL;
-static SDL_mutex *thread_lock = NULL;
 
-int SDL_ThreadsInit(void)
+/* Statistics for SDL_GetThreadStats() */
+static Uint32 SDL_threads_created = 0;
+static Uint32 SDL_threads_exited = 0;
+static Uint64 SDL_threads_lifetime = 0;
+static Uint32 SDL_threads_longest = 0;
+static Uint32 SDL_rate_start = 0;
+static Uint32 SDL_rate_count = 0;
+static Uint32 SDL_rate_last = 0;
+
+/* Start a new one second window for the creation rate if it's time */
+static void SDL_UpdateThreadRate(Uint32 now)
 {
-	int retval;
+	Uint32 elapsed = now - SDL_rate_start;
 
-	retval = 0;
-	thread_lock = SDL_CreateMutex();
-	if ( thread_lock == NULL ) {
-		retval = -1;
+	if ( elapsed >= 1000 ) {
+		SDL_rate_last = (elapsed < 2000) ? SDL_rate_count : 0;
+		SDL_rate_start = now;
+		SDL_rate_count = 0;
 	}
-	return(retval);
 }
 
-/* This should never be called...
-   If this is called by SDL_Quit(), we don't know whether or not we should
-   clean up threads here.  If any threads are still running after this call,
-   they will no longer have access to any per-thread data.
- */
-void SDL_ThreadsQuit(void)
+/* Routines for manipulating the thread table */
+static void SDL_AddThread(SDL_Thread *thread)
 {
-	SDL_mutex *mutex;
+	SDL_Thread **bucket = &SDL_Threads[THREAD_HASH(thread->threadid)];
 
-	mutex = thread_lock;
-	thread_lock = NULL;
-	if ( mutex != NULL ) {
-		SDL_DestroyMutex(mutex);
+	SDL_AtomicLock(&SDL_threads_lock);
+	thread->prev = NULL;
+	thread->next = *bucket;
+	if ( *bucket ) {
+		(*bucket)->prev = thread;
 	}
+	*bucket = thread;
+	++SDL_numthreads;
+	++SDL_threads_created;
+	SDL_UpdateThreadRate(thread->started);
+	++SDL_rate_count;
+#ifdef DEBUG_THREADS
+	printf("Adding thread (%d now)\n", SDL_numthreads);
+#endif
+	SDL_AtomicUnlock(&SDL_threads_lock);
 }
 
-/* Routines for manipulating the thread list */
-static void SDL_AddThread(SDL_Thread *thread)
+static void SDL_DelThread(SDL_Thread *thread)
 {
-	/* WARNING:
-	   If the very first threads are created simultaneously, then
-	   there could be a race condition causing memory corruption.
-	   In practice, this isn't a problem because by definition there
-	   is only one thread running the first time this is called.
-	*/
-	if ( !thread_lock ) {
-		if ( SDL_ThreadsInit() < 0 ) {
-			return;
-		}
-	}
-	SDL_mutexP(thread_lock);
+	SDL_Thread **bucket = &SDL_Threads[THREAD_HASH(thread->threadid)];
 
-	/* Expand the list of threads, if necessary */
+	SDL_AtomicLock(&SDL_threads_lock);
+	if ( thread->prev || (*bucket == thread) ) {
+		if ( thread->prev ) {
+			thread->prev->next = thread->next;
+		} else {
+			*bucket = thread->next;
+		}
+		if ( thread->next ) {
+			thread->next->prev = thread->prev;
+		}
+		thread->prev = NULL;
+		thread->next = NULL;
+		--SDL_numthreads;
 #ifdef DEBUG_THREADS
-	printf("Adding thread (%d already - %d max)\n",
-			SDL_numthreads, SDL_maxthreads);
+		printf("Deleting thread (%d left)\n", SDL_numthreads);
 #endif
-	if ( SDL_numthreads == SDL_maxthreads ) {
-		SDL_Thread **threads;
-		threads = (SDL_Thread **)SDL_realloc(SDL_Threads,
-			(SDL_maxthreads+ARRAY_CHUNKSIZE)*(sizeof *threads));
-		if ( threads == NULL ) {
-			SDL_OutOfMemory();
-			goto done;
+	}
+	SDL_AtomicUnlock(&SDL_threads_lock);
+}
+
+/* Note how long a thread's function ran */
+static void SDL_ExitThread(SDL_Thread *thread)
+{
+	Uint32 lifetime = SDL_GetTicks() - thread->started;
+
+	SDL_AtomicLock(&SDL_threads_lock);
+	++SDL_threads_exited;
+	SDL_threads_lifetime += lifetime;
+	if ( lifetime > SDL_threads_longest ) {
+		SDL_threads_longest = lifetime;
+	}
+	SDL_AtomicUnlock(&SDL_threads_lock);
+}
+
+int SDL_GetThreadStats(SDL_ThreadStats *stats)
+{
+	Uint32 now = SDL_GetTicks();
+
+	SDL_AtomicLock(&SDL_threads_lock);
+	SDL_UpdateThreadRate(now);
+	stats->active = SDL_numthreads;
+	stats->created = SDL_threads_created;
+	stats->exited = SDL_threads_exited;
+	stats->created_last_second = SDL_rate_last;
+	stats->average_lifetime = 0;
+	if ( SDL_threads_exited ) {
+		stats->average_lifetime = (Uint32)(SDL_threads_lifetime / SDL_threads_exited);
+	}
+	stats->longest_lifetime = SDL_threads_longest;
+	SDL_AtomicUnlock(&SDL_threads_lock);
+	return(0);
+}
+
+int SDL_GetThreads(SDL_Thread **threads, int maxthreads)
+{
+	SDL_Thread *thread;
+	int i, count = 0;
+
+	SDL_AtomicLock(&SDL_threads_lock);
+	for ( i = 0; i < THREAD_HASH_SIZE; ++i ) {
+		for ( thread = SDL_Threads[i]; thread; thread = thread->next ) {
+			if ( count < maxthreads ) {
+				threads[count] = thread;
+			}
+			++count;
 		}
-		SDL_maxthreads += ARRAY_CHUNKSIZE;
-		SDL_Threads = threads;
 	}
-	SDL_Threads[SDL_numthreads++] = thread;
-done:
-	SDL_mutexV(thread_lock);
+	SDL_AtomicUnlock(&SDL_threads_lock);
+	return(count);
 }
 
-static void SDL_DelThread(SDL_Thread *thread)
+SDL_Thread *SDL_GetThreadFromID(Uint32 id)
 {
-	int i;
+	SDL_Thread *thread;
 
-	if ( !thread_lock ) {
-		return;
+	SDL_AtomicLock(&SDL_threads_lock);
+	for ( thread = SDL_Threads[THREAD_HASH(id)]; thread; thread = thread->next ) {
+		if ( thread->threadid == id ) {
+			break;
+		}
 	}
-	SDL_mutexP(thread_lock);
-	for ( i=0; i<SDL_numthreads; ++i ) {
-		if ( thread == SDL_Threads[i] ) {
+	SDL_AtomicUnlock(&SDL_threads_lock);
+	return(thread);
+}
+
+/* Thread local storage, the identifiers handed out so far and the table
+   used by systems without native support
+ */
+static SDL_atomic_t SDL_tls_ids;
+
+typedef struct SDL_GenericTLS {
+	Uint32 thread;
+	SDL_TLSData *data;
+	struct SDL_GenericTLS *next;
+} SDL_GenericTLS;
+static SDL_GenericTLS *SDL_generic_tls[THREAD_HASH_SIZE];
+static SDL_SpinLock SDL_generic_tls_lock = 0;
+
+SDL_TLSData *SDL_Generic_GetTLSData(void)
+{
+	Uint32 this_thread = SDL_ThreadID();
+	SDL_GenericTLS *entry;
+	SDL_TLSData *data = NULL;
+
+	SDL_AtomicLock(&SDL_generic_tls_lock);
+	for ( entry = SDL_generic_tls[THREAD_HASH(this_thread)]; entry; entry = entry->next ) {
+		if ( entry->thread == this_thread ) {
+			data = entry->data;
 			break;
 		}
 	}
-	if ( i < SDL_numthreads ) {
-		if ( --SDL_numthreads > 0 ) {
-			while ( i < SDL_numthreads ) {
-				SDL_Threads[i] = SDL_Threads[i+1];
-				++i;
-			}
+	SDL_AtomicUnlock(&SDL_generic_tls_lock);
+	return(data);
+}
+
+int SDL_Generic_SetTLSData(SDL_TLSData *data)
+{
+	Uint32 this_thread = SDL_ThreadID();
+	SDL_GenericTLS **bucket = &SDL_generic_tls[THREAD_HASH(this_thread)];
+	SDL_GenericTLS *entry, *prev;
+	int retval = 0;
+
+	SDL_AtomicLock(&SDL_generic_tls_lock);
+	prev = NULL;
+	for ( entry = *bucket; entry; entry = entry->next ) {
+		if ( entry->thread == this_thread ) {
+			break;
+		}
+		prev = entry;
+	}
+	if ( entry && data ) {
+		entry->data = data;
+	} else if ( entry ) {
+		if ( prev ) {
+			prev->next = entry->next;
 		} else {
-			SDL_maxthreads = 0;
-			SDL_free(SDL_Threads);
-			SDL_Threads = NULL;
+			*bucket = entry->next;
+		}
+		SDL_free(entry);
+	} else if ( data ) {
+		entry = (SDL_GenericTLS *)SDL_malloc(sizeof(*entry));
+		if ( entry ) {
+			entry->thread = this_thread;
+			entry->data = data;
+			entry->next = *bucket;
+			*bucket = entry;
+		} else {
+			retval = -1;
 		}
-#ifdef DEBUG_THREADS
-		printf("Deleting thread (%d left - %d max)\n",
-				SDL_numthreads, SDL_maxthreads);
-#endif
 	}
-	SDL_mutexV(thread_lock);
+	SDL_AtomicUnlock(&SDL_generic_tls_lock);
+	return(retval);
+}
 
-#if 0	/* There could be memory corruption if another thread is starting */
-	if ( SDL_Threads == NULL ) {
-		SDL_ThreadsQuit();
+/* Get the calling thread's data, optionally creating it */
+static SDL_TLSData *SDL_GetTLSData(int create)
+{
+	SDL_TLSData *data;
+
+	data = SDL_SYS_GetTLSData();
+	if ( !data && create ) {
+		data = (SDL_TLSData *)SDL_calloc(1, sizeof(*data));
+		if ( data && (SDL_SYS_SetTLSData(data) < 0) ) {
+			SDL_free(data);
+			data = NULL;
+		}
 	}
-#endif
+	return(data);
 }
 
-/* The default (non-thread-safe) global error variable */
+void SDL_FreeTLSData(SDL_TLSData *data)
+{
+	unsigned int i;
+
+	for ( i = 0; i < data->limit; ++i ) {
+		if ( data->array[i].destructor && data->array[i].data ) {
+			data->array[i].destructor((void *)data->array[i].data);
+		}
+	}
+	SDL_free(data->array);
+	SDL_free(data);
+}
+
+void SDL_TLSCleanup(void)
+{
+	SDL_TLSData *data;
+
+	data = SDL_SYS_GetTLSData();
+	if ( data ) {
+		SDL_SYS_SetTLSData(NULL);
+		SDL_FreeTLSData(data);
+	}
+}
+
+SDL_TLSID SDL_TLSCreate(void)
+{
+	return((SDL_TLSID)SDL_AtomicIncRef(&SDL_tls_ids) + 1);
+}
+
+void *SDL_TLSGet(SDL_TLSID id)
+{
+	SDL_TLSData *data;
+
+	data = SDL_GetTLSData(0);
+	if ( !data || (id == 0) || (id > data->limit) ) {
+		return(NULL);
+	}
+	return((void *)data->array[id-1].data);
+}
+
+int SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
+{
+	SDL_TLSData *data;
+
+	if ( id == 0 ) {
+		SDL_SetError("Invalid thread local storage ID");
+		return(-1);
+	}
+	data = SDL_GetTLSData(1);
+	if ( !data ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	if ( id > data->limit ) {
+		SDL_TLSEntry *array;
+		unsigned int limit = id + 15;
+
+		array = (SDL_TLSEntry *)SDL_realloc(data->array,
+						limit*(sizeof *array));
+		if ( array == NULL ) {
+			SDL_OutOfMemory();
+			return(-1);
+		}
+		SDL_memset(&array[data->limit], 0,
+		           (limit - data->limit)*(sizeof *array));
+		data->array = array;
+		data->limit = limit;
+	}
+	data->array[id-1].data = value;
+	data->array[id-1].destructor = destructor;
+	return(0);
+}
+
+/* The default (non-thread-safe) global error variable, for when a thread's
+   data couldn't be allocated
+ */
 static SDL_error SDL_global_error;
 
 /* Routine to get the thread-specific error variable */
 SDL_error *SDL_GetErrBuf(void)
 {
-	SDL_error *errbuf;
-
-	errbuf = &SDL_global_error;
-	if ( SDL_Threads ) {
-		int i;
-		Uint32 this_thread;
-
-		this_thread = SDL_ThreadID();
-		SDL_mutexP(thread_lock);
-		for ( i=0; i<SDL_numthreads; ++i ) {
-			if ( this_thread == SDL_Threads[i]->threadid ) {
-				errbuf = &SDL_Threads[i]->errbuf;
-				break;
-			}
-		}
-		SDL_mutexV(thread_lock);
+	SDL_TLSData *data;
+
+	data = SDL_GetTLSData(1);
+	if ( data ) {
+		return(&data->errbuf);
 	}
-	return(errbuf);
+	return(&SDL_global_error);
 }
 
 
@@ -179,6 +362,7 @@ typedef struct {
 void SDL_RunThread(void *data)
 {
 	thread_args *args;
+	SDL_Thread *thread;
 	int (SDLCALL *userfunc)(void *);
 	void *userdata;
 	int *statusloc;
@@ -186,29 +370,51 @@ void SDL_RunThread(void *data)
 	/* Perform any system-dependent setup
 	   - this function cannot fail, and cannot use SDL_SetError()
 	 */
-	SDL_SYS_SetupThread();
-
-	/* Get the thread id */
 	args = (thread_args *)data;
+	SDL_SYS_SetupThread(args->info);
+
+	/* Set up the thread local data up front, the built-in SDL_malloc()
+	   keeps the thread's home heap there */
+	SDL_GetTLSData(1);
+
+	/* Get the thread id, and add the thread to the table */
 	args->info->threadid = SDL_ThreadID();
+	args->info->started = SDL_GetTicks();
+	SDL_AddThread(args->info);
 
 	/* Figure out what function to run */
+	thread = args->info;
 	userfunc = args->func;
 	userdata = args->data;
-	statusloc = &args->info->status;
+	statusloc = &thread->status;
 
 	/* Wake up the parent thread */
 	SDL_SemPost(args->wait);
 
 	/* Run the function */
 	*statusloc = userfunc(userdata);
+	SDL_ExitThread(thread);
+
+	/* Clean up thread local storage */
+	SDL_TLSCleanup();
 }
 
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
 #undef SDL_CreateThread
+#undef SDL_CreateThreadWithAttr
 DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *data, pfnSDL_CurrentBeginThread pfnBeginThread, pfnSDL_CurrentEndThread pfnEndThread)
+{
+	return SDL_CreateThreadWithAttr(fn, data, NULL, pfnBeginThread, pfnEndThread);
+}
+
+DECLSPEC SDL_Thread * SDLCALL SDL_CreateThreadWithAttr(int (SDLCALL *fn)(void *), void *data, const SDL_ThreadAttr *attr, pfnSDL_CurrentBeginThread pfnBeginThread, pfnSDL_CurrentEndThread pfnEndThread)
 #else
 DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *data)
+{
+	return SDL_CreateThreadWithAttr(fn, data, NULL);
+}
+
+DECLSPEC SDL_Thread * SDLCALL SDL_CreateThreadWithAttr(int (SDLCALL *fn)(void *), void *data, const SDL_ThreadAttr *attr)
 #endif
 {
 	SDL_Thread *thread;
@@ -223,11 +429,25 @@ DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *
 	}
 	SDL_memset(thread, 0, (sizeof *thread));
 	thread->status = -1;
+	if ( attr ) {
+		if ( attr->name ) {
+			thread->name = SDL_strdup(attr->name);
+			if ( thread->name == NULL ) {
+				SDL_OutOfMemory();
+				SDL_free(thread);
+				return(NULL);
+			}
+		}
+		thread->stacksize = attr->stacksize;
+		thread->priority = attr->priority;
+		thread->affinity = attr->affinity;
+	}
 
 	/* Set up the arguments for the thread */
 	args = (thread_args *)SDL_malloc(sizeof(*args));
 	if ( args == NULL ) {
 		SDL_OutOfMemory();
+		SDL_free(thread->name);
 		SDL_free(thread);
 		return(NULL);
 	}
@@ -236,14 +456,12 @@ DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *
 	args->info = thread;
 	args->wait = SDL_CreateSemaphore(0);
 	if ( args->wait == NULL ) {
+		SDL_free(thread->name);
 		SDL_free(thread);
 		SDL_free(args);
 		return(NULL);
 	}
 
-	/* Add the thread to the list of available threads */
-	SDL_AddThread(thread);
-
 	/* Create the thread and go! */
 #ifdef SDL_PASSED_BEGINTHREAD_ENDTHREAD
 	ret = SDL_SYS_CreateThread(thread, args, pfnBeginThread, pfnEndThread);
@@ -255,7 +473,7 @@ DECLSPEC SDL_Thread * SDLCALL SDL_CreateThread(int (SDLCALL *fn)(void *), void *
 		SDL_SemWait(args->wait);
 	} else {
 		/* Oops, failed.  Gotta free everything */
-		SDL_DelThread(thread);
+		SDL_free(thread->name);
 		SDL_free(thread);
 		thread = NULL;
 	}
@@ -274,10 +492,19 @@ void SDL_WaitThread(SDL_Thread *thread, int *status)
 			*status = thread->status;
 		}
 		SDL_DelThread(thread);
+		SDL_free(thread->name);
 		SDL_free(thread);
 	}
 }
 
+const char *SDL_GetThreadName(SDL_Thread *thread)
+{
+	if ( thread ) {
+		return(thread->name);
+	}
+	return(NULL);
+}
+
 Uint32 SDL_GetThreadID(SDL_Thread *thread)
 {
 	Uint32 id;
@@ -298,3 +525,18 @@ void SDL_KillThread(SDL_Thread *thread)
 	}
 }
 
+
+#if !SDL_THREAD_FUTEX
+/* Only the futex backend keeps contention statistics so far */
+int SDL_GetMutexStats(SDL_mutex *mutex, SDL_SyncStats *stats)
+{
+	SDL_SetError("Lock statistics aren't available on this platform");
+	return(-1);
+}
+
+int SDL_GetSemStats(SDL_sem *sem, SDL_SyncStats *stats)
+{
+	SDL_SetError("Lock statistics aren't available on this platform");
+	return(-1);
+}
+#endif /* !SDL_THREAD_FUTEX */
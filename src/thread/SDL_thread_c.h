@@ -56,11 +56,42 @@ struct SDL_Thread {
 	Uint32 threadid;
 	SYS_ThreadHandle handle;
 	int status;
-	SDL_error errbuf;
 	void *data;
+	char *name;
+	Uint32 stacksize;
+	SDL_ThreadPriority priority;
+	Uint32 affinity;
+	Uint32 started;
+	struct SDL_Thread *prev;
+	struct SDL_Thread *next;
 };
 
 /* This is the function called to run a thread */
 extern void SDL_RunThread(void *data);
 
+/* The per-thread data, allocated the first time a thread needs it */
+typedef struct SDL_TLSEntry {
+	const void *data;
+	void (SDLCALL *destructor)(void *);
+} SDL_TLSEntry;
+
+typedef struct SDL_TLSData {
+	SDL_error errbuf;
+	unsigned int limit;
+	SDL_TLSEntry *array;
+	int malloc_arena;	/* SDL_malloc() home arena plus one, 0 if unset */
+} SDL_TLSData;
+
+/* Run the destructors and free a thread's data */
+extern void SDL_FreeTLSData(SDL_TLSData *data);
+
+/* Free the calling thread's data, as it exits */
+extern void SDL_TLSCleanup(void);
+
+/* Per-thread data kept in a table searched by thread ID, for systems
+   without native thread local storage
+ */
+extern SDL_TLSData *SDL_Generic_GetTLSData(void);
+extern int SDL_Generic_SetTLSData(SDL_TLSData *data);
+
 #endif /* _SDL_thread_c_h */
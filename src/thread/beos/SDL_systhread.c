@@ -61,8 +61,26 @@ static int32 RunThread(void *data)
 
 int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 {
+	int32 priority;
+
+	switch (thread->priority) {
+	    case SDL_THREAD_PRIORITY_LOW:
+		priority = B_LOW_PRIORITY;
+		break;
+	    case SDL_THREAD_PRIORITY_HIGH:
+		priority = B_DISPLAY_PRIORITY;
+		break;
+	    case SDL_THREAD_PRIORITY_TIME_CRITICAL:
+		priority = B_URGENT_PRIORITY;
+		break;
+	    default:
+		priority = B_NORMAL_PRIORITY;
+		break;
+	}
+
 	/* Create the thread and go! */
-	thread->handle=spawn_thread(RunThread, "SDL", B_NORMAL_PRIORITY, args);
+	thread->handle=spawn_thread(RunThread,
+			thread->name ? thread->name : "SDL", priority, args);
 	if ( (thread->handle == B_NO_MORE_THREADS) ||
 	     (thread->handle == B_NO_MEMORY) ) {
 		SDL_SetError("Not enough resources to create thread");
@@ -72,12 +90,22 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	return(0);
 }
 
-void SDL_SYS_SetupThread(void)
+void SDL_SYS_SetupThread(SDL_Thread *thread)
 {
 	/* Mask asynchronous signals for this thread */
 	SDL_MaskSignals(NULL);
 }
 
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	return(SDL_Generic_GetTLSData());
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	return(SDL_Generic_SetTLSData(data));
+}
+
 Uint32 SDL_ThreadID(void)
 {
 	return((Uint32)find_thread(NULL));
@@ -32,11 +32,21 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	return(-1);
 }
 
-void SDL_SYS_SetupThread(void)
+void SDL_SYS_SetupThread(SDL_Thread *thread)
 {
 	return;
 }
 
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	return(SDL_Generic_GetTLSData());
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	return(SDL_Generic_SetTLSData(data));
+}
+
 Uint32 SDL_ThreadID(void)
 {
 	return(0);
@@ -49,7 +49,7 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	return(0);
 }
 
-void SDL_SYS_SetupThread(void)
+void SDL_SYS_SetupThread(SDL_Thread *thread)
 {
 	int i;
 	sigset_t mask;
@@ -62,6 +62,16 @@ void SDL_SYS_SetupThread(void)
 	sigprocmask(SIG_BLOCK, &mask, NULL);
 }
 
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	return(SDL_Generic_GetTLSData());
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	return(SDL_Generic_SetTLSData(data));
+}
+
 /* WARNING:  This may not work for systems with 64-bit pid_t */
 Uint32 SDL_ThreadID(void)
 {
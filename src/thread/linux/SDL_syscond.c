@@ -0,0 +1,141 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Condition variables on Linux futexes.  Waiters sleep on a sequence
+   number that every signal and broadcast bumps.
+ */
+
+#include "SDL_thread.h"
+#include "SDL_sysmutex_c.h"
+
+struct SDL_cond
+{
+	volatile int seq;
+	volatile int waiters;
+};
+
+/* Create a condition variable */
+SDL_cond * SDL_CreateCond(void)
+{
+	SDL_cond *cond;
+
+	cond = (SDL_cond *) SDL_calloc(1, sizeof(SDL_cond));
+	if ( ! cond ) {
+		SDL_OutOfMemory();
+	}
+	return(cond);
+}
+
+/* Destroy a condition variable */
+void SDL_DestroyCond(SDL_cond *cond)
+{
+	if ( cond ) {
+		SDL_free(cond);
+	}
+}
+
+/* Restart one of the threads that are waiting on the condition variable */
+int SDL_CondSignal(SDL_cond *cond)
+{
+	if ( ! cond ) {
+		SDL_SetError("Passed a NULL condition variable");
+		return -1;
+	}
+
+	if ( cond->waiters > 0 ) {
+		__sync_fetch_and_add(&cond->seq, 1);
+		SDL_FutexWake(&cond->seq, 1);
+	}
+	return 0;
+}
+
+/* Restart all threads that are waiting on the condition variable */
+int SDL_CondBroadcast(SDL_cond *cond)
+{
+	if ( ! cond ) {
+		SDL_SetError("Passed a NULL condition variable");
+		return -1;
+	}
+
+	if ( cond->waiters > 0 ) {
+		__sync_fetch_and_add(&cond->seq, 1);
+		SDL_FutexWake(&cond->seq, 0x7FFFFFFF);
+	}
+	return 0;
+}
+
+int SDL_CondWaitTimeout(SDL_cond *cond, SDL_mutex *mutex, Uint32 ms)
+{
+	struct timespec deadline, left, *wait = NULL;
+	int seq, recursive;
+	int retval = 0;
+
+	if ( ! cond ) {
+		SDL_SetError("Passed a NULL condition variable");
+		return -1;
+	}
+	if ( ! mutex ) {
+		SDL_SetError("Passed a NULL mutex");
+		return -1;
+	}
+
+	if ( ms != SDL_MUTEX_MAXWAIT ) {
+		SDL_FutexDeadline(ms, &deadline);
+		wait = &left;
+	}
+
+	/* Signals need the mutex to see us, so register before letting go */
+	__sync_fetch_and_add(&cond->waiters, 1);
+	seq = cond->seq;
+
+	/* Release the mutex completely, even if it's locked recursively */
+	recursive = mutex->recursive;
+	mutex->recursive = 0;
+	if ( SDL_mutexV(mutex) < 0 ) {
+		mutex->recursive = recursive;
+		__sync_fetch_and_sub(&cond->waiters, 1);
+		return -1;
+	}
+
+	/* Keep sleeping through interrupted waits until signaled */
+	while ( cond->seq == seq ) {
+		if ( wait && ! SDL_FutexTimeLeft(&deadline, wait) ) {
+			retval = SDL_MUTEX_TIMEDOUT;
+			break;
+		}
+		SDL_FutexWait(&cond->seq, seq, wait);
+	}
+	__sync_fetch_and_sub(&cond->waiters, 1);
+
+	SDL_mutexP(mutex);
+	mutex->recursive = recursive;
+	return retval;
+}
+
+/* Wait on the condition variable, unlocking the provided mutex.
+   The mutex must be locked before entering this function!
+ */
+int SDL_CondWait(SDL_cond *cond, SDL_mutex *mutex)
+{
+	return SDL_CondWaitTimeout(cond, mutex, SDL_MUTEX_MAXWAIT);
+}
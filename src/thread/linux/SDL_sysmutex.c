@@ -0,0 +1,133 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Mutexes on Linux futexes, which only enter the kernel when a thread has
+   to sleep or wake a sleeper.
+ */
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_sysmutex_c.h"
+
+/* Times to check a held mutex before sleeping on it */
+#define MUTEX_SPIN_ROUNDS	100
+
+SDL_mutex *SDL_CreateMutex (void)
+{
+	SDL_mutex *mutex;
+
+	mutex = (SDL_mutex *)SDL_calloc(1, sizeof(*mutex));
+	if ( ! mutex ) {
+		SDL_OutOfMemory();
+	}
+	return(mutex);
+}
+
+void SDL_DestroyMutex(SDL_mutex *mutex)
+{
+	if ( mutex ) {
+		SDL_free(mutex);
+	}
+}
+
+/* Lock the mutex */
+int SDL_mutexP(SDL_mutex *mutex)
+{
+	pthread_t this_thread;
+	int c, i;
+
+	if ( mutex == NULL ) {
+		SDL_SetError("Passed a NULL mutex");
+		return -1;
+	}
+
+	this_thread = pthread_self();
+	if ( mutex->owner == this_thread ) {
+		++mutex->recursive;
+		++mutex->acquired;
+		return 0;
+	}
+
+	c = __sync_val_compare_and_swap(&mutex->state, 0, 1);
+	if ( c != 0 ) {
+		/* Spin a little in case the owner is about to let go */
+		for ( i = 0; (c != 0) && (i < MUTEX_SPIN_ROUNDS); ++i ) {
+			SDL_CPUPause();
+			c = mutex->state;
+			if ( c == 0 ) {
+				c = __sync_val_compare_and_swap(&mutex->state, 0, 1);
+			}
+		}
+
+		/* Mark the mutex as having sleepers, so the unlock wakes us */
+		if ( (c != 0) && (c != 2) ) {
+			c = __sync_lock_test_and_set(&mutex->state, 2);
+		}
+		while ( c != 0 ) {
+			SDL_FutexWait(&mutex->state, 2, NULL);
+			c = __sync_lock_test_and_set(&mutex->state, 2);
+		}
+		++mutex->contended;
+	}
+	mutex->owner = this_thread;
+	mutex->recursive = 0;
+	++mutex->acquired;
+	return 0;
+}
+
+int SDL_mutexV(SDL_mutex *mutex)
+{
+	if ( mutex == NULL ) {
+		SDL_SetError("Passed a NULL mutex");
+		return -1;
+	}
+
+	/* We can only unlock the mutex if we own it */
+	if ( pthread_self() != mutex->owner ) {
+		SDL_SetError("mutex not owned by this thread");
+		return -1;
+	}
+	if ( mutex->recursive ) {
+		--mutex->recursive;
+		return 0;
+	}
+
+	mutex->owner = 0;
+	if ( __sync_fetch_and_sub(&mutex->state, 1) != 1 ) {
+		mutex->state = 0;
+		SDL_FutexWake(&mutex->state, 1);
+	}
+	return 0;
+}
+
+int SDL_GetMutexStats(SDL_mutex *mutex, SDL_SyncStats *stats)
+{
+	if ( mutex == NULL ) {
+		SDL_SetError("Passed a NULL mutex");
+		return -1;
+	}
+	stats->acquired = mutex->acquired;
+	stats->contended = mutex->contended;
+	stats->timeouts = 0;
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+#ifndef _SDL_mutex_c_h
+#define _SDL_mutex_c_h
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifndef FUTEX_WAIT_PRIVATE
+#define FUTEX_WAIT_PRIVATE	FUTEX_WAIT
+#define FUTEX_WAKE_PRIVATE	FUTEX_WAKE
+#endif
+
+struct SDL_mutex {
+	volatile int state;	/* 0 unlocked, 1 locked, 2 locked with sleepers */
+	pthread_t owner;
+	int recursive;
+	Uint32 acquired;
+	Uint32 contended;
+};
+
+/* Sleep while *addr is value, until woken or the timeout passes */
+static __inline__ void SDL_FutexWait(volatile int *addr, int value, const struct timespec *timeout)
+{
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, timeout, NULL, 0);
+}
+
+/* Wake up to count threads sleeping on addr */
+static __inline__ void SDL_FutexWake(volatile int *addr, int count)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+/* Get the time a wait of ms milliseconds ends, on the monotonic clock
+   so setting the system time doesn't stretch or cut short the wait.
+ */
+static __inline__ void SDL_FutexDeadline(Uint32 ms, struct timespec *deadline)
+{
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline->tv_sec += ms / 1000;
+	deadline->tv_nsec += (ms % 1000) * 1000000;
+	if ( deadline->tv_nsec >= 1000000000 ) {
+		deadline->tv_nsec -= 1000000000;
+		++deadline->tv_sec;
+	}
+}
+
+/* Get the time left until the deadline, returns 0 if it has passed */
+static __inline__ int SDL_FutexTimeLeft(const struct timespec *deadline, struct timespec *left)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	left->tv_sec = deadline->tv_sec - now.tv_sec;
+	left->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+	if ( left->tv_nsec < 0 ) {
+		left->tv_nsec += 1000000000;
+		--left->tv_sec;
+	}
+	return (left->tv_sec > 0) || ((left->tv_sec == 0) && (left->tv_nsec > 0));
+}
+
+#endif /* _SDL_mutex_c_h */
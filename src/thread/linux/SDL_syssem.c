@@ -0,0 +1,165 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Semaphores on Linux futexes */
+
+#include "SDL_thread.h"
+#include "SDL_sysmutex_c.h"
+
+struct SDL_semaphore {
+	volatile int value;
+	volatile int waiters;
+	volatile Uint32 acquired;
+	volatile Uint32 contended;
+	volatile Uint32 timeouts;
+};
+
+/* Create a semaphore, initialized with value */
+SDL_sem *SDL_CreateSemaphore(Uint32 initial_value)
+{
+	SDL_sem *sem = (SDL_sem *) SDL_calloc(1, sizeof(SDL_sem));
+	if ( sem ) {
+		sem->value = (int)initial_value;
+	} else {
+		SDL_OutOfMemory();
+	}
+	return sem;
+}
+
+void SDL_DestroySemaphore(SDL_sem *sem)
+{
+	if ( sem ) {
+		SDL_free(sem);
+	}
+}
+
+/* Decrement the value if it's positive, returns 0 if it wasn't */
+static int SDL_SemDown(SDL_sem *sem)
+{
+	int value, old;
+
+	value = sem->value;
+	while ( value > 0 ) {
+		old = __sync_val_compare_and_swap(&sem->value, value, value - 1);
+		if ( old == value ) {
+			return 1;
+		}
+		value = old;
+	}
+	return 0;
+}
+
+int SDL_SemTryWait(SDL_sem *sem)
+{
+	if ( ! sem ) {
+		SDL_SetError("Passed a NULL semaphore");
+		return -1;
+	}
+	if ( SDL_SemDown(sem) ) {
+		__sync_fetch_and_add(&sem->acquired, 1);
+		return 0;
+	}
+	return SDL_MUTEX_TIMEDOUT;
+}
+
+int SDL_SemWait(SDL_sem *sem)
+{
+	return SDL_SemWaitTimeout(sem, SDL_MUTEX_MAXWAIT);
+}
+
+int SDL_SemWaitTimeout(SDL_sem *sem, Uint32 timeout)
+{
+	struct timespec deadline, left, *wait = NULL;
+	int retval = 0;
+
+	/* Try the easy cases first */
+	retval = SDL_SemTryWait(sem);
+	if ( (retval != SDL_MUTEX_TIMEDOUT) || (timeout == 0) ) {
+		return retval;
+	}
+	retval = 0;
+
+	if ( timeout != SDL_MUTEX_MAXWAIT ) {
+		SDL_FutexDeadline(timeout, &deadline);
+		wait = &left;
+	}
+
+	/* SDL_SemPost() checks for waiters after raising the value, so
+	   either we see the new value here or it sees us and wakes us.
+	 */
+	__sync_fetch_and_add(&sem->waiters, 1);
+	while ( ! SDL_SemDown(sem) ) {
+		if ( wait && ! SDL_FutexTimeLeft(&deadline, wait) ) {
+			retval = SDL_MUTEX_TIMEDOUT;
+			break;
+		}
+		SDL_FutexWait(&sem->value, 0, wait);
+	}
+	__sync_fetch_and_sub(&sem->waiters, 1);
+
+	if ( retval == 0 ) {
+		__sync_fetch_and_add(&sem->acquired, 1);
+		__sync_fetch_and_add(&sem->contended, 1);
+	} else {
+		__sync_fetch_and_add(&sem->timeouts, 1);
+	}
+	return retval;
+}
+
+Uint32 SDL_SemValue(SDL_sem *sem)
+{
+	int ret = 0;
+	if ( sem ) {
+		ret = sem->value;
+		if ( ret < 0 ) {
+			ret = 0;
+		}
+	}
+	return (Uint32)ret;
+}
+
+int SDL_SemPost(SDL_sem *sem)
+{
+	if ( ! sem ) {
+		SDL_SetError("Passed a NULL semaphore");
+		return -1;
+	}
+
+	__sync_fetch_and_add(&sem->value, 1);
+	if ( sem->waiters > 0 ) {
+		SDL_FutexWake(&sem->value, 1);
+	}
+	return 0;
+}
+
+int SDL_GetSemStats(SDL_sem *sem, SDL_SyncStats *stats)
+{
+	if ( ! sem ) {
+		SDL_SetError("Passed a NULL semaphore");
+		return -1;
+	}
+	stats->acquired = sem->acquired;
+	stats->contended = sem->contended;
+	stats->timeouts = sem->timeouts;
+	return 0;
+}
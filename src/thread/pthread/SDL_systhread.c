@@ -21,8 +21,18 @@
 */
 #include "SDL_config.h"
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
+#ifdef __LINUX__
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
 
 #include "SDL_thread.h"
 #include "../SDL_thread_c.h"
@@ -59,6 +69,9 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 		return(-1);
 	}
 	pthread_attr_setdetachstate(&type, PTHREAD_CREATE_JOINABLE);
+	if ( thread->stacksize ) {
+		pthread_attr_setstacksize(&type, thread->stacksize);
+	}
 
 	/* Create the thread and go! */
 	if ( pthread_create(&thread->handle, &type, RunThread, args) != 0 ) {
@@ -76,7 +89,63 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	return(0);
 }
 
-void SDL_SYS_SetupThread(void)
+static void SDL_SYS_SetThreadPriority(SDL_ThreadPriority priority)
+{
+	struct sched_param param;
+
+	/* Real-time scheduling usually needs privileges or an rtprio limit,
+	   so fall back to the highest ordinary priority without them.
+	 */
+	if ( priority == SDL_THREAD_PRIORITY_TIME_CRITICAL ) {
+		SDL_memset(&param, 0, sizeof(param));
+		param.sched_priority = (sched_get_priority_min(SCHED_RR) +
+		                        sched_get_priority_max(SCHED_RR)) / 2;
+		if ( pthread_setschedparam(pthread_self(), SCHED_RR, &param) == 0 ) {
+			return;
+		}
+	}
+
+#ifdef __LINUX__
+	/* Linux ignores priorities under SCHED_OTHER, but each thread has its
+	   own nice value.  Raising it (negative nice) needs privileges too.
+	 */
+	{
+		int nice;
+
+		switch (priority) {
+		    case SDL_THREAD_PRIORITY_LOW:
+			nice = 10;
+			break;
+		    case SDL_THREAD_PRIORITY_HIGH:
+			nice = -10;
+			break;
+		    case SDL_THREAD_PRIORITY_TIME_CRITICAL:
+			nice = -20;
+			break;
+		    default:
+			return;
+		}
+		setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice);
+	}
+#else
+	{
+		int policy;
+
+		if ( (priority == SDL_THREAD_PRIORITY_NORMAL) ||
+		     (pthread_getschedparam(pthread_self(), &policy, &param) != 0) ) {
+			return;
+		}
+		if ( priority == SDL_THREAD_PRIORITY_LOW ) {
+			param.sched_priority = sched_get_priority_min(policy);
+		} else {
+			param.sched_priority = sched_get_priority_max(policy);
+		}
+		pthread_setschedparam(pthread_self(), policy, &param);
+	}
+#endif
+}
+
+void SDL_SYS_SetupThread(SDL_Thread *thread)
 {
 	int i;
 	sigset_t mask;
@@ -94,6 +163,68 @@ void SDL_SYS_SetupThread(void)
 		pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &oldstate);
 	}
 #endif
+
+#ifdef __LINUX__
+	/* Linux keeps the first 15 characters */
+	if ( thread->name ) {
+		prctl(PR_SET_NAME, (unsigned long)thread->name, 0, 0, 0);
+	}
+#endif
+	SDL_SYS_SetThreadPriority(thread->priority);
+#if defined(__LINUX__) && defined(CPU_SET)
+	if ( thread->affinity ) {
+		cpu_set_t cpus;
+
+		CPU_ZERO(&cpus);
+		for ( i = 0; i < 32; ++i ) {
+			if ( thread->affinity & (1U << i) ) {
+				CPU_SET(i, &cpus);
+			}
+		}
+		sched_setaffinity(0, sizeof(cpus), &cpus);
+	}
+#endif
+}
+
+/* Thread local storage, falling back to the generic table if there are
+   no keys left.  The key destructor frees the data of threads that SDL
+   didn't create.
+ */
+static pthread_key_t thread_local_storage;
+static pthread_once_t thread_local_once = PTHREAD_ONCE_INIT;
+static int generic_local_storage = 0;
+
+static void SDL_SYS_FreeTLSData(void *data)
+{
+	SDL_FreeTLSData((SDL_TLSData *)data);
+}
+
+static void SDL_SYS_InitTLSData(void)
+{
+	if ( pthread_key_create(&thread_local_storage, SDL_SYS_FreeTLSData) != 0 ) {
+		generic_local_storage = 1;
+	}
+}
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	pthread_once(&thread_local_once, SDL_SYS_InitTLSData);
+	if ( generic_local_storage ) {
+		return(SDL_Generic_GetTLSData());
+	}
+	return((SDL_TLSData *)pthread_getspecific(thread_local_storage));
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	pthread_once(&thread_local_once, SDL_SYS_InitTLSData);
+	if ( generic_local_storage ) {
+		return(SDL_Generic_SetTLSData(data));
+	}
+	if ( pthread_setspecific(thread_local_storage, data) != 0 ) {
+		return(-1);
+	}
+	return(0);
 }
 
 /* WARNING:  This may not work for systems with 64-bit pid_t */
@@ -32,6 +32,11 @@
 #include <psp2/types.h>
 #include <psp2/kernel/threadmgr.h>
 
+/* Lower numbers run first, user threads range from 64 to 191 */
+#define VITA_THREAD_PRIORITY_LOW           191
+#define VITA_THREAD_PRIORITY_HIGH          112
+#define VITA_THREAD_PRIORITY_TIME_CRITICAL 64
+
 static int ThreadEntry(SceSize args, void *argp)
 {
     SDL_RunThread(*(void **) argp);
@@ -42,16 +47,42 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 {
     SceKernelThreadInfo info;
     int priority = 32;
+    int affinity = 0;
 
-    /* Set priority of new thread to the same as the current thread */
-    info.size = sizeof(SceKernelThreadInfo);
-    if (sceKernelGetThreadInfo(sceKernelGetThreadId(), &info) == 0)
+    switch (thread->priority)
     {
-        priority = info.currentPriority;
+        case SDL_THREAD_PRIORITY_LOW:
+            priority = VITA_THREAD_PRIORITY_LOW;
+            break;
+        case SDL_THREAD_PRIORITY_HIGH:
+            priority = VITA_THREAD_PRIORITY_HIGH;
+            break;
+        case SDL_THREAD_PRIORITY_TIME_CRITICAL:
+            priority = VITA_THREAD_PRIORITY_TIME_CRITICAL;
+            break;
+        default:
+            /* Set priority of new thread to the same as the current thread */
+            info.size = sizeof(SceKernelThreadInfo);
+            if (sceKernelGetThreadInfo(sceKernelGetThreadId(), &info) == 0)
+            {
+                priority = info.currentPriority;
+            }
+            break;
     }
 
-    thread->handle = sceKernelCreateThread("SDL thread", ThreadEntry,
-                           priority, 0x10000, 0, 0, NULL);
+    /* Applications get the first three cores, 0 lets it run on any */
+    if (thread->affinity & 0x1)
+        affinity |= SCE_KERNEL_CPU_MASK_USER_0;
+    if (thread->affinity & 0x2)
+        affinity |= SCE_KERNEL_CPU_MASK_USER_1;
+    if (thread->affinity & 0x4)
+        affinity |= SCE_KERNEL_CPU_MASK_USER_2;
+
+    thread->handle = sceKernelCreateThread(
+                           thread->name ? thread->name : "SDL thread",
+                           ThreadEntry, priority,
+                           thread->stacksize ? thread->stacksize : 0x10000,
+                           0, affinity, NULL);
 
     if (thread->handle < 0)
     {
@@ -63,11 +94,28 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
     return 0;
 }
 
-void SDL_SYS_SetupThread(void)
+void SDL_SYS_SetupThread(SDL_Thread *thread)
 {
     return;
 }
 
+/* The compiler's thread local storage, so lookups don't take a lock.
+   There's no destructor, but threads SDL created have their data freed
+   when they exit.
+ */
+static __thread SDL_TLSData *thread_local_data = NULL;
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+    return thread_local_data;
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+    thread_local_data = data;
+    return 0;
+}
+
 Uint32 SDL_ThreadID(void)
 {
     return (Uint32) sceKernelGetThreadId();
@@ -26,6 +26,7 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
+#include "SDL_atomic.h"
 #include "SDL_thread.h"
 #include "../SDL_thread_c.h"
 #include "../SDL_systhread.h"
@@ -123,11 +124,11 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	if (pfnBeginThread) {
 		unsigned threadid = 0;
 		thread->handle = (SYS_ThreadHandle)
-				((uintptr_t) pfnBeginThread(NULL, 0, RunThreadViaBeginThreadEx,
+				((uintptr_t) pfnBeginThread(NULL, thread->stacksize, RunThreadViaBeginThreadEx,
 										 pThreadParms, 0, &threadid));
 	} else {
 		DWORD threadid = 0;
-		thread->handle = CreateThread(NULL, 0, RunThreadViaCreateThread, pThreadParms, 0, &threadid);
+		thread->handle = CreateThread(NULL, thread->stacksize, RunThreadViaCreateThread, pThreadParms, 0, &threadid);
 	}
 	if (thread->handle == NULL) {
 		SDL_SetError("Not enough resources to create thread");
@@ -136,9 +137,65 @@ int SDL_SYS_CreateThread(SDL_Thread *thread, void *args)
 	return(0);
 }
 
-void SDL_SYS_SetupThread(void)
+#ifdef _MSC_VER
+/* Debuggers pick up thread names from this exception */
+#pragma pack(push, 8)
+typedef struct tagTHREADNAME_INFO
 {
-	return;
+	DWORD dwType;		/* must be 0x1000 */
+	LPCSTR szName;		/* pointer to name (in user addr space) */
+	DWORD dwThreadID;	/* thread ID (-1=caller thread) */
+	DWORD dwFlags;		/* reserved for future use, must be zero */
+} THREADNAME_INFO;
+#pragma pack(pop)
+
+static void SDL_SYS_SetThreadName(const char *name)
+{
+	THREADNAME_INFO info;
+
+	info.dwType = 0x1000;
+	info.szName = name;
+	info.dwThreadID = (DWORD)-1;
+	info.dwFlags = 0;
+	__try {
+		RaiseException(0x406D1388, 0, sizeof(info) / sizeof(ULONG_PTR), (void *)&info);
+	}
+	__except(EXCEPTION_EXECUTE_HANDLER) {
+	}
+}
+#endif /* _MSC_VER */
+
+void SDL_SYS_SetupThread(SDL_Thread *thread)
+{
+	int priority;
+
+#ifdef _MSC_VER
+	if ( thread->name ) {
+		SDL_SYS_SetThreadName(thread->name);
+	}
+#endif
+	switch (thread->priority) {
+	    case SDL_THREAD_PRIORITY_LOW:
+		priority = THREAD_PRIORITY_LOWEST;
+		break;
+	    case SDL_THREAD_PRIORITY_HIGH:
+		priority = THREAD_PRIORITY_HIGHEST;
+		break;
+	    case SDL_THREAD_PRIORITY_TIME_CRITICAL:
+		priority = THREAD_PRIORITY_TIME_CRITICAL;
+		break;
+	    default:
+		priority = THREAD_PRIORITY_NORMAL;
+		break;
+	}
+	if ( priority != THREAD_PRIORITY_NORMAL ) {
+		SetThreadPriority(GetCurrentThread(), priority);
+	}
+#ifndef _WIN32_WCE
+	if ( thread->affinity ) {
+		SetThreadAffinityMask(GetCurrentThread(), thread->affinity);
+	}
+#endif
 }
 
 Uint32 SDL_ThreadID(void)
@@ -146,6 +203,52 @@ Uint32 SDL_ThreadID(void)
 	return((Uint32)GetCurrentThreadId());
 }
 
+/* Thread local storage, falling back to the generic table if there are
+   no slots left.  Windows has no slot destructors, so only threads that
+   SDL created have their data freed when they exit.
+ */
+static DWORD thread_local_storage = TLS_OUT_OF_INDEXES;
+static int generic_local_storage = 0;
+static SDL_SpinLock thread_local_lock = 0;
+
+static void SDL_SYS_InitTLSData(void)
+{
+	if ( (thread_local_storage == TLS_OUT_OF_INDEXES) &&
+	     !generic_local_storage ) {
+		SDL_AtomicLock(&thread_local_lock);
+		if ( (thread_local_storage == TLS_OUT_OF_INDEXES) &&
+		     !generic_local_storage ) {
+			DWORD storage = TlsAlloc();
+			if ( storage == TLS_OUT_OF_INDEXES ) {
+				generic_local_storage = 1;
+			}
+			thread_local_storage = storage;
+		}
+		SDL_AtomicUnlock(&thread_local_lock);
+	}
+}
+
+SDL_TLSData *SDL_SYS_GetTLSData(void)
+{
+	SDL_SYS_InitTLSData();
+	if ( generic_local_storage ) {
+		return(SDL_Generic_GetTLSData());
+	}
+	return((SDL_TLSData *)TlsGetValue(thread_local_storage));
+}
+
+int SDL_SYS_SetTLSData(SDL_TLSData *data)
+{
+	SDL_SYS_InitTLSData();
+	if ( generic_local_storage ) {
+		return(SDL_Generic_SetTLSData(data));
+	}
+	if ( !TlsSetValue(thread_local_storage, data) ) {
+		return(-1);
+	}
+	return(0);
+}
+
 void SDL_SYS_WaitThread(SDL_Thread *thread)
 {
 	WaitForSingleObject(thread->handle, INFINITE);
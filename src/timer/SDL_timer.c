@@ -50,6 +50,20 @@ static SDL_TimerID SDL_timers = NULL;
 static SDL_mutex *SDL_timer_mutex;
 static volatile SDL_bool list_changed = SDL_FALSE;
 
+#if !defined(SDL_TIMER_UNIX) && !defined(SDL_TIMER_WIN32) && \
+    !defined(SDL_TIMER_VITA)
+/* No high resolution clock on this platform, count milliseconds */
+Uint64 SDL_GetPerformanceCounter(void)
+{
+	return(SDL_GetTicks());
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+	return(1000);
+}
+#endif
+
 /* Set whether or not the timer should use a thread.
    This should not be called while the timer subsystem is running.
 */
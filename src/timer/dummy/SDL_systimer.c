@@ -61,8 +61,13 @@ static int RunTimer(void *unused)
 /* This is only called if the event thread is not running */
 int SDL_SYS_TimerInit(void)
 {
+	SDL_ThreadAttr attr;
+
+	SDL_memset(&attr, 0, sizeof(attr));
+	attr.name = "SDLTimer";
+	attr.priority = SDL_THREAD_PRIORITY_HIGH;
 	timer_alive = 1;
-	timer = SDL_CreateThread(RunTimer, NULL);
+	timer = SDL_CreateThreadWithAttr(RunTimer, NULL, &attr);
 	if ( timer == NULL )
 		return(-1);
 	return(SDL_SetTimerThreaded(1));
@@ -85,6 +85,28 @@ Uint32 SDL_GetTicks (void)
 #endif
 }
 
+Uint64 SDL_GetPerformanceCounter(void)
+{
+#if HAVE_CLOCK_GETTIME
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return((Uint64)now.tv_sec*1000000000 + now.tv_nsec);
+#else
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return((Uint64)now.tv_sec*1000000 + now.tv_usec);
+#endif
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+#if HAVE_CLOCK_GETTIME
+	return(1000000000);
+#else
+	return(1000000);
+#endif
+}
+
 void SDL_Delay (Uint32 ms)
 {
 #if SDL_THREAD_PTH
@@ -208,8 +230,13 @@ static int RunTimer(void *unused)
 /* This is only called if the event thread is not running */
 int SDL_SYS_TimerInit(void)
 {
+	SDL_ThreadAttr attr;
+
+	SDL_memset(&attr, 0, sizeof(attr));
+	attr.name = "SDLTimer";
+	attr.priority = SDL_THREAD_PRIORITY_HIGH;
 	timer_alive = 1;
-	timer = SDL_CreateThread(RunTimer, NULL);
+	timer = SDL_CreateThreadWithAttr(RunTimer, NULL, &attr);
 	if ( timer == NULL )
 		return(-1);
 	return(SDL_SetTimerThreaded(1));
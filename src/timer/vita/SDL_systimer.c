@@ -54,6 +54,16 @@ Uint32 SDL_GetTicks (void)
     return (ticks);
 }
 
+Uint64 SDL_GetPerformanceCounter(void)
+{
+    return sceKernelGetProcessTimeWide();
+}
+
+Uint64 SDL_GetPerformanceFrequency(void)
+{
+    return 1000000;
+}
+
 void SDL_Delay (Uint32 ms)
 {
     const Uint32 max_delay = 0xffffffffUL / 1000;
@@ -87,8 +87,10 @@
  */
 
 #include "SDL_video.h"
+#include "SDL_thread.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_pixels_c.h"
 #include "SDL_RLEaccel_c.h"
 
 /* Force MMX to 0; this blows up on almost every major compiler now. --ryan. */
@@ -1396,6 +1398,46 @@ static int uncopy_32(Uint32 *dst, void *src, int n,
 #define ISTRANSL(pixel, fmt)	\
     ((unsigned)((((pixel) & fmt->Amask) >> fmt->Ashift) - 1U) < 254U)
 
+/*
+ * The worst case encoding can be several times the size of the surface.
+ * Small surfaces, like sprites, encode into the video scratch arena, so
+ * the only allocation is the final buffer.  Anything bigger than the
+ * arena's block, or encoded from another thread, allocates the worst
+ * case on the heap and shrinks it in place, with no copy.
+ */
+static Uint8 *RLEAllocBuffer(int maxsize, int *scratch)
+{
+    SDL_VideoDevice *video = current_video;
+
+    *scratch = 0;
+    if(video && video->scratch && video->scratch_thread == SDL_ThreadID()
+       && maxsize <= SDL_VIDEO_SCRATCH_SIZE) {
+	*scratch = 1;
+	SDL_ResetArena(video->scratch);
+	return (Uint8 *)SDL_ArenaAlloc(video->scratch, maxsize);
+    }
+    return (Uint8 *)SDL_malloc(maxsize);
+}
+
+static Uint8 *RLEFinishBuffer(Uint8 *rlebuf, int size, int scratch)
+{
+    Uint8 *p;
+
+    if(scratch) {
+	p = (Uint8 *)SDL_malloc(size);
+	if(p)
+	    SDL_memcpy(p, rlebuf, size);
+	else
+	    SDL_OutOfMemory();
+    } else {
+	/* If realloc returns NULL, the original block is left intact */
+	p = (Uint8 *)SDL_realloc(rlebuf, size);
+	if(!p)
+	    p = rlebuf;
+    }
+    return p;
+}
+
 /* convert surface to be quickly alpha-blittable onto dest, if possible */
 static int RLEAlphaSurface(SDL_Surface *surface)
 {
@@ -1406,6 +1448,7 @@ static int RLEAlphaSurface(SDL_Surface *surface)
     int max_transl_run = 65535;
     unsigned masksum;
     Uint8 *rlebuf, *dst;
+    int scratch;
     int (*copy_opaque)(void *, Uint32 *, int,
 		       SDL_PixelFormat *, SDL_PixelFormat *);
     int (*copy_transl)(void *, Uint32 *, int,
@@ -1465,7 +1508,7 @@ static int RLEAlphaSurface(SDL_Surface *surface)
     }
 
     maxsize += sizeof(RLEDestFormat);
-    rlebuf = (Uint8 *)SDL_malloc(maxsize);
+    rlebuf = RLEAllocBuffer(maxsize, &scratch);
     if(!rlebuf) {
 	SDL_OutOfMemory();
 	return -1;
@@ -1592,19 +1635,16 @@ static int RLEAlphaSurface(SDL_Surface *surface)
 #undef ADD_OPAQUE_COUNTS
 #undef ADD_TRANSL_COUNTS
 
+    /* Move the encoding into a buffer of its final size */
+    rlebuf = RLEFinishBuffer(rlebuf, dst - rlebuf, scratch);
+    if(!rlebuf)
+	return -1;
+    surface->map->sw_data->aux_data = rlebuf;
+
     /* Now that we have it encoded, release the original pixels */
     if((surface->flags & SDL_PREALLOC) != SDL_PREALLOC
        && (surface->flags & SDL_HWSURFACE) != SDL_HWSURFACE) {
-	SDL_free( surface->pixels );
-	surface->pixels = NULL;
-    }
-
-    /* realloc the buffer to release unused memory */
-    {
-	Uint8 *p = SDL_realloc(rlebuf, dst - rlebuf);
-	if(!p)
-	    p = rlebuf;
-	surface->map->sw_data->aux_data = p;
+	SDL_FreeSurfacePixels(surface);
     }
 
     return 0;
@@ -1643,6 +1683,7 @@ static getpix_func getpixes[4] = {
 static int RLEColorkeySurface(SDL_Surface *surface)
 {
         Uint8 *rlebuf, *dst;
+	int scratch;
 	int maxn;
 	int y;
 	Uint8 *srcbuf, *lastline;
@@ -1672,7 +1713,7 @@ static int RLEColorkeySurface(SDL_Surface *surface)
 	    break;
 	}
 
-	rlebuf = (Uint8 *)SDL_malloc(maxsize);
+	rlebuf = RLEAllocBuffer(maxsize, &scratch);
 	if ( rlebuf == NULL ) {
 		SDL_OutOfMemory();
 		return(-1);
@@ -1749,20 +1790,17 @@ static int RLEColorkeySurface(SDL_Surface *surface)
 
 #undef ADD_COUNTS
 
+	/* Move the encoding into a buffer of its final size */
+	rlebuf = RLEFinishBuffer(rlebuf, dst - rlebuf, scratch);
+	if ( rlebuf == NULL ) {
+	    return(-1);
+	}
+	surface->map->sw_data->aux_data = rlebuf;
+
 	/* Now that we have it encoded, release the original pixels */
 	if((surface->flags & SDL_PREALLOC) != SDL_PREALLOC
 	   && (surface->flags & SDL_HWSURFACE) != SDL_HWSURFACE) {
-	    SDL_free( surface->pixels );
-	    surface->pixels = NULL;
-	}
-
-	/* realloc the buffer to release unused memory */
-	{
-	    /* If realloc returns NULL, the original block is left intact */
-	    Uint8 *p = SDL_realloc(rlebuf, dst - rlebuf);
-	    if(!p)
-		p = rlebuf;
-	    surface->map->sw_data->aux_data = p;
+	    SDL_FreeSurfacePixels(surface);
 	}
 
 	return(0);
@@ -1840,8 +1878,7 @@ static SDL_bool UnRLEAlpha(SDL_Surface *surface)
 	uncopy_opaque = uncopy_transl = uncopy_32;
     }
 
-    surface->pixels = SDL_malloc(surface->h * surface->pitch);
-    if ( !surface->pixels ) {
+    if ( SDL_AllocSurfacePixels(surface) < 0 ) {
         return(SDL_FALSE);
     }
     /* fill background with transparent pixels */
@@ -1904,8 +1941,7 @@ void SDL_UnRLESurface(SDL_Surface *surface, int recode)
 		unsigned alpha_flag;
 
 		/* re-create the original surface */
-		surface->pixels = SDL_malloc(surface->h * surface->pitch);
-		if ( !surface->pixels ) {
+		if ( SDL_AllocSurfacePixels(surface) < 0 ) {
 			/* Oh crap... */
 			surface->flags |= SDL_RLEACCEL;
 			return;
@@ -40,7 +40,7 @@
 #endif
 
 /* The general purpose software blit routine */
-static int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
 			SDL_Surface *dst, SDL_Rect *dstrect)
 {
 	int okay;
@@ -239,6 +239,7 @@ int SDL_CalculateBlit(SDL_Surface *surface)
 		SDL_UnRLESurface(surface, 1);
 	}
 	surface->map->sw_blit = NULL;
+	surface->map->sw_data->name = NULL;
 
 	/* Figure out if an accelerated hardware blit is possible */
 	surface->flags &= ~SDL_HWACCEL;
@@ -302,11 +303,13 @@ int SDL_CalculateBlit(SDL_Surface *surface)
 
 	/* Check for special "identity" case -- copy blit */
 	if ( surface->map->identity && blit_index == 0 ) {
-	        surface->map->sw_data->blit = SDL_BlitCopy;
+	        surface->map->sw_data->blit =
+			SDL_BLITTER(surface, SDL_BlitCopy);
 
 		/* Handle overlapping blits on the same surface */
 		if ( surface == surface->map->dst ) {
-		        surface->map->sw_data->blit = SDL_BlitCopyOverlap;
+		        surface->map->sw_data->blit =
+				SDL_BLITTER(surface, SDL_BlitCopyOverlap);
 		}
 	} else {
 		if ( surface->format->BitsPerPixel < 8 ) {
@@ -355,6 +358,11 @@ int SDL_CalculateBlit(SDL_Surface *surface)
 	if ( surface->map->sw_blit == NULL ) {
 		surface->map->sw_blit = SDL_SoftBlit;
 	}
+
+	/* Count the blits and time spent if asked to */
+	if ( SDL_blitstats_enabled ) {
+		SDL_ProfileBlit(surface);
+	}
 	return(0);
 }
 
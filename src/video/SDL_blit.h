@@ -28,6 +28,8 @@
 
 extern SDL_bool SDL_HasARMSIMD(void);		/* whether CPU has ARM SIMD (ARMv6) features */
 extern SDL_bool SDL_HasNEON (void);		/* whether CPU has ARM NEON features.        */
+extern SDL_bool SDL_HasAVX2(void);		/* whether CPU and OS support AVX2           */
+extern SDL_bool SDL_HasAVX512VBMI(void);	/* whether CPU and OS support AVX-512 VBMI   */
 
 /* The structure passed to the low level blit functions */
 typedef struct {
@@ -52,6 +54,12 @@ typedef void (*SDL_loblit)(SDL_BlitInfo *info);
 struct private_swaccel {
 	SDL_loblit blit;
 	void *aux_data;
+
+	/* the name of 'blit', and the counters and real sw_blit used while
+	   blits are profiled (see SDL_EnableBlitStats) */
+	const char *name;
+	SDL_BlitStats *stats;
+	SDL_blit profiled_blit;
 };
 
 /* Blit mapping definition */
@@ -67,11 +75,30 @@ typedef struct SDL_BlitMap {
 	/* the version count matches the destination; mismatch indicates
 	   an invalid mapping */
         unsigned int format_version;
+
+	/* the data source holding the surface's preallocated pixels,
+	   closed when the surface is freed (see SDL_LoadSRF_RW) */
+	SDL_RWops *pixels_src;
+
+	/* the surface pixels, if they came from the pixel pool */
+	void *pool_pixels;
+	size_t pool_size;
 } SDL_BlitMap;
 
 
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface *surface);
+extern int SDL_SoftBlit(SDL_Surface *src, SDL_Rect *srcrect,
+			SDL_Surface *dst, SDL_Rect *dstrect);
+
+/* Functions found in SDL_blitstats.c */
+extern int SDL_blitstats_enabled;
+extern void SDL_ProfileBlit(SDL_Surface *surface);
+extern void SDL_DumpBlitStats(void);
+
+/* Remember the name of the blitter chosen for a surface */
+#define SDL_BLITTER(surface, blit)					\
+	((surface)->map->sw_data->name = #blit, (blit))
 
 /* Functions found in SDL_blit_{0,1,N,A}.c */
 extern SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int complex);
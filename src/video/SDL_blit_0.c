@@ -440,6 +440,14 @@ static SDL_loblit colorkey_blit[] = {
     NULL, BlitBto1Key, BlitBto2Key, BlitBto3Key, BlitBto4Key
 };
 
+static const char *bitmap_blit_name[] = {
+	NULL, "BlitBto1", "BlitBto2", "BlitBto3", "BlitBto4"
+};
+
+static const char *colorkey_blit_name[] = {
+	NULL, "BlitBto1Key", "BlitBto2Key", "BlitBto3Key", "BlitBto4Key"
+};
+
 SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int blit_index)
 {
 	int which;
@@ -455,16 +463,18 @@ SDL_loblit SDL_CalculateBlit0(SDL_Surface *surface, int blit_index)
 	}
 	switch(blit_index) {
 	case 0:			/* copy */
+	    surface->map->sw_data->name = bitmap_blit_name[which];
 	    return bitmap_blit[which];
 
 	case 1:			/* colorkey */
+	    surface->map->sw_data->name = colorkey_blit_name[which];
 	    return colorkey_blit[which];
 
 	case 2:			/* alpha */
-	    return which >= 2 ? BlitBtoNAlpha : NULL;
+	    return which >= 2 ? SDL_BLITTER(surface, BlitBtoNAlpha) : NULL;
 
 	case 4:			/* alpha + colorkey */
-	    return which >= 2 ? BlitBtoNAlphaKey : NULL;
+	    return which >= 2 ? SDL_BLITTER(surface, BlitBtoNAlphaKey) : NULL;
 	}
 	return NULL;
 }
@@ -491,6 +491,14 @@ static SDL_loblit one_blitkey[] = {
         NULL, Blit1to1Key, Blit1to2Key, Blit1to3Key, Blit1to4Key
 };
 
+static const char *one_blit_name[] = {
+	NULL, "Blit1to1", "Blit1to2", "Blit1to3", "Blit1to4"
+};
+
+static const char *one_blitkey_name[] = {
+        NULL, "Blit1to1Key", "Blit1to2Key", "Blit1to3Key", "Blit1to4Key"
+};
+
 SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int blit_index)
 {
 	int which;
@@ -504,19 +512,21 @@ SDL_loblit SDL_CalculateBlit1(SDL_Surface *surface, int blit_index)
 	}
 	switch(blit_index) {
 	case 0:			/* copy */
+	    surface->map->sw_data->name = one_blit_name[which];
 	    return one_blit[which];
 
 	case 1:			/* colorkey */
+	    surface->map->sw_data->name = one_blitkey_name[which];
 	    return one_blitkey[which];
 
 	case 2:			/* alpha */
 	    /* Supporting 8bpp->8bpp alpha is doable but requires lots of
 	       tables which consume space and takes time to precompute,
 	       so is better left to the user */
-	    return which >= 2 ? Blit1toNAlpha : NULL;
+	    return which >= 2 ? SDL_BLITTER(surface, Blit1toNAlpha) : NULL;
 
 	case 3:			/* alpha + colorkey */
-	    return which >= 2 ? Blit1toNAlphaKey : NULL;
+	    return which >= 2 ? SDL_BLITTER(surface, Blit1toNAlphaKey) : NULL;
 
 	}
 	return NULL;
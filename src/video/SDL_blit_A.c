@@ -2788,20 +2788,20 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
     if(sf->Amask == 0) {
 	if((surface->flags & SDL_SRCCOLORKEY) == SDL_SRCCOLORKEY) {
 	    if(df->BytesPerPixel == 1)
-		return BlitNto1SurfaceAlphaKey;
+		return SDL_BLITTER(surface, BlitNto1SurfaceAlphaKey);
 	    else
 #if SDL_ALTIVEC_BLITTERS
 	if (sf->BytesPerPixel == 4 && df->BytesPerPixel == 4 &&
 	    !(surface->map->dst->flags & SDL_HWSURFACE) && SDL_HasAltiVec())
-            return Blit32to32SurfaceAlphaKeyAltivec;
+            return SDL_BLITTER(surface, Blit32to32SurfaceAlphaKeyAltivec);
         else
 #endif
-            return BlitNtoNSurfaceAlphaKey;
+            return SDL_BLITTER(surface, BlitNtoNSurfaceAlphaKey);
 	} else {
 	    /* Per-surface alpha blits */
 	    switch(df->BytesPerPixel) {
 	    case 1:
-		return BlitNto1SurfaceAlpha;
+		return SDL_BLITTER(surface, BlitNto1SurfaceAlpha);
 
 	    case 2:
 		if(surface->map->identity) {
@@ -2809,22 +2809,22 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 		    {
 #if MMX_ASMBLIT
 		if(SDL_HasMMX())
-			return Blit565to565SurfaceAlphaMMX;
+			return SDL_BLITTER(surface, Blit565to565SurfaceAlphaMMX);
 		else
 #endif
-			return Blit565to565SurfaceAlpha;
+			return SDL_BLITTER(surface, Blit565to565SurfaceAlpha);
 		    }
 		    else if(df->Gmask == 0x3e0)
 		    {
 #if MMX_ASMBLIT
 		if(SDL_HasMMX())
-			return Blit555to555SurfaceAlphaMMX;
+			return SDL_BLITTER(surface, Blit555to555SurfaceAlphaMMX);
 		else
 #endif
-			return Blit555to555SurfaceAlpha;
+			return SDL_BLITTER(surface, Blit555to555SurfaceAlpha);
 		    }
 		}
-		return BlitNtoNSurfaceAlpha;
+		return SDL_BLITTER(surface, BlitNtoNSurfaceAlpha);
 
 	    case 4:
 		if(sf->Rmask == df->Rmask
@@ -2837,43 +2837,43 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 			   && sf->Gshift % 8 == 0
 			   && sf->Bshift % 8 == 0
 			   && SDL_HasMMX())
-			    return BlitRGBtoRGBSurfaceAlphaMMX;
+			    return SDL_BLITTER(surface, BlitRGBtoRGBSurfaceAlphaMMX);
 #endif
 			if((sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff)
 			{
 #if SDL_ALTIVEC_BLITTERS
 				if(!(surface->map->dst->flags & SDL_HWSURFACE)
 					&& SDL_HasAltiVec())
-					return BlitRGBtoRGBSurfaceAlphaAltivec;
+					return SDL_BLITTER(surface, BlitRGBtoRGBSurfaceAlphaAltivec);
 #endif
-				return BlitRGBtoRGBSurfaceAlpha;
+				return SDL_BLITTER(surface, BlitRGBtoRGBSurfaceAlpha);
 			}
 		}
 #if SDL_ALTIVEC_BLITTERS
 		if((sf->BytesPerPixel == 4) &&
 		   !(surface->map->dst->flags & SDL_HWSURFACE) && SDL_HasAltiVec())
-			return Blit32to32SurfaceAlphaAltivec;
+			return SDL_BLITTER(surface, Blit32to32SurfaceAlphaAltivec);
 		else
 #endif
-			return BlitNtoNSurfaceAlpha;
+			return SDL_BLITTER(surface, BlitNtoNSurfaceAlpha);
 
 	    case 3:
 	    default:
-		return BlitNtoNSurfaceAlpha;
+		return SDL_BLITTER(surface, BlitNtoNSurfaceAlpha);
 	    }
 	}
     } else {
 	/* Per-pixel alpha blits */
 	switch(df->BytesPerPixel) {
 	case 1:
-	    return BlitNto1PixelAlpha;
+	    return SDL_BLITTER(surface, BlitNto1PixelAlpha);
 
 	case 2:
 #if SDL_ALTIVEC_BLITTERS
 	if(sf->BytesPerPixel == 4 && !(surface->map->dst->flags & SDL_HWSURFACE) &&
            df->Gmask == 0x7e0 &&
 	   df->Bmask == 0x1f && SDL_HasAltiVec())
-            return Blit32to565PixelAlphaAltivec;
+            return SDL_BLITTER(surface, Blit32to565PixelAlphaAltivec);
         else
 #endif
 #if SDL_ARM_NEON_BLITTERS || SDL_ARM_SIMD_BLITTERS
@@ -2884,11 +2884,11 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 		{
 #if SDL_ARM_NEON_BLITTERS
 		    if(SDL_HasNEON())
-		        return BlitARGBto565PixelAlphaARMNEON;
+		        return SDL_BLITTER(surface, BlitARGBto565PixelAlphaARMNEON);
 #endif
 #if SDL_ARM_SIMD_BLITTERS
 		    if(SDL_HasARMSIMD())
-		        return BlitARGBto565PixelAlphaARMSIMD;
+		        return SDL_BLITTER(surface, BlitARGBto565PixelAlphaARMSIMD);
 #endif
 		}
 #endif
@@ -2897,11 +2897,11 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 	       && ((sf->Rmask == 0xff && df->Rmask == 0x1f)
 		   || (sf->Bmask == 0xff && df->Bmask == 0x1f))) {
 		if(df->Gmask == 0x7e0)
-		    return BlitARGBto565PixelAlpha;
+		    return SDL_BLITTER(surface, BlitARGBto565PixelAlpha);
 		else if(df->Gmask == 0x3e0)
-		    return BlitARGBto555PixelAlpha;
+		    return SDL_BLITTER(surface, BlitARGBto555PixelAlpha);
 	    }
-	    return BlitNtoNPixelAlpha;
+	    return SDL_BLITTER(surface, BlitNtoNPixelAlpha);
 
 	case 4:
 	    if(sf->Rmask == df->Rmask
@@ -2917,9 +2917,9 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 		   && sf->Aloss == 0)
 		{
 			if(SDL_Has3DNow())
-				return BlitRGBtoRGBPixelAlphaMMX3DNOW;
+				return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlphaMMX3DNOW);
 			if(SDL_HasMMX())
-				return BlitRGBtoRGBPixelAlphaMMX;
+				return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlphaMMX);
 		}
 #endif
 		if(sf->Amask == 0xff000000)
@@ -2927,30 +2927,30 @@ SDL_loblit SDL_CalculateAlphaBlit(SDL_Surface *surface, int blit_index)
 #if SDL_ALTIVEC_BLITTERS
 			if(!(surface->map->dst->flags & SDL_HWSURFACE)
 				&& SDL_HasAltiVec())
-				return BlitRGBtoRGBPixelAlphaAltivec;
+				return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlphaAltivec);
 #endif
 #if SDL_ARM_NEON_BLITTERS
 			if (SDL_HasNEON())
-				return BlitRGBtoRGBPixelAlphaARMNEON;
+				return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlphaARMNEON);
 #endif
 #if SDL_ARM_SIMD_BLITTERS
 			if (SDL_HasARMSIMD())
-				return BlitRGBtoRGBPixelAlphaARMSIMD;
+				return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlphaARMSIMD);
 #endif
-			return BlitRGBtoRGBPixelAlpha;
+			return SDL_BLITTER(surface, BlitRGBtoRGBPixelAlpha);
 		}
 	    }
 #if SDL_ALTIVEC_BLITTERS
 	    if (sf->Amask && sf->BytesPerPixel == 4 &&
 	        !(surface->map->dst->flags & SDL_HWSURFACE) && SDL_HasAltiVec())
-		return Blit32to32PixelAlphaAltivec;
+		return SDL_BLITTER(surface, Blit32to32PixelAlphaAltivec);
 	    else
 #endif
-		return BlitNtoNPixelAlpha;
+		return SDL_BLITTER(surface, BlitNtoNPixelAlpha);
 
 	case 3:
 	default:
-	    return BlitNtoNPixelAlpha;
+	    return SDL_BLITTER(surface, BlitNtoNPixelAlpha);
 	}
     }
 }
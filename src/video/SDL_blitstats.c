@@ -0,0 +1,266 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Counters for finding out which blitters are used, and how fast */
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+
+#include "SDL_video.h"
+#include "SDL_timer.h"
+#include "SDL_atomic.h"
+#include "SDL_blit.h"
+#include "SDL_RLEaccel_c.h"
+
+/* The counters aren't freed while surfaces may point at them, so they
+   live in a fixed table.  Blits that don't fit aren't counted.  Blit
+   mappings can be set up from several threads at once, so the table
+   is only looked at or grown with blitstats_lock held.
+ */
+#define MAX_BLITSTATS	1024
+
+static SDL_BlitStats blitstats[MAX_BLITSTATS];
+static int num_blitstats = 0;
+static SDL_SpinLock blitstats_lock;
+
+/* -1 until the SDL_BLIT_STATS environment variable has been checked */
+int SDL_blitstats_enabled = -1;
+static int blitstats_dump = 0;
+
+static void SDL_CheckBlitStatsEnv(void)
+{
+	if ( SDL_blitstats_enabled < 0 ) {
+		const char *env = SDL_getenv("SDL_BLIT_STATS");
+		if ( env && *env && (*env != '0') ) {
+			SDL_blitstats_enabled = 1;
+			blitstats_dump = 1;
+		} else {
+			SDL_blitstats_enabled = 0;
+		}
+	}
+}
+
+/* Find the counters for a blitter and pair of formats, or add them.
+   Called with blitstats_lock held.
+ */
+static SDL_BlitStats *SDL_FindBlitStats(const char *blitter, Uint32 flags,
+			SDL_PixelFormat *src, SDL_PixelFormat *dst)
+{
+	SDL_BlitStats *stats;
+	int i;
+
+	for ( i=0; i<num_blitstats; ++i ) {
+		stats = &blitstats[i];
+		if ( (SDL_strcmp(stats->blitter, blitter) == 0) &&
+		     (stats->flags == flags) &&
+		     (stats->src_bpp == src->BitsPerPixel) &&
+		     (stats->src_Rmask == src->Rmask) &&
+		     (stats->src_Gmask == src->Gmask) &&
+		     (stats->src_Bmask == src->Bmask) &&
+		     (stats->src_Amask == src->Amask) &&
+		     (stats->dst_bpp == dst->BitsPerPixel) &&
+		     (stats->dst_Rmask == dst->Rmask) &&
+		     (stats->dst_Gmask == dst->Gmask) &&
+		     (stats->dst_Bmask == dst->Bmask) &&
+		     (stats->dst_Amask == dst->Amask) ) {
+			return(stats);
+		}
+	}
+	if ( num_blitstats == MAX_BLITSTATS ) {
+		return(NULL);
+	}
+	stats = &blitstats[num_blitstats++];
+	SDL_memset(stats, 0, sizeof(*stats));
+	stats->blitter = blitter;
+	stats->flags = flags;
+	stats->src_bpp = src->BitsPerPixel;
+	stats->src_Rmask = src->Rmask;
+	stats->src_Gmask = src->Gmask;
+	stats->src_Bmask = src->Bmask;
+	stats->src_Amask = src->Amask;
+	stats->dst_bpp = dst->BitsPerPixel;
+	stats->dst_Rmask = dst->Rmask;
+	stats->dst_Gmask = dst->Gmask;
+	stats->dst_Bmask = dst->Bmask;
+	stats->dst_Amask = dst->Amask;
+	return(stats);
+}
+
+/* Runs the real software blit and counts it */
+static int SDL_ProfiledBlit(SDL_Surface *src, SDL_Rect *srcrect,
+				SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	struct private_swaccel *sdata = src->map->sw_data;
+	SDL_BlitStats *stats = sdata->stats;
+	int retval;
+#if !SDL_TIMERS_DISABLED
+	Uint64 start;
+#endif
+
+	if ( ! SDL_blitstats_enabled ) {
+		/* Counting was turned off, go back to the real blit */
+		src->map->sw_blit = sdata->profiled_blit;
+		sdata->stats = NULL;
+		return(sdata->profiled_blit(src, srcrect, dst, dstrect));
+	}
+	stats->calls++;
+	stats->pixels += (Uint32)srcrect->w * srcrect->h;
+#if SDL_TIMERS_DISABLED
+	retval = sdata->profiled_blit(src, srcrect, dst, dstrect);
+#else
+	start = SDL_GetPerformanceCounter();
+	retval = sdata->profiled_blit(src, srcrect, dst, dstrect);
+	stats->time += SDL_GetPerformanceCounter() - start;
+#endif
+	return(retval);
+}
+
+/* Called by SDL_CalculateBlit() once the blitter has been chosen */
+void SDL_ProfileBlit(SDL_Surface *surface)
+{
+	SDL_BlitMap *map = surface->map;
+	const char *blitter;
+
+	SDL_CheckBlitStatsEnv();
+	if ( ! SDL_blitstats_enabled ) {
+		return;
+	}
+
+	/* RLE blits don't go through the low level blitter at all */
+	if ( map->sw_blit == SDL_RLEBlit ) {
+		blitter = "SDL_RLEBlit";
+	} else if ( map->sw_blit == SDL_RLEAlphaBlit ) {
+		blitter = "SDL_RLEAlphaBlit";
+	} else if ( map->sw_data->name ) {
+		blitter = map->sw_data->name;
+	} else {
+		blitter = "unknown";
+	}
+	SDL_AtomicLock(&blitstats_lock);
+	map->sw_data->stats = SDL_FindBlitStats(blitter,
+		surface->flags & (SDL_SRCCOLORKEY|SDL_SRCALPHA|SDL_RLEACCEL),
+		surface->format, map->dst->format);
+	SDL_AtomicUnlock(&blitstats_lock);
+	if ( map->sw_data->stats ) {
+		map->sw_data->profiled_blit = map->sw_blit;
+		map->sw_blit = SDL_ProfiledBlit;
+	}
+}
+
+int SDL_EnableBlitStats(int enable)
+{
+	int enabled;
+
+	SDL_CheckBlitStatsEnv();
+	enabled = SDL_blitstats_enabled;
+	if ( enable >= 0 ) {
+		SDL_blitstats_enabled = enable ? 1 : 0;
+	}
+	return(enabled);
+}
+
+int SDL_GetBlitStats(SDL_BlitStats *stats, int maxstats)
+{
+	int numstats;
+
+	SDL_AtomicLock(&blitstats_lock);
+	numstats = num_blitstats;
+	if ( stats ) {
+		if ( maxstats > numstats ) {
+			maxstats = numstats;
+		}
+		if ( maxstats > 0 ) {
+			SDL_memcpy(stats, blitstats, maxstats*sizeof(*stats));
+		}
+	}
+	SDL_AtomicUnlock(&blitstats_lock);
+	return(numstats);
+}
+
+void SDL_ResetBlitStats(void)
+{
+	int i;
+
+	SDL_AtomicLock(&blitstats_lock);
+	for ( i=0; i<num_blitstats; ++i ) {
+		blitstats[i].calls = 0;
+		blitstats[i].pixels = 0;
+		blitstats[i].time = 0;
+	}
+	SDL_AtomicUnlock(&blitstats_lock);
+}
+
+/* Called by SDL_Quit() to print the counters for SDL_BLIT_STATS */
+void SDL_DumpBlitStats(void)
+{
+#ifdef HAVE_STDIO_H
+	SDL_BlitStats *stats;
+	double usecs, freq;
+	char flags[4], *flag;
+	int i;
+
+	if ( ! blitstats_dump || ! num_blitstats ) {
+		return;
+	}
+#if SDL_TIMERS_DISABLED
+	freq = 0.0;
+#else
+	freq = (double)(Sint64)SDL_GetPerformanceFrequency();
+#endif
+
+	fprintf(stderr, "SDL blit stats:\n");
+	fprintf(stderr, "%-32s %-38s %-38s %-5s %10s %14s %12s %8s\n",
+		"blitter", "source", "destination", "flags",
+		"calls", "pixels", "usecs", "Mpix/s");
+	for ( i=0; i<num_blitstats; ++i ) {
+		stats = &blitstats[i];
+		if ( ! stats->calls ) {
+			continue;
+		}
+		flag = flags;
+		if ( stats->flags & SDL_SRCCOLORKEY ) {
+			*flag++ = 'C';
+		}
+		if ( stats->flags & SDL_SRCALPHA ) {
+			*flag++ = 'A';
+		}
+		if ( stats->flags & SDL_RLEACCEL ) {
+			*flag++ = 'R';
+		}
+		if ( flag == flags ) {
+			*flag++ = '-';
+		}
+		*flag = '\0';
+		usecs = freq ? ((double)(Sint64)stats->time * 1000000.0) / freq : 0.0;
+		fprintf(stderr, "%-32s %2d:%08x:%08x:%08x:%08x %2d:%08x:%08x:%08x:%08x %-5s %10u %14.0f %12.0f %8.1f\n",
+			stats->blitter,
+			stats->src_bpp, stats->src_Rmask, stats->src_Gmask,
+			stats->src_Bmask, stats->src_Amask,
+			stats->dst_bpp, stats->dst_Rmask, stats->dst_Gmask,
+			stats->dst_Bmask, stats->dst_Amask,
+			flags, stats->calls, (double)(Sint64)stats->pixels,
+			usecs, usecs ? (double)(Sint64)stats->pixels / usecs : 0.0);
+	}
+#endif /* HAVE_STDIO_H */
+}
@@ -58,6 +58,7 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 	SDL_Palette *palette;
 	Uint8 *bits;
 	Uint8 *top, *end;
+	Uint8 *mem, *memstart;
 	SDL_bool topDown;
 	int ExpandBMP;
 
@@ -89,6 +90,22 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 		goto done;
 	}
 
+	/* The palette and 1 and 4 bit pixels are read a byte at a time */
+	switch (src->type) {
+	    case SDL_RWOPS_UNKNOWN:
+	    case SDL_RWOPS_WINFILE:
+	    case SDL_RWOPS_STDFILE: {
+		SDL_RWops *buffered = SDL_RWFromBufferedRW(src, 0, freesrc);
+		if ( buffered ) {
+			src = buffered;
+			freesrc = 1;
+		}
+	    }
+		break;
+	    default:
+		break;
+	}
+
 	/* Read in the BMP file header */
 	fp_offset = SDL_RWtell(src);
 	SDL_ClearError();
@@ -297,6 +314,19 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 	} else {
 		bits = end - surface->pitch;
 	}
+
+	/* Decode straight from memory if the whole image is there */
+	{
+		size_t avail;
+		int rowsize = ExpandBMP ? bmpPitch : surface->pitch;
+
+		mem = (Uint8 *)SDL_RWborrow(src, &avail, 0);
+		if ( mem && (avail/(rowsize+pad) < (size_t)surface->h) ) {
+			mem = NULL;
+		}
+		memstart = mem;
+	}
+
 	while ( bits >= top && bits < end ) {
 		switch (ExpandBMP) {
 			case 1:
@@ -305,7 +335,9 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			int   shift = (8-ExpandBMP);
 			for ( i=0; i<surface->w; ++i ) {
 				if ( i%(8/ExpandBMP) == 0 ) {
-					if ( !SDL_RWread(src, &pixel, 1, 1) ) {
+					if ( mem ) {
+						pixel = *mem++;
+					} else if ( !SDL_RWread(src, &pixel, 1, 1) ) {
 						SDL_SetError(
 					"Error reading from BMP");
 						was_error = SDL_TRUE;
@@ -324,7 +356,10 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			break;
 
 			default:
-			if ( SDL_RWread(src, bits, 1, surface->pitch)
+			if ( mem ) {
+				SDL_memcpy(bits, mem, surface->pitch);
+				mem += surface->pitch;
+			} else if ( SDL_RWread(src, bits, 1, surface->pitch)
 							 != surface->pitch ) {
 				SDL_Error(SDL_EFREAD);
 				was_error = SDL_TRUE;
@@ -363,7 +398,9 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			break;
 		}
 		/* Skip padding bytes, ugh */
-		if ( pad ) {
+		if ( mem ) {
+			mem += pad;
+		} else if ( pad ) {
 			Uint8 padbyte;
 			for ( i=0; i<pad; ++i ) {
 				SDL_RWread(src, &padbyte, 1, 1);
@@ -375,6 +412,10 @@ SDL_Surface * SDL_LoadBMP_RW (SDL_RWops *src, int freesrc)
 			bits -= surface->pitch;
 		}
 	}
+	if ( memstart ) {
+		/* Leave the source after the image, as if it had been read */
+		SDL_RWseek64(src, mem-memstart, RW_SEEK_CUR);
+	}
 done:
 	if ( was_error ) {
 		if ( src ) {
@@ -40,6 +40,90 @@ SDL_Cursor *SDL_cursor = NULL;
 static SDL_Cursor *SDL_defcursor = NULL;
 SDL_mutex *SDL_cursorlock = NULL;
 
+/* The software cursor image, cached in the format of the screen.
+   SDL_Cursor is part of the 1.2 ABI and can't grow, so the images are
+   kept in a list of their own and looked up by cursor.
+ */
+struct SDL_CursorImage {
+	SDL_Cursor *cursor;		/* The cursor this is the image of */
+	SDL_Surface *argb;		/* Colour cursor image, NULL if B/W */
+	SDL_Surface *sprite[2];		/* For the video and shadow surface */
+	Uint32 palette_version[2];	/* Palette the sprites were built with */
+	struct SDL_CursorImage *next;
+};
+static struct SDL_CursorImage *SDL_cursorimages = NULL;
+
+/* Add an image for a new cursor, which then owns 'argb' */
+static int SDL_AddCursorImage(SDL_Cursor *cursor, SDL_Surface *argb)
+{
+	struct SDL_CursorImage *image;
+
+	image = (struct SDL_CursorImage *)SDL_malloc(sizeof *image);
+	if ( image == NULL ) {
+		return(-1);
+	}
+	SDL_memset(image, 0, sizeof *image);
+	image->cursor = cursor;
+	image->argb = argb;
+	SDL_LockCursor();
+	image->next = SDL_cursorimages;
+	SDL_cursorimages = image;
+	SDL_UnlockCursor();
+	return(0);
+}
+
+/* Called with the cursor locked */
+static struct SDL_CursorImage *SDL_FindCursorImage(SDL_Cursor *cursor)
+{
+	struct SDL_CursorImage *image;
+
+	for ( image=SDL_cursorimages; image; image=image->next ) {
+		if ( image->cursor == cursor ) {
+			break;
+		}
+	}
+	return(image);
+}
+
+static void SDL_FreeCursorSprites(struct SDL_CursorImage *image)
+{
+	int i;
+
+	for ( i=0; i<SDL_arraysize(image->sprite); ++i ) {
+		if ( image->sprite[i] ) {
+			SDL_FreeSurface(image->sprite[i]);
+			image->sprite[i] = NULL;
+		}
+	}
+}
+
+static void SDL_FreeCursorImage(SDL_Cursor *cursor)
+{
+	struct SDL_CursorImage *image, *prev;
+
+	SDL_LockCursor();
+	prev = NULL;
+	for ( image=SDL_cursorimages; image; image=image->next ) {
+		if ( image->cursor == cursor ) {
+			if ( prev ) {
+				prev->next = image->next;
+			} else {
+				SDL_cursorimages = image->next;
+			}
+			break;
+		}
+		prev = image;
+	}
+	SDL_UnlockCursor();
+	if ( image ) {
+		SDL_FreeCursorSprites(image);
+		if ( image->argb ) {
+			SDL_FreeSurface(image->argb);
+		}
+		SDL_free(image);
+	}
+}
+
 /* Public functions */
 void SDL_CursorQuit(void)
 {
@@ -140,7 +224,8 @@ SDL_Cursor * SDL_CreateCursor (Uint8 *data, Uint8 *mask,
 	cursor->save[0] = (Uint8 *)SDL_malloc(savelen*2);
 	cursor->save[1] = cursor->save[0] + savelen;
 	cursor->wm_cursor = NULL;
-	if ( ! cursor->data || ! cursor->save[0] ) {
+	if ( ! cursor->data || ! cursor->save[0] ||
+	     (SDL_AddCursorImage(cursor, NULL) < 0) ) {
 		SDL_FreeCursor(cursor);
 		SDL_OutOfMemory();
 		return(NULL);
@@ -161,6 +246,67 @@ SDL_Cursor * SDL_CreateCursor (Uint8 *data, Uint8 *mask,
 	return(cursor);
 }
 
+SDL_Cursor * SDL_CreateColorCursor (SDL_Surface *surface,
+						int hot_x, int hot_y)
+{
+	SDL_PixelFormat *format;
+	SDL_Surface *argb;
+	SDL_Cursor *cursor;
+	int savelen;
+
+	if ( surface == NULL ) {
+		SDL_SetError("Passed a NULL cursor surface");
+		return(NULL);
+	}
+
+	/* Sanity check the hot spot */
+	if ( (hot_x < 0) || (hot_y < 0) ||
+	     (hot_x >= surface->w) || (hot_y >= surface->h) ) {
+		SDL_SetError("Cursor hot spot doesn't lie within cursor");
+		return(NULL);
+	}
+
+	/* Keep an ARGB copy of the image, colorkeys become alpha */
+	format = SDL_AllocFormat(32, 0x00FF0000, 0x0000FF00,
+					0x000000FF, 0xFF000000);
+	if ( format == NULL ) {
+		return(NULL);
+	}
+	argb = SDL_ConvertSurface(surface, format, SDL_SWSURFACE);
+	SDL_FreeFormat(format);
+	if ( argb == NULL ) {
+		return(NULL);
+	}
+
+	/* Allocate memory for the cursor */
+	cursor = (SDL_Cursor *)SDL_malloc(sizeof *cursor);
+	if ( cursor == NULL ) {
+		SDL_FreeSurface(argb);
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	savelen = (argb->w*4)*argb->h;
+	cursor->area.x = 0;
+	cursor->area.y = 0;
+	cursor->area.w = argb->w;
+	cursor->area.h = argb->h;
+	cursor->hot_x = hot_x;
+	cursor->hot_y = hot_y;
+	cursor->data = NULL;
+	cursor->mask = NULL;
+	cursor->save[0] = (Uint8 *)SDL_malloc(savelen*2);
+	cursor->save[1] = cursor->save[0] + savelen;
+	cursor->wm_cursor = NULL;	/* Colour cursors are always software */
+	if ( ! cursor->save[0] || (SDL_AddCursorImage(cursor, argb) < 0) ) {
+		SDL_FreeSurface(argb);
+		SDL_FreeCursor(cursor);
+		SDL_OutOfMemory();
+		return(NULL);
+	}
+	SDL_memset(cursor->save[0], 0, savelen*2);
+	return(cursor);
+}
+
 /* SDL_SetCursor(NULL) can be used to force the cursor redraw,
    if this is desired for any reason.  This is used when setting
    the video mode and when the SDL window gains the mouse focus.
@@ -252,6 +398,7 @@ void SDL_FreeCursor (SDL_Cursor *cursor)
 			if ( cursor->save[0] ) {
 				SDL_free(cursor->save[0]);
 			}
+			SDL_FreeCursorImage(cursor);
 			if ( video && cursor->wm_cursor ) {
 				if ( video->FreeWMCursor ) {
 					video->FreeWMCursor(this, cursor->wm_cursor);
@@ -336,13 +483,12 @@ void SDL_MoveCursor(int x, int y)
 	}
 }
 
-/* Keep track of the current cursor colors */
-static int palette_changed = 1;
-static Uint8 pixels8[2];
+/* Keep track of palette changes, B/W cursors are drawn using the palette */
+static Uint32 palette_version = 0;
 
 void SDL_CursorPaletteChanged(void)
 {
-	palette_changed = 1;
+	++palette_version;
 }
 
 void SDL_MouseRect(SDL_Rect *area)
@@ -368,194 +514,152 @@ void SDL_MouseRect(SDL_Rect *area)
 	}
 }
 
-static void SDL_DrawCursorFast(SDL_Surface *screen, SDL_Rect *area)
+/* Expand the B/W cursor into a colorkeyed surface in the screen format.
+   Masked out pixels get a key that's neither white nor black, so the
+   RLE encoder turns them into skips.
+ */
+static SDL_Surface *SDL_CreateMonoSprite(SDL_Cursor *cursor,
+						SDL_PixelFormat *fmt)
 {
-	const Uint32 pixels[2] = { 0xFFFFFFFF, 0x00000000 };
-	int i, w, h;
-	Uint8 *data, datab;
-	Uint8 *mask, maskb;
-
-	data = SDL_cursor->data + area->y * SDL_cursor->area.w/8;
-	mask = SDL_cursor->mask + area->y * SDL_cursor->area.w/8;
-	switch (screen->format->BytesPerPixel) {
-
-	    case 1: {
-		Uint8 *dst;
-		int dstskip;
-
-		if ( palette_changed ) {
-			pixels8[0] = (Uint8)SDL_MapRGB(screen->format, 255, 255, 255);
-			pixels8[1] = (Uint8)SDL_MapRGB(screen->format, 0, 0, 0);
-			palette_changed = 0;
-		}
-		dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
-                       SDL_cursor->area.x;
-		dstskip = screen->pitch-area->w;
-
-		for ( h=area->h; h; h-- ) {
-			for ( w=area->w/8; w; w-- ) {
-				maskb = *mask++;
-				datab = *data++;
-				for ( i=0; i<8; ++i ) {
-					if ( maskb & 0x80 ) {
-						*dst = pixels8[datab>>7];
-					}
-					maskb <<= 1;
-					datab <<= 1;
-					dst++;
-				}
-			}
-			dst += dstskip;
-		}
-	    }
-	    break;
-
-	    case 2: {
-		Uint16 *dst;
-		int dstskip;
-
-		dst = (Uint16 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch/2 +
-                       SDL_cursor->area.x;
-		dstskip = (screen->pitch/2)-area->w;
-
-		for ( h=area->h; h; h-- ) {
-			for ( w=area->w/8; w; w-- ) {
-				maskb = *mask++;
-				datab = *data++;
-				for ( i=0; i<8; ++i ) {
-					if ( maskb & 0x80 ) {
-						*dst = (Uint16)pixels[datab>>7];
-					}
-					maskb <<= 1;
-					datab <<= 1;
-					dst++;
-				}
-			}
-			dst += dstskip;
-		}
-	    }
-	    break;
-
-	    case 3: {
-		Uint8 *dst;
-		int dstskip;
-
-		dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
-                       SDL_cursor->area.x*3;
-		dstskip = screen->pitch-area->w*3;
-
-		for ( h=area->h; h; h-- ) {
-			for ( w=area->w/8; w; w-- ) {
-				maskb = *mask++;
-				datab = *data++;
-				for ( i=0; i<8; ++i ) {
-					if ( maskb & 0x80 ) {
-						SDL_memset(dst,pixels[datab>>7],3);
-					}
-					maskb <<= 1;
-					datab <<= 1;
-					dst += 3;
-				}
+	SDL_Surface *sprite;
+	Uint32 pixels[2], pixel, key;
+	Uint8 *data, *mask, *dst;
+	Uint8 bit;
+	int x, y;
+
+	sprite = SDL_CreateRGBSurface(SDL_SWSURFACE,
+			cursor->area.w, cursor->area.h, fmt->BitsPerPixel,
+			fmt->Rmask, fmt->Gmask, fmt->Bmask, 0);
+	if ( sprite == NULL ) {
+		return(NULL);
+	}
+	if ( fmt->palette && sprite->format->palette ) {
+		SDL_SetColors(sprite, fmt->palette->colors,
+					0, fmt->palette->ncolors);
+	}
+	pixels[0] = SDL_MapRGB(fmt, 255, 255, 255);
+	pixels[1] = SDL_MapRGB(fmt, 0, 0, 0);
+	for ( key=0; (key == pixels[0]) || (key == pixels[1]); ++key ) {
+		/* Find an unused pixel value */ ;
+	}
+
+	data = cursor->data;
+	mask = cursor->mask;
+	for ( y=0; y<sprite->h; ++y ) {
+		dst = (Uint8 *)sprite->pixels + y*sprite->pitch;
+		for ( x=0; x<sprite->w; ++x ) {
+			bit = (0x80 >> (x%8));
+			if ( mask[x/8] & bit ) {
+				pixel = pixels[(data[x/8] & bit) ? 1 : 0];
+			} else {
+				pixel = key;
 			}
-			dst += dstskip;
-		}
-	    }
-	    break;
-
-	    case 4: {
-		Uint32 *dst;
-		int dstskip;
-
-		dst = (Uint32 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch/4 +
-                       SDL_cursor->area.x;
-		dstskip = (screen->pitch/4)-area->w;
-
-		for ( h=area->h; h; h-- ) {
-			for ( w=area->w/8; w; w-- ) {
-				maskb = *mask++;
-				datab = *data++;
-				for ( i=0; i<8; ++i ) {
-					if ( maskb & 0x80 ) {
-						*dst = pixels[datab>>7];
-					}
-					maskb <<= 1;
-					datab <<= 1;
-					dst++;
-				}
+			switch (sprite->format->BytesPerPixel) {
+			    case 1:
+				*dst = (Uint8)pixel;
+				break;
+			    case 2:
+				*(Uint16 *)dst = (Uint16)pixel;
+				break;
+			    case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+				dst[0] = (Uint8)pixel;
+				dst[1] = (Uint8)(pixel>>8);
+				dst[2] = (Uint8)(pixel>>16);
+#else
+				dst[0] = (Uint8)(pixel>>16);
+				dst[1] = (Uint8)(pixel>>8);
+				dst[2] = (Uint8)pixel;
+#endif
+				break;
+			    case 4:
+				*(Uint32 *)dst = pixel;
+				break;
 			}
-			dst += dstskip;
+			dst += sprite->format->BytesPerPixel;
 		}
-	    }
-	    break;
+		data += cursor->area.w/8;
+		mask += cursor->area.w/8;
 	}
+	SDL_SetColorKey(sprite, SDL_SRCCOLORKEY|SDL_RLEACCEL, key);
+	return(sprite);
 }
 
-static void SDL_DrawCursorSlow(SDL_Surface *screen, SDL_Rect *area)
+/* Return the current cursor image, converted for drawing on 'screen'.
+   The video surface and the shadow surface each get their own copy,
+   so that drawing on both doesn't keep throwing away the blit mapping.
+ */
+static SDL_Surface *SDL_GetCursorSprite(SDL_Surface *screen)
 {
-	const Uint32 pixels[2] = { 0xFFFFFF, 0x000000 };
-	int h;
-	int x, minx, maxx;
-	Uint8 *data, datab = 0;
-	Uint8 *mask, maskb = 0;
-	Uint8 *dst;
-	int dstbpp, dstskip;
-
-	data = SDL_cursor->data + area->y * SDL_cursor->area.w/8;
-	mask = SDL_cursor->mask + area->y * SDL_cursor->area.w/8;
-	dstbpp = screen->format->BytesPerPixel;
-	dst = (Uint8 *)screen->pixels +
-                       (SDL_cursor->area.y+area->y)*screen->pitch +
-                       SDL_cursor->area.x*dstbpp;
-	dstskip = screen->pitch-SDL_cursor->area.w*dstbpp;
-
-	minx = area->x;
-	maxx = area->x+area->w;
-	if ( screen->format->BytesPerPixel == 1 ) {
-		if ( palette_changed ) {
-			pixels8[0] = (Uint8)SDL_MapRGB(screen->format, 255, 255, 255);
-			pixels8[1] = (Uint8)SDL_MapRGB(screen->format, 0, 0, 0);
-			palette_changed = 0;
+	struct SDL_CursorImage *image;
+	SDL_PixelFormat *fmt;
+	SDL_Surface *sprite;
+	int slot;
+
+	image = SDL_FindCursorImage(SDL_cursor);
+	if ( image == NULL ) {
+		return(NULL);
+	}
+	slot = (screen == SDL_VideoSurface) ? 0 : 1;
+	sprite = image->sprite[slot];
+
+	/* B/W cursors are built in the screen format, check it's the same */
+	fmt = screen->format;
+	if ( sprite && !image->argb ) {
+		if ( (sprite->format->BitsPerPixel != fmt->BitsPerPixel) ||
+		     (sprite->format->Rmask != fmt->Rmask) ||
+		     (sprite->format->Gmask != fmt->Gmask) ||
+		     (sprite->format->Bmask != fmt->Bmask) ||
+		     (fmt->palette &&
+		      (image->palette_version[slot] != palette_version)) ) {
+			SDL_FreeSurface(sprite);
+			sprite = NULL;
 		}
-		for ( h=area->h; h; h-- ) {
-			for ( x=0; x<SDL_cursor->area.w; ++x ) {
-				if ( (x%8) == 0 ) {
-					maskb = *mask++;
-					datab = *data++;
-				}
-				if ( (x >= minx) && (x < maxx) ) {
-					if ( maskb & 0x80 ) {
-						SDL_memset(dst, pixels8[datab>>7], dstbpp);
-					}
-				}
-				maskb <<= 1;
-				datab <<= 1;
-				dst += dstbpp;
+	}
+	if ( sprite == NULL ) {
+		if ( image->argb ) {
+			/* The RLE encoding converts it to the screen format */
+			sprite = SDL_ConvertSurface(image->argb,
+					image->argb->format, SDL_SWSURFACE);
+			if ( sprite ) {
+				SDL_SetAlpha(sprite, SDL_SRCALPHA|SDL_RLEACCEL,
+							SDL_ALPHA_OPAQUE);
 			}
-			dst += dstskip;
+		} else {
+			sprite = SDL_CreateMonoSprite(SDL_cursor, fmt);
 		}
-	} else {
-		for ( h=area->h; h; h-- ) {
-			for ( x=0; x<SDL_cursor->area.w; ++x ) {
-				if ( (x%8) == 0 ) {
-					maskb = *mask++;
-					datab = *data++;
-				}
-				if ( (x >= minx) && (x < maxx) ) {
-					if ( maskb & 0x80 ) {
-						SDL_memset(dst, pixels[datab>>7], dstbpp);
-					}
-				}
-				maskb <<= 1;
-				datab <<= 1;
-				dst += dstbpp;
-			}
-			dst += dstskip;
+		image->sprite[slot] = sprite;
+		image->palette_version[slot] = palette_version;
+	}
+	return(sprite);
+}
+
+/* Draw the visible part of the cursor, 'area' is in screen coordinates */
+static void SDL_BlitCursorSprite(SDL_Surface *screen, SDL_Rect *area)
+{
+	SDL_Surface *sprite;
+	SDL_Rect srcrect, dstrect;
+
+	sprite = SDL_GetCursorSprite(screen);
+	if ( sprite == NULL ) {
+		return;
+	}
+
+	/* The screen is already locked, so bypass SDL_LowerBlit() and
+	   always use the software blitter, never a hardware blit.
+	 */
+	if ( (sprite->map->dst != screen) ||
+	     (sprite->map->format_version != screen->format_version) ) {
+		if ( SDL_MapSurface(sprite, screen) < 0 ) {
+			return;
 		}
 	}
+	srcrect.x = area->x - SDL_cursor->area.x;
+	srcrect.y = area->y - SDL_cursor->area.y;
+	srcrect.w = area->w;
+	srcrect.h = area->h;
+	dstrect = *area;
+	sprite->map->sw_blit(sprite, &srcrect, screen, &dstrect);
 }
 
 /* This handles the ugly work of converting the saved cursor background from
@@ -628,13 +732,7 @@ void SDL_DrawCursorNoLock(SDL_Surface *screen)
 	}
 
 	/* Draw the mouse cursor */
-	area.x -= SDL_cursor->area.x;
-	area.y -= SDL_cursor->area.y;
-	if ( (area.x == 0) && (area.w == SDL_cursor->area.w) ) {
-		SDL_DrawCursorFast(screen, &area);
-	} else {
-		SDL_DrawCursorSlow(screen, &area);
-	}
+	SDL_BlitCursorSprite(screen, &area);
 }
 
 void SDL_DrawCursor(SDL_Surface *screen)
@@ -742,11 +840,12 @@ void SDL_EraseCursor(SDL_Surface *screen)
 	}
 }
 
-/* Reset the cursor on video mode change
+/* Reset the cursor on video mode change, called with the cursor locked
    FIXME:  Keep track of all cursors, and reset them all.
  */
 void SDL_ResetCursor(void)
 {
+	struct SDL_CursorImage *image;
 	int savelen;
 
 	if ( SDL_cursor ) {
@@ -755,4 +854,9 @@ void SDL_ResetCursor(void)
 		SDL_cursor->area.y = 0;
 		SDL_memset(SDL_cursor->save[0], 0, savelen);
 	}
+
+	/* The sprites of every cursor are in the old screen format */
+	for ( image=SDL_cursorimages; image; image=image->next ) {
+		SDL_FreeCursorSprites(image);
+	}
 }
@@ -35,7 +35,57 @@
 #define log(x)		__ieee754_log(x)
 #endif
 
+#include "SDL_endian.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_sysvideo.h"
+#include "SDL_blit.h"
+#include "SDL_gamma_c.h"
+
+/* The vector versions of the lookups, picked at run time */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SDL_GAMMA_SSE2	1
+#include <emmintrin.h>
+#endif
+#if (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define SDL_GAMMA_AVX2	1
+#if defined(__clang__) || (__GNUC__ >= 5)
+#define SDL_GAMMA_AVX512	1
+#endif
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+/* 32-bit NEON table lookups only reach 32 entries */
+#define SDL_GAMMA_NEON	1
+#include <arm_neon.h>
+#endif
+
+struct SDL_SoftGamma;
+
+/* Correct 'w' pixels from 'src' to 'dst', which may be the same */
+typedef void (*SDL_SoftGammaRow)(const struct SDL_SoftGamma *softgamma,
+                                 const Uint8 *src, Uint8 *dst, int w);
+
+/* Software gamma tables, built for the video surface format.
+   Each channel table maps a channel value to the corrected value,
+   already shifted into place.  Two byte formats get a table mapping
+   whole pixels instead, so they take a single lookup per pixel.
+   Four byte formats whose channels are whole bytes also get a byte
+   to byte table for each byte of the pixel in memory order, for the
+   vector byte shuffles.  The byte that isn't a channel maps to itself.
+ */
+struct SDL_SoftGamma {
+	int BytesPerPixel;
+	Uint32 Rmask, Gmask, Bmask;
+	Uint8 Rshift, Gshift, Bshift;
+	Uint32 Rtable[256];
+	Uint32 Gtable[256];
+	Uint32 Btable[256];
+	Uint16 *table16;
+	SDL_bool bytewise;
+	Uint8 bytes[4][256];
+	SDL_SoftGammaRow ApplyRow;
+};
 
 
 static void CalculateGammaRamp(float gamma, Uint16 *ramp)
@@ -90,6 +140,540 @@ static void CalculateGammaFromRamp(float *gamma, Uint16 *ramp)
 	}
 }
 
+static void CalculateSoftGammaChannel(Uint32 *table, const Uint16 *ramp,
+                                      Uint32 mask, Uint8 shift)
+{
+	const Uint32 max = mask >> shift;
+	Uint32 i, value;
+
+	for ( i = 0; i <= max; ++i ) {
+		value = ramp[(i * 255 + max / 2) / max] >> 8;
+		table[i] = ((value * max + 127) / 255) << shift;
+	}
+}
+
+static void SDL_SoftGammaRow16(const struct SDL_SoftGamma *softgamma,
+                               const Uint8 *src, Uint8 *dst, int w)
+{
+	const Uint16 *table = softgamma->table16;
+	const Uint16 *s = (const Uint16 *)src;
+	Uint16 *d = (Uint16 *)dst;
+	int x;
+
+	for ( x = 0; x < w; ++x ) {
+		d[x] = table[s[x]];
+	}
+}
+
+static void SDL_SoftGammaRow24(const struct SDL_SoftGamma *softgamma,
+                               const Uint8 *src, Uint8 *dst, int w)
+{
+	const Uint32 keep = ~(softgamma->Rmask|softgamma->Gmask|softgamma->Bmask);
+	Uint32 pixel;
+	int x;
+
+	for ( x = 0; x < w; ++x ) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		pixel = src[0] | (src[1] << 8) | (src[2] << 16);
+#else
+		pixel = (src[0] << 16) | (src[1] << 8) | src[2];
+#endif
+		pixel = softgamma->Rtable[(pixel & softgamma->Rmask) >> softgamma->Rshift] |
+		        softgamma->Gtable[(pixel & softgamma->Gmask) >> softgamma->Gshift] |
+		        softgamma->Btable[(pixel & softgamma->Bmask) >> softgamma->Bshift] |
+		        (pixel & keep);
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		dst[0] = (Uint8)pixel;
+		dst[1] = (Uint8)(pixel >> 8);
+		dst[2] = (Uint8)(pixel >> 16);
+#else
+		dst[0] = (Uint8)(pixel >> 16);
+		dst[1] = (Uint8)(pixel >> 8);
+		dst[2] = (Uint8)pixel;
+#endif
+		src += 3;
+		dst += 3;
+	}
+}
+
+static void SDL_SoftGammaRow32(const struct SDL_SoftGamma *softgamma,
+                               const Uint8 *src, Uint8 *dst, int w)
+{
+	const Uint32 *Rtable = softgamma->Rtable;
+	const Uint32 *Gtable = softgamma->Gtable;
+	const Uint32 *Btable = softgamma->Btable;
+	const Uint32 Rmask = softgamma->Rmask;
+	const Uint32 Gmask = softgamma->Gmask;
+	const Uint32 Bmask = softgamma->Bmask;
+	const Uint8 Rshift = softgamma->Rshift;
+	const Uint8 Gshift = softgamma->Gshift;
+	const Uint8 Bshift = softgamma->Bshift;
+	const Uint32 keep = ~(Rmask|Gmask|Bmask);
+	const Uint32 *s = (const Uint32 *)src;
+	Uint32 *d = (Uint32 *)dst;
+	int x;
+
+	for ( x = 0; x < w; ++x ) {
+		const Uint32 pixel = s[x];
+		d[x] = Rtable[(pixel & Rmask) >> Rshift] |
+		       Gtable[(pixel & Gmask) >> Gshift] |
+		       Btable[(pixel & Bmask) >> Bshift] |
+		       (pixel & keep);
+	}
+}
+
+#if SDL_GAMMA_SSE2
+/* Four pixels at a time: the channel indexes are pulled out with vector
+   masks and shifts, and only the table loads are done one by one.
+ */
+static void SDL_SoftGammaRow32_SSE2(const struct SDL_SoftGamma *softgamma,
+                                    const Uint8 *src, Uint8 *dst, int w)
+{
+	const Uint32 *Rtable = softgamma->Rtable;
+	const Uint32 *Gtable = softgamma->Gtable;
+	const Uint32 *Btable = softgamma->Btable;
+	const __m128i Rmask = _mm_set1_epi32((int)softgamma->Rmask);
+	const __m128i Gmask = _mm_set1_epi32((int)softgamma->Gmask);
+	const __m128i Bmask = _mm_set1_epi32((int)softgamma->Bmask);
+	const __m128i Rshift = _mm_cvtsi32_si128(softgamma->Rshift);
+	const __m128i Gshift = _mm_cvtsi32_si128(softgamma->Gshift);
+	const __m128i Bshift = _mm_cvtsi32_si128(softgamma->Bshift);
+	const __m128i keep = _mm_set1_epi32((int)~(softgamma->Rmask|softgamma->Gmask|softgamma->Bmask));
+	const Uint32 *s = (const Uint32 *)src;
+	Uint32 *d = (Uint32 *)dst;
+	int x;
+
+	for ( x = 0; x + 4 <= w; x += 4 ) {
+		const __m128i pixels = _mm_loadu_si128((const __m128i *)&s[x]);
+		/* Each index fits in 8 bits, so pack them all into one register */
+		const __m128i index = _mm_or_si128(
+			_mm_srl_epi32(_mm_and_si128(pixels, Rmask), Rshift),
+			_mm_or_si128(
+			_mm_slli_epi32(_mm_srl_epi32(_mm_and_si128(pixels, Gmask), Gshift), 8),
+			_mm_slli_epi32(_mm_srl_epi32(_mm_and_si128(pixels, Bmask), Bshift), 16)));
+		const Uint32 i0 = (Uint32)_mm_cvtsi128_si32(index);
+		const Uint32 i1 = (Uint32)_mm_cvtsi128_si32(_mm_srli_si128(index, 4));
+		const Uint32 i2 = (Uint32)_mm_cvtsi128_si32(_mm_srli_si128(index, 8));
+		const Uint32 i3 = (Uint32)_mm_cvtsi128_si32(_mm_srli_si128(index, 12));
+		const __m128i corrected = _mm_setr_epi32(
+			(int)(Rtable[i0 & 0xFF] | Gtable[(i0 >> 8) & 0xFF] | Btable[i0 >> 16]),
+			(int)(Rtable[i1 & 0xFF] | Gtable[(i1 >> 8) & 0xFF] | Btable[i1 >> 16]),
+			(int)(Rtable[i2 & 0xFF] | Gtable[(i2 >> 8) & 0xFF] | Btable[i2 >> 16]),
+			(int)(Rtable[i3 & 0xFF] | Gtable[(i3 >> 8) & 0xFF] | Btable[i3 >> 16]));
+		_mm_storeu_si128((__m128i *)&d[x],
+			_mm_or_si128(corrected, _mm_and_si128(pixels, keep)));
+	}
+	SDL_SoftGammaRow32(softgamma, (const Uint8 *)&s[x], (Uint8 *)&d[x], w - x);
+}
+#endif /* SDL_GAMMA_SSE2 */
+
+#if SDL_GAMMA_AVX2
+/* Eight pixels at a time, with a gather for each channel */
+__attribute__((target("avx2")))
+static void SDL_SoftGammaRow32_AVX2(const struct SDL_SoftGamma *softgamma,
+                                    const Uint8 *src, Uint8 *dst, int w)
+{
+	const int *Rtable = (const int *)softgamma->Rtable;
+	const int *Gtable = (const int *)softgamma->Gtable;
+	const int *Btable = (const int *)softgamma->Btable;
+	const __m256i Rmask = _mm256_set1_epi32((int)softgamma->Rmask);
+	const __m256i Gmask = _mm256_set1_epi32((int)softgamma->Gmask);
+	const __m256i Bmask = _mm256_set1_epi32((int)softgamma->Bmask);
+	const __m128i Rshift = _mm_cvtsi32_si128(softgamma->Rshift);
+	const __m128i Gshift = _mm_cvtsi32_si128(softgamma->Gshift);
+	const __m128i Bshift = _mm_cvtsi32_si128(softgamma->Bshift);
+	const __m256i keep = _mm256_set1_epi32((int)~(softgamma->Rmask|softgamma->Gmask|softgamma->Bmask));
+	const Uint32 *s = (const Uint32 *)src;
+	Uint32 *d = (Uint32 *)dst;
+	int x;
+
+	for ( x = 0; x + 8 <= w; x += 8 ) {
+		const __m256i pixels = _mm256_loadu_si256((const __m256i *)&s[x]);
+		const __m256i r = _mm256_i32gather_epi32(Rtable,
+			_mm256_srl_epi32(_mm256_and_si256(pixels, Rmask), Rshift), 4);
+		const __m256i g = _mm256_i32gather_epi32(Gtable,
+			_mm256_srl_epi32(_mm256_and_si256(pixels, Gmask), Gshift), 4);
+		const __m256i b = _mm256_i32gather_epi32(Btable,
+			_mm256_srl_epi32(_mm256_and_si256(pixels, Bmask), Bshift), 4);
+		_mm256_storeu_si256((__m256i *)&d[x],
+			_mm256_or_si256(_mm256_or_si256(r, g),
+			                _mm256_or_si256(b, _mm256_and_si256(pixels, keep))));
+	}
+	SDL_SoftGammaRow32(softgamma, (const Uint8 *)&s[x], (Uint8 *)&d[x], w - x);
+}
+
+/* Sixteen pixels at a time, gathering pairs of entries from the pixel
+   table; table16 has a spare entry so the last pair stays in bounds.
+ */
+__attribute__((target("avx2")))
+static void SDL_SoftGammaRow16_AVX2(const struct SDL_SoftGamma *softgamma,
+                                    const Uint8 *src, Uint8 *dst, int w)
+{
+	const int *table = (const int *)softgamma->table16;
+	const __m256i lo = _mm256_set1_epi32(0xFFFF);
+	const Uint16 *s = (const Uint16 *)src;
+	Uint16 *d = (Uint16 *)dst;
+	int x;
+
+	for ( x = 0; x + 16 <= w; x += 16 ) {
+		const __m256i pixels = _mm256_loadu_si256((const __m256i *)&s[x]);
+		const __m256i even = _mm256_i32gather_epi32(table,
+			_mm256_and_si256(pixels, lo), 2);
+		const __m256i odd = _mm256_i32gather_epi32(table,
+			_mm256_srli_epi32(pixels, 16), 2);
+		_mm256_storeu_si256((__m256i *)&d[x],
+			_mm256_or_si256(_mm256_and_si256(even, lo),
+			                _mm256_slli_epi32(odd, 16)));
+	}
+	SDL_SoftGammaRow16(softgamma, (const Uint8 *)&s[x], (Uint8 *)&d[x], w - x);
+}
+#endif /* SDL_GAMMA_AVX2 */
+
+#if SDL_GAMMA_AVX512
+/* Look up 64 bytes in a 256 entry table, 128 entries at a time */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static __inline__ __m512i SDL_SoftGammaLookup_AVX512(const __m512i *table,
+                                                     __m512i index)
+{
+	return _mm512_mask_blend_epi8(_mm512_movepi8_mask(index),
+		_mm512_permutex2var_epi8(table[0], index, table[1]),
+		_mm512_permutex2var_epi8(table[2], index, table[3]));
+}
+
+/* Sixty four pixels at a time, for formats with whole byte channels.
+   The pixels are transposed so each register holds one byte of every
+   pixel, which keeps all the lanes of each lookup busy.  The in-lane
+   shuffles put the pixels in an odd order, but transposing back
+   undoes that.
+ */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void SDL_SoftGammaRow32_AVX512(const struct SDL_SoftGamma *softgamma,
+                                      const Uint8 *src, Uint8 *dst, int w)
+{
+	/* Transposes the 4x4 bytes of each group of four pixels */
+	const __m512i transpose = _mm512_set4_epi32(0x0F0B0703, 0x0E0A0602,
+	                                            0x0D090501, 0x0C080400);
+	const Uint32 *s = (const Uint32 *)src;
+	Uint32 *d = (Uint32 *)dst;
+	__m512i table[4][4];
+	__m512i p0, p1, p2, p3, t0, t1, t2, t3;
+	int i, x;
+
+	for ( i = 0; i < 4; ++i ) {
+		for ( x = 0; x < 4; ++x ) {
+			table[i][x] = _mm512_loadu_si512(&softgamma->bytes[i][x*64]);
+		}
+	}
+	for ( x = 0; x + 64 <= w; x += 64 ) {
+		/* Split the pixels into one register per byte */
+		p0 = _mm512_shuffle_epi8(_mm512_loadu_si512(&s[x]), transpose);
+		p1 = _mm512_shuffle_epi8(_mm512_loadu_si512(&s[x+16]), transpose);
+		p2 = _mm512_shuffle_epi8(_mm512_loadu_si512(&s[x+32]), transpose);
+		p3 = _mm512_shuffle_epi8(_mm512_loadu_si512(&s[x+48]), transpose);
+		t0 = _mm512_unpacklo_epi32(p0, p1);
+		t1 = _mm512_unpackhi_epi32(p0, p1);
+		t2 = _mm512_unpacklo_epi32(p2, p3);
+		t3 = _mm512_unpackhi_epi32(p2, p3);
+		p0 = _mm512_unpacklo_epi64(t0, t2);
+		p1 = _mm512_unpackhi_epi64(t0, t2);
+		p2 = _mm512_unpacklo_epi64(t1, t3);
+		p3 = _mm512_unpackhi_epi64(t1, t3);
+
+		p0 = SDL_SoftGammaLookup_AVX512(table[0], p0);
+		p1 = SDL_SoftGammaLookup_AVX512(table[1], p1);
+		p2 = SDL_SoftGammaLookup_AVX512(table[2], p2);
+		p3 = SDL_SoftGammaLookup_AVX512(table[3], p3);
+
+		/* Put the pixels back together */
+		t0 = _mm512_unpacklo_epi64(p0, p1);
+		t2 = _mm512_unpackhi_epi64(p0, p1);
+		t1 = _mm512_unpacklo_epi64(p2, p3);
+		t3 = _mm512_unpackhi_epi64(p2, p3);
+		p0 = _mm512_unpacklo_epi32(t0, t1);
+		p1 = _mm512_unpackhi_epi32(t0, t1);
+		p2 = _mm512_unpacklo_epi32(t2, t3);
+		p3 = _mm512_unpackhi_epi32(t2, t3);
+		_mm512_storeu_si512(&d[x], _mm512_shuffle_epi8(_mm512_unpacklo_epi32(p0, p1), transpose));
+		_mm512_storeu_si512(&d[x+16], _mm512_shuffle_epi8(_mm512_unpackhi_epi32(p0, p1), transpose));
+		_mm512_storeu_si512(&d[x+32], _mm512_shuffle_epi8(_mm512_unpacklo_epi32(p2, p3), transpose));
+		_mm512_storeu_si512(&d[x+48], _mm512_shuffle_epi8(_mm512_unpackhi_epi32(p2, p3), transpose));
+	}
+	SDL_SoftGammaRow32(softgamma, (const Uint8 *)&s[x], (Uint8 *)&d[x], w - x);
+}
+#endif /* SDL_GAMMA_AVX512 */
+
+#if SDL_GAMMA_NEON
+/* Look up 16 bytes in a 256 entry table, 64 entries at a time */
+static __inline__ uint8x16_t SDL_SoftGammaLookup_NEON(const uint8x16x4_t *table,
+                                                      uint8x16_t index)
+{
+	const uint8x16_t step = vdupq_n_u8(64);
+	uint8x16_t result;
+
+	result = vqtbl4q_u8(table[0], index);
+	index = vsubq_u8(index, step);
+	result = vqtbx4q_u8(result, table[1], index);
+	index = vsubq_u8(index, step);
+	result = vqtbx4q_u8(result, table[2], index);
+	index = vsubq_u8(index, step);
+	return vqtbx4q_u8(result, table[3], index);
+}
+
+/* Sixteen pixels at a time, for formats with whole byte channels */
+static void SDL_SoftGammaRow32_NEON(const struct SDL_SoftGamma *softgamma,
+                                    const Uint8 *src, Uint8 *dst, int w)
+{
+	uint8x16x4_t table[4][4];
+	uint8x16x4_t pixels;
+	int i, x;
+
+	for ( i = 0; i < 4; ++i ) {
+		for ( x = 0; x < 4; ++x ) {
+			table[i][x] = vld1q_u8_x4(&softgamma->bytes[i][x*64]);
+		}
+	}
+	for ( x = 0; x + 16 <= w; x += 16 ) {
+		/* Split the pixels into one register per byte */
+		pixels = vld4q_u8(&src[x*4]);
+		pixels.val[0] = SDL_SoftGammaLookup_NEON(table[0], pixels.val[0]);
+		pixels.val[1] = SDL_SoftGammaLookup_NEON(table[1], pixels.val[1]);
+		pixels.val[2] = SDL_SoftGammaLookup_NEON(table[2], pixels.val[2]);
+		pixels.val[3] = SDL_SoftGammaLookup_NEON(table[3], pixels.val[3]);
+		vst4q_u8(&dst[x*4], pixels);
+	}
+	SDL_SoftGammaRow32(softgamma, &src[x*4], &dst[x*4], w - x);
+}
+#endif /* SDL_GAMMA_NEON */
+
+/* Pick the fastest row function for the format and CPU */
+static SDL_SoftGammaRow SDL_ChooseSoftGammaRow(const struct SDL_SoftGamma *softgamma)
+{
+	switch (softgamma->BytesPerPixel) {
+	    case 2:
+#if SDL_GAMMA_AVX2
+		if ( SDL_HasAVX2() ) {
+			return SDL_SoftGammaRow16_AVX2;
+		}
+#endif
+		return SDL_SoftGammaRow16;
+
+	    case 3:
+		return SDL_SoftGammaRow24;
+
+	    default:
+#if SDL_GAMMA_AVX512
+		if ( softgamma->bytewise && SDL_HasAVX512VBMI() ) {
+			return SDL_SoftGammaRow32_AVX512;
+		}
+#endif
+#if SDL_GAMMA_AVX2
+		if ( SDL_HasAVX2() ) {
+			return SDL_SoftGammaRow32_AVX2;
+		}
+#endif
+#if SDL_GAMMA_SSE2
+		if ( SDL_HasSSE2() ) {
+			return SDL_SoftGammaRow32_SSE2;
+		}
+#endif
+#if SDL_GAMMA_NEON
+		if ( softgamma->bytewise && SDL_HasNEON() ) {
+			return SDL_SoftGammaRow32_NEON;
+		}
+#endif
+		return SDL_SoftGammaRow32;
+	}
+}
+
+static int SDL_UpdateSoftGamma(SDL_VideoDevice *video)
+{
+	SDL_PixelFormat *fmt = SDL_VideoSurface->format;
+	struct SDL_SoftGamma *softgamma;
+	int i;
+
+	SDL_FreeSoftGamma(video);
+
+	/* An identity ramp needs no correction at all */
+	for ( i = 0; i < 3*256; ++i ) {
+		if ( video->gamma[i] != (((i & 0xFF) << 8) | (i & 0xFF)) ) {
+			break;
+		}
+	}
+	if ( i == 3*256 ) {
+		return 0;
+	}
+
+	if ( (fmt->BytesPerPixel < 2) ||
+	     (fmt->Rmask == 0) || (fmt->Gmask == 0) || (fmt->Bmask == 0) ||
+	     ((fmt->Rmask >> fmt->Rshift) > 0xFF) ||
+	     ((fmt->Gmask >> fmt->Gshift) > 0xFF) ||
+	     ((fmt->Bmask >> fmt->Bshift) > 0xFF) ) {
+		SDL_SetError("Software gamma not supported for this pixel format");
+		return -1;
+	}
+	softgamma = (struct SDL_SoftGamma *)SDL_malloc(sizeof(*softgamma));
+	if ( ! softgamma ) {
+		SDL_OutOfMemory();
+		return -1;
+	}
+	softgamma->BytesPerPixel = fmt->BytesPerPixel;
+	softgamma->Rmask = fmt->Rmask;
+	softgamma->Gmask = fmt->Gmask;
+	softgamma->Bmask = fmt->Bmask;
+	softgamma->Rshift = fmt->Rshift;
+	softgamma->Gshift = fmt->Gshift;
+	softgamma->Bshift = fmt->Bshift;
+	softgamma->table16 = NULL;
+	CalculateSoftGammaChannel(softgamma->Rtable, &video->gamma[0*256],
+	                          fmt->Rmask, fmt->Rshift);
+	CalculateSoftGammaChannel(softgamma->Gtable, &video->gamma[1*256],
+	                          fmt->Gmask, fmt->Gshift);
+	CalculateSoftGammaChannel(softgamma->Btable, &video->gamma[2*256],
+	                          fmt->Bmask, fmt->Bshift);
+
+	if ( fmt->BytesPerPixel == 2 ) {
+		const Uint32 keep = ~(fmt->Rmask|fmt->Gmask|fmt->Bmask);
+		Uint32 pixel;
+
+		/* The spare entry lets the vector code read pairs of entries */
+		softgamma->table16 = (Uint16 *)SDL_malloc((65536+1)*sizeof(Uint16));
+		if ( ! softgamma->table16 ) {
+			SDL_free(softgamma);
+			SDL_OutOfMemory();
+			return -1;
+		}
+		for ( pixel = 0; pixel < 65536; ++pixel ) {
+			softgamma->table16[pixel] = (Uint16)(
+			    softgamma->Rtable[(pixel & fmt->Rmask) >> fmt->Rshift] |
+			    softgamma->Gtable[(pixel & fmt->Gmask) >> fmt->Gshift] |
+			    softgamma->Btable[(pixel & fmt->Bmask) >> fmt->Bshift] |
+			    (pixel & keep));
+		}
+		softgamma->table16[65536] = 0;
+	}
+
+	/* Channels that are whole bytes can be looked up a byte at a time */
+	softgamma->bytewise = SDL_FALSE;
+	if ( (fmt->BytesPerPixel == 4) &&
+	     (fmt->Rmask == (0xFFu << fmt->Rshift)) && ((fmt->Rshift % 8) == 0) &&
+	     (fmt->Gmask == (0xFFu << fmt->Gshift)) && ((fmt->Gshift % 8) == 0) &&
+	     (fmt->Bmask == (0xFFu << fmt->Bshift)) && ((fmt->Bshift % 8) == 0) ) {
+		int byte;
+
+		softgamma->bytewise = SDL_TRUE;
+		for ( byte = 0; byte < 4; ++byte ) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			const int shift = byte * 8;
+#else
+			const int shift = (3 - byte) * 8;
+#endif
+			for ( i = 0; i < 256; ++i ) {
+				Uint32 value = ((Uint32)i << shift);
+				if ( shift == fmt->Rshift ) {
+					value = softgamma->Rtable[i];
+				} else if ( shift == fmt->Gshift ) {
+					value = softgamma->Gtable[i];
+				} else if ( shift == fmt->Bshift ) {
+					value = softgamma->Btable[i];
+				}
+				softgamma->bytes[byte][i] = (Uint8)(value >> shift);
+			}
+		}
+	}
+	softgamma->ApplyRow = SDL_ChooseSoftGammaRow(softgamma);
+	video->softgamma = softgamma;
+	return 0;
+}
+
+/* Copy 'w'x'h' pixels from 'src' to 'dst' (which may be the same),
+   correcting them on the way.
+ */
+static void SDL_ApplySoftGamma(const struct SDL_SoftGamma *softgamma,
+                               const Uint8 *src, int srcpitch,
+                               Uint8 *dst, int dstpitch, int w, int h)
+{
+	while ( h-- ) {
+		softgamma->ApplyRow(softgamma, src, dst, w);
+		src += srcpitch;
+		dst += dstpitch;
+	}
+}
+
+SDL_bool SDL_SoftGammaRequested(SDL_VideoDevice *video, int bpp)
+{
+	const char *env;
+
+	if ( video->SetGammaRamp || (bpp <= 8) ||
+	     (SDL_VideoSurface->format->BitsPerPixel <= 8) ||
+	     (SDL_VideoSurface->flags & SDL_OPENGL) ) {
+		return SDL_FALSE;
+	}
+	env = SDL_getenv("SDL_VIDEO_SOFTWARE_GAMMA");
+	if ( env && SDL_atoi(env) ) {
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
+int SDL_SoftGammaBlit(SDL_Surface *src, SDL_Rect *srcrect,
+                      SDL_Surface *dst, SDL_Rect *dstrect)
+{
+	SDL_VideoDevice *video = current_video;
+	const struct SDL_SoftGamma *softgamma = video->softgamma;
+	const SDL_PixelFormat *srcfmt = src->format;
+	const SDL_PixelFormat *dstfmt = dst->format;
+	const Uint8 *srcpixels;
+	Uint8 *dstpixels;
+	int retval = 0;
+
+	if ( ! softgamma ) {
+		return SDL_LowerBlit(src, srcrect, dst, dstrect);
+	}
+
+	/* Correct the pixels on the way if the formats match, otherwise
+	   convert them first and correct them in place */
+	if ( (srcfmt->BytesPerPixel != dstfmt->BytesPerPixel) ||
+	     (srcfmt->Rmask != dstfmt->Rmask) ||
+	     (srcfmt->Gmask != dstfmt->Gmask) ||
+	     (srcfmt->Bmask != dstfmt->Bmask) ) {
+		retval = SDL_LowerBlit(src, srcrect, dst, dstrect);
+		if ( retval < 0 ) {
+			return retval;
+		}
+		src = dst;
+		srcrect = dstrect;
+	}
+	if ( SDL_LockSurface(dst) < 0 ) {
+		return -1;
+	}
+	if ( (src != dst) && (SDL_LockSurface(src) < 0) ) {
+		SDL_UnlockSurface(dst);
+		return -1;
+	}
+	srcpixels = (const Uint8 *)src->pixels + srcrect->y * src->pitch +
+	            srcrect->x * src->format->BytesPerPixel;
+	dstpixels = (Uint8 *)dst->pixels + dstrect->y * dst->pitch +
+	            dstrect->x * dstfmt->BytesPerPixel;
+	SDL_ApplySoftGamma(softgamma, srcpixels, src->pitch,
+	                   dstpixels, dst->pitch, srcrect->w, srcrect->h);
+	if ( src != dst ) {
+		SDL_UnlockSurface(src);
+	}
+	SDL_UnlockSurface(dst);
+	return retval;
+}
+
+void SDL_FreeSoftGamma(SDL_VideoDevice *video)
+{
+	if ( video->softgamma ) {
+		if ( video->softgamma->table16 ) {
+			SDL_free(video->softgamma->table16);
+		}
+		SDL_free(video->softgamma);
+		video->softgamma = NULL;
+	}
+}
+
 int SDL_SetGamma(float red, float green, float blue)
 {
 	int succeeded;
@@ -187,6 +771,8 @@ int SDL_SetGammaRamp(const Uint16 *red, const Uint16 *green, const Uint16 *blue)
 	succeeded = -1;
 	if ( video->SetGammaRamp ) {
 		succeeded = video->SetGammaRamp(this, video->gamma);
+	} else if ( video->use_softgamma ) {
+		succeeded = SDL_UpdateSoftGamma(video);
 	} else {
 		SDL_SetError("Gamma ramp manipulation not supported");
 	}
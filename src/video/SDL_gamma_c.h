@@ -0,0 +1,35 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* Useful functions from SDL_gamma.c */
+
+#include "SDL_sysvideo.h"
+
+/* Software gamma correction, requested with SDL_VIDEO_SOFTWARE_GAMMA=1.
+   The application draws to a shadow surface, and the gamma ramp is
+   applied through lookup tables when updates are copied to the screen.
+ */
+extern SDL_bool SDL_SoftGammaRequested(SDL_VideoDevice *video, int bpp);
+extern int SDL_SoftGammaBlit(SDL_Surface *src, SDL_Rect *srcrect,
+                             SDL_Surface *dst, SDL_Rect *dstrect);
+extern void SDL_FreeSoftGamma(SDL_VideoDevice *video);
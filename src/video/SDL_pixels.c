@@ -46,6 +46,10 @@ SDL_PixelFormat *SDL_AllocFormat(int bpp,
 		SDL_OutOfMemory();
 		return(NULL);
 	}
+	if ( (bpp > 8) &&
+	     SDL_LookupFormat(format, bpp, Rmask, Gmask, Bmask, Amask) ) {
+		return(format);
+	}
 	SDL_memset(format, 0, sizeof(*format));
 	format->alpha = SDL_ALPHA_OPAQUE;
 
@@ -218,6 +222,9 @@ SDL_PixelFormat *SDL_AllocFormat(int bpp,
 			SDL_memset((format->palette)->colors, 0,
 				(format->palette)->ncolors*sizeof(SDL_Color));
 		}
+	} else {
+		SDL_CacheFormat(format, format->BitsPerPixel,
+				Rmask, Gmask, Bmask, Amask);
 	}
 	return(format);
 }
@@ -580,6 +587,14 @@ int SDL_MapSurface (SDL_Surface *src, SDL_Surface *dst)
 	}
 	SDL_InvalidateMap(map);
 
+	/* Reuse the mapping last worked out for the same formats */
+	switch (SDL_LookupBlitMap(src, dst)) {
+	    case 1:
+		return(0);
+	    case -1:
+		return(-1);
+	}
+
 	/* Figure out what kind of mapping we're doing */
 	map->identity = 0;
 	srcfmt = src->format;
@@ -640,7 +655,11 @@ int SDL_MapSurface (SDL_Surface *src, SDL_Surface *dst)
 	map->format_version = dst->format_version;
 
 	/* Choose your blitters wisely */
-	return(SDL_CalculateBlit(src));
+	if ( SDL_CalculateBlit(src) < 0 ) {
+		return(-1);
+	}
+	SDL_CacheBlitMap(src, dst);
+	return(0);
 }
 void SDL_FreeBlitMap(SDL_BlitMap *map)
 {
@@ -39,6 +39,18 @@ extern void SDL_InvalidateMap(SDL_BlitMap *map);
 extern int SDL_MapSurface (SDL_Surface *src, SDL_Surface *dst);
 extern void SDL_FreeBlitMap(SDL_BlitMap *map);
 
+/* Pixel pool and format cache functions, found in SDL_surfacepool.c */
+extern void SDL_SurfacePoolInit(void);
+extern void SDL_SurfacePoolQuit(void);
+extern int SDL_AllocSurfacePixels(SDL_Surface *surface);
+extern void SDL_FreeSurfacePixels(SDL_Surface *surface);
+extern int SDL_LookupFormat(SDL_PixelFormat *format, int bpp,
+		Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask);
+extern void SDL_CacheFormat(const SDL_PixelFormat *format, int bpp,
+		Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask);
+extern int SDL_LookupBlitMap(SDL_Surface *src, SDL_Surface *dst);
+extern void SDL_CacheBlitMap(SDL_Surface *src, SDL_Surface *dst);
+
 /* Miscellaneous functions */
 extern Uint16 SDL_CalculatePitch(SDL_Surface *surface);
 extern void SDL_DitherColors(SDL_Color *colors, int bpp);
@@ -0,0 +1,518 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* 
+   Code to load and save surfaces in SRF format.
+
+   SRF is a container for surfaces in their own pixel format: a fixed
+   size header describing the SDL_PixelFormat, pitch and blit settings,
+   an optional palette, and the pixel rows, either as they are in memory
+   or LZ4 compressed.  Since no decoding or conversion is needed, an
+   uncompressed container read from a mapped file can be blitted straight
+   out of the mapping, so loading costs only the pages actually touched.
+
+   The header layout, all values little-endian:
+	 0  magic "SDLS"
+	 4  Uint16 version, Uint16 header size
+	 8  Uint32 width, height, pitch
+	20  Uint8 BitsPerPixel, BytesPerPixel, encoding, pixel byte order
+	24  Uint32 Rmask, Gmask, Bmask, Amask
+	40  Uint32 flags, colorkey
+	48  Uint8 alpha, 3 reserved bytes
+	52  Uint16 palette colors, 2 reserved bytes
+	56  Uint32 pixel data offset, pixel data size
+   The palette follows the header as R,G,B,unused quadruplets, and the
+   pixel data starts on a 16 byte boundary.
+
+   RLE acceleration is recorded as a flag rather than as encoded data,
+   since the RLE stream depends on the destination of the blits; it is
+   rebuilt by the first blit as usual.
+*/
+
+#include "SDL_video.h"
+#include "SDL_endian.h"
+#include "SDL_blit.h"
+#include "../file/SDL_lz4_c.h"
+
+#define SRF_MAGIC		"SDLS"
+#define SRF_VERSION		1
+#define SRF_HEADER_SIZE		64
+#define SRF_DATA_ALIGN		16
+
+/* Pixel data encodings */
+#define SRF_ENCODING_RAW	0
+#define SRF_ENCODING_LZ4	1
+
+/* Pixel data byte orders */
+#define SRF_LIL_ENDIAN		0
+#define SRF_BIG_ENDIAN		1
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define SRF_NATIVE_ENDIAN	SRF_LIL_ENDIAN
+#else
+#define SRF_NATIVE_ENDIAN	SRF_BIG_ENDIAN
+#endif
+
+/* The surface flags kept in the container */
+#define SRF_SAVED_FLAGS		(SDL_SRCCOLORKEY|SDL_SRCALPHA|SDL_RLEACCELOK)
+
+static Uint16 SRF_Get16(const Uint8 *p)
+{
+	return (Uint16)(p[0] | (p[1] << 8));
+}
+static Uint32 SRF_Get32(const Uint8 *p)
+{
+	return (Uint32)p[0] | ((Uint32)p[1] << 8) |
+	       ((Uint32)p[2] << 16) | ((Uint32)p[3] << 24);
+}
+static void SRF_Put16(Uint8 *p, Uint16 value)
+{
+	p[0] = (Uint8)value;
+	p[1] = (Uint8)(value >> 8);
+}
+static void SRF_Put32(Uint8 *p, Uint32 value)
+{
+	p[0] = (Uint8)value;
+	p[1] = (Uint8)(value >> 8);
+	p[2] = (Uint8)(value >> 16);
+	p[3] = (Uint8)(value >> 24);
+}
+
+/* Borrow 'len' bytes at 'offset' from a source held in memory */
+static Uint8 *SRF_BorrowAt(SDL_RWops *src, int offset, int len, int writable)
+{
+	Uint8 *mem;
+	size_t avail;
+
+	if ( (offset < 0) || (len < 0) ||
+	     (SDL_RWseek(src, offset, RW_SEEK_SET) != offset) ) {
+		return(NULL);
+	}
+	mem = (Uint8 *)SDL_RWborrow(src, &avail, writable);
+	if ( (mem == NULL) || (avail < (size_t)len) ) {
+		return(NULL);
+	}
+	return(mem);
+}
+
+/* Swap the pixels of a surface loaded on a host of the other byte order */
+static void SRF_SwapPixels(SDL_Surface *surface)
+{
+	Uint8 *row = (Uint8 *)surface->pixels;
+	int x, y;
+
+	for ( y = 0; y < surface->h; ++y ) {
+		switch (surface->format->BytesPerPixel) {
+		    case 2: {
+			Uint16 *pix = (Uint16 *)row;
+			for ( x = 0; x < surface->w; ++x ) {
+				pix[x] = SDL_Swap16(pix[x]);
+			}
+		    }
+		    break;
+		    case 4: {
+			Uint32 *pix = (Uint32 *)row;
+			for ( x = 0; x < surface->w; ++x ) {
+				pix[x] = SDL_Swap32(pix[x]);
+			}
+		    }
+		    break;
+		}
+		row += surface->pitch;
+	}
+}
+
+SDL_Surface * SDL_LoadSRF_RW (SDL_RWops *src, int freesrc)
+{
+	SDL_bool was_error;
+	SDL_bool in_place;
+	int fp_offset = 0;
+	int fp_end;
+	Uint8 header[SRF_HEADER_SIZE];
+	Uint8 colors[256*4];
+	Uint16 version, headersize;
+	int width, height, pitch;
+	int bpp, Bpp, encoding, byteorder;
+	Uint32 Rmask, Gmask, Bmask, Amask;
+	Uint32 flags, colorkey;
+	Uint8 alpha;
+	int ncolors;
+	int dataoffset, datasize, rawsize;
+	SDL_Surface *surface;
+	Uint8 *data;
+	const Uint8 *stored;
+	const Uint8 *rows;
+	Uint8 *pixels;
+	int i;
+
+	/* Make sure we are passed a valid data source */
+	surface = NULL;
+	data = NULL;
+	in_place = SDL_FALSE;
+	was_error = SDL_FALSE;
+	if ( src == NULL ) {
+		was_error = SDL_TRUE;
+		goto done;
+	}
+
+	/* Read in the SRF header */
+	fp_offset = SDL_RWtell(src);
+	if ( SDL_RWread(src, header, SRF_HEADER_SIZE, 1) != 1 ) {
+		SDL_Error(SDL_EFREAD);
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	if ( SDL_memcmp(header, SRF_MAGIC, 4) != 0 ) {
+		SDL_SetError("File is not an SRF surface container");
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	version		= SRF_Get16(&header[4]);
+	headersize	= SRF_Get16(&header[6]);
+	width		= (int)SRF_Get32(&header[8]);
+	height		= (int)SRF_Get32(&header[12]);
+	pitch		= (int)SRF_Get32(&header[16]);
+	bpp		= header[20];
+	Bpp		= header[21];
+	encoding	= header[22];
+	byteorder	= header[23];
+	Rmask		= SRF_Get32(&header[24]);
+	Gmask		= SRF_Get32(&header[28]);
+	Bmask		= SRF_Get32(&header[32]);
+	Amask		= SRF_Get32(&header[36]);
+	flags		= SRF_Get32(&header[40]) & SRF_SAVED_FLAGS;
+	colorkey	= SRF_Get32(&header[44]);
+	alpha		= header[48];
+	ncolors		= SRF_Get16(&header[52]);
+	dataoffset	= (int)SRF_Get32(&header[56]);
+	datasize	= (int)SRF_Get32(&header[60]);
+
+	/* Sanity check everything we are going to rely on */
+	if ( version != SRF_VERSION ) {
+		SDL_SetError("Unsupported SRF version %d", version);
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	/* SDL_Surface pitch is 16 bits, so bound everything before it's
+	   multiplied together */
+	if ( (width <= 0) || (width >= 16384) ||
+	     (height <= 0) || (height >= 65536) ) {
+		SDL_SetError("SRF file with bad dimensions (%dx%d)", width, height);
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	if ( (bpp < 1) || (bpp > 32) || (Bpp != (bpp+7)/8) ||
+	     (pitch > 65535) || (pitch < width*Bpp) ||
+	     (height > 0x7FFFFFFF/pitch) ) {
+		SDL_SetError("SRF file with bad pixel layout");
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	rawsize = pitch*height;
+	if ( (headersize < SRF_HEADER_SIZE) ||
+	     (ncolors > ((Bpp == 1) ? (1 << bpp) : 0)) ||
+	     (dataoffset < headersize+ncolors*4) || (datasize < 0) ||
+	     ((encoding == SRF_ENCODING_RAW) && (datasize != rawsize)) ||
+	     (encoding > SRF_ENCODING_LZ4) || (byteorder > SRF_BIG_ENDIAN) ) {
+		SDL_SetError("Corrupt SRF file");
+		was_error = SDL_TRUE;
+		goto done;
+	}
+
+	/* Don't trust the header's size for anything the file doesn't hold */
+	fp_end = SDL_RWseek(src, 0, RW_SEEK_END);
+	if ( fp_end < 0 ) {
+		SDL_Error(SDL_EFSEEK);
+		was_error = SDL_TRUE;
+		goto done;
+	}
+	if ( (dataoffset > fp_end - fp_offset) ||
+	     (datasize > fp_end - fp_offset - dataoffset) ) {
+		SDL_SetError("Truncated SRF file");
+		was_error = SDL_TRUE;
+		goto done;
+	}
+
+	/* Read the palette, if any */
+	if ( ncolors ) {
+		if ( (SDL_RWseek(src, fp_offset+headersize, RW_SEEK_SET) < 0) ||
+		     (SDL_RWread(src, colors, 4, ncolors) != ncolors) ) {
+			SDL_Error(SDL_EFREAD);
+			was_error = SDL_TRUE;
+			goto done;
+		}
+	}
+
+	/* 24-bit pixels are plain bytes, only their masks change meaning */
+	if ( (byteorder != SRF_NATIVE_ENDIAN) && (Bpp == 3) ) {
+		Rmask = SDL_Swap32(Rmask) >> 8;
+		Gmask = SDL_Swap32(Gmask) >> 8;
+		Bmask = SDL_Swap32(Bmask) >> 8;
+	}
+
+	/* Use the pixels where they are if we can keep the source open */
+	pixels = NULL;
+	if ( freesrc && (encoding == SRF_ENCODING_RAW) &&
+	     ((byteorder == SRF_NATIVE_ENDIAN) || (Bpp == 1) || (Bpp == 3)) ) {
+		int align = (Bpp == 2 || Bpp == 4) ? Bpp : 1;
+
+		pixels = SRF_BorrowAt(src, fp_offset+dataoffset, datasize, 1);
+		if ( pixels && ((((uintptr_t)pixels) | pitch) & (align-1)) ) {
+			pixels = NULL;
+		}
+	}
+	if ( pixels ) {
+		in_place = SDL_TRUE;
+		surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, bpp,
+				pitch, Rmask, Gmask, Bmask, Amask);
+	} else {
+		surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height,
+				bpp, Rmask, Gmask, Bmask, Amask);
+	}
+	if ( surface == NULL ) {
+		was_error = SDL_TRUE;
+		goto done;
+	}
+
+	/* Load the palette, if any */
+	if ( ncolors && surface->format->palette ) {
+		SDL_Palette *palette = surface->format->palette;
+
+		for ( i = 0; i < ncolors; ++i ) {
+			palette->colors[i].r = colors[i*4+0];
+			palette->colors[i].g = colors[i*4+1];
+			palette->colors[i].b = colors[i*4+2];
+			palette->colors[i].unused = colors[i*4+3];
+		}
+		palette->ncolors = ncolors;
+	}
+
+	/* Copy or decompress the pixel data */
+	if ( ! in_place ) {
+		stored = SRF_BorrowAt(src, fp_offset+dataoffset, datasize, 0);
+		if ( stored == NULL ) {
+			data = (Uint8 *)SDL_malloc(datasize ? datasize : 1);
+			if ( data == NULL ) {
+				SDL_OutOfMemory();
+				was_error = SDL_TRUE;
+				goto done;
+			}
+			if ( (SDL_RWseek(src, fp_offset+dataoffset, RW_SEEK_SET) < 0) ||
+			     (SDL_RWread(src, data, 1, datasize) != datasize) ) {
+				SDL_Error(SDL_EFREAD);
+				was_error = SDL_TRUE;
+				goto done;
+			}
+			stored = data;
+		}
+
+		rows = stored;
+		if ( encoding == SRF_ENCODING_LZ4 ) {
+			Uint8 *raw = (Uint8 *)surface->pixels;
+
+			if ( pitch != surface->pitch ) {
+				raw = (Uint8 *)SDL_malloc(rawsize);
+				if ( raw == NULL ) {
+					SDL_OutOfMemory();
+					was_error = SDL_TRUE;
+					goto done;
+				}
+			}
+			if ( SDL_LZ4_Decompress(stored, datasize, raw, rawsize) != rawsize ) {
+				if ( raw != surface->pixels ) {
+					SDL_free(raw);
+				}
+				SDL_SetError("Corrupt SRF pixel data");
+				was_error = SDL_TRUE;
+				goto done;
+			}
+			if ( raw == surface->pixels ) {
+				rows = NULL;
+			} else {
+				SDL_free(data);
+				data = raw;
+				rows = raw;
+			}
+		}
+		if ( rows ) {
+			pixels = (Uint8 *)surface->pixels;
+			for ( i = 0; i < height; ++i ) {
+				SDL_memcpy(pixels, rows, width*Bpp);
+				pixels += surface->pitch;
+				rows += pitch;
+			}
+		}
+		if ( byteorder != SRF_NATIVE_ENDIAN ) {
+			SRF_SwapPixels(surface);
+		}
+	}
+
+	/* Restore the blit settings */
+	if ( flags & SDL_SRCCOLORKEY ) {
+		SDL_SetColorKey(surface, SDL_SRCCOLORKEY |
+			((flags & SDL_RLEACCELOK) ? SDL_RLEACCEL : 0), colorkey);
+	}
+	if ( flags & SDL_SRCALPHA ) {
+		SDL_SetAlpha(surface, SDL_SRCALPHA |
+			((flags & SDL_RLEACCELOK) ? SDL_RLEACCEL : 0), alpha);
+	} else if ( surface->flags & SDL_SRCALPHA ) {
+		SDL_SetAlpha(surface, 0, alpha);
+	}
+
+	/* The surface now owns the source its pixels live in */
+	if ( in_place ) {
+		surface->map->pixels_src = src;
+	}
+done:
+	if ( data ) {
+		SDL_free(data);
+	}
+	if ( was_error ) {
+		if ( src ) {
+			SDL_RWseek(src, fp_offset, RW_SEEK_SET);
+		}
+		if ( surface ) {
+			SDL_FreeSurface(surface);
+		}
+		surface = NULL;
+		in_place = SDL_FALSE;
+	}
+	if ( freesrc && src && !in_place ) {
+		SDL_RWclose(src);
+	}
+	return(surface);
+}
+
+int SDL_SaveSRF_RW (SDL_Surface *surface, SDL_RWops *dst, int freedst, Uint32 flags)
+{
+	Uint8 header[SRF_HEADER_SIZE];
+	Uint8 padding[SRF_DATA_ALIGN];
+	SDL_Palette *palette;
+	Uint8 *compressed;
+	const Uint8 *data;
+	int encoding;
+	int ncolors;
+	int headerend;
+	int dataoffset, datasize, rawsize;
+	int i;
+	int retval;
+
+	/* Make sure we have something to save */
+	retval = -1;
+	if ( dst == NULL ) {
+		goto done;
+	}
+	if ( SDL_LockSurface(surface) < 0 ) {
+		goto done;
+	}
+
+	palette = surface->format->palette;
+	ncolors = palette ? palette->ncolors : 0;
+	rawsize = surface->h * surface->pitch;
+
+	/* Compress the pixels, keeping them raw if that doesn't pay off */
+	compressed = NULL;
+	encoding = SRF_ENCODING_RAW;
+	data = (const Uint8 *)surface->pixels;
+	datasize = rawsize;
+	if ( flags & SDL_SRF_COMPRESS ) {
+		compressed = (Uint8 *)SDL_malloc(SDL_LZ4_COMPRESSBOUND(rawsize));
+		if ( compressed == NULL ) {
+			SDL_UnlockSurface(surface);
+			SDL_OutOfMemory();
+			goto done;
+		}
+		datasize = SDL_LZ4_Compress(surface->pixels, rawsize,
+				compressed, SDL_LZ4_COMPRESSBOUND(rawsize));
+		if ( (datasize >= 0) && (datasize < rawsize) ) {
+			encoding = SRF_ENCODING_LZ4;
+			data = compressed;
+		} else {
+			datasize = rawsize;
+		}
+	}
+	headerend = SRF_HEADER_SIZE + ncolors*4;
+	dataoffset = (headerend + SRF_DATA_ALIGN-1) & ~(SRF_DATA_ALIGN-1);
+
+	/* Set the SRF header values */
+	SDL_memset(header, 0, sizeof(header));
+	SDL_memcpy(header, SRF_MAGIC, 4);
+	SRF_Put16(&header[4], SRF_VERSION);
+	SRF_Put16(&header[6], SRF_HEADER_SIZE);
+	SRF_Put32(&header[8], surface->w);
+	SRF_Put32(&header[12], surface->h);
+	SRF_Put32(&header[16], surface->pitch);
+	header[20] = surface->format->BitsPerPixel;
+	header[21] = surface->format->BytesPerPixel;
+	header[22] = encoding;
+	header[23] = SRF_NATIVE_ENDIAN;
+	SRF_Put32(&header[24], surface->format->Rmask);
+	SRF_Put32(&header[28], surface->format->Gmask);
+	SRF_Put32(&header[32], surface->format->Bmask);
+	SRF_Put32(&header[36], surface->format->Amask);
+	SRF_Put32(&header[40], surface->flags & SRF_SAVED_FLAGS);
+	SRF_Put32(&header[44], surface->format->colorkey);
+	header[48] = surface->format->alpha;
+	SRF_Put16(&header[52], ncolors);
+	SRF_Put32(&header[56], dataoffset);
+	SRF_Put32(&header[60], datasize);
+
+	/* Write the header, the palette and the pixel data */
+	SDL_memset(padding, 0, sizeof(padding));
+	retval = 0;
+	if ( SDL_RWwrite(dst, header, SRF_HEADER_SIZE, 1) != 1 ) {
+		retval = -1;
+	}
+	for ( i = 0; (retval == 0) && (i < ncolors); ++i ) {
+		Uint8 color[4];
+
+		color[0] = palette->colors[i].r;
+		color[1] = palette->colors[i].g;
+		color[2] = palette->colors[i].b;
+		color[3] = palette->colors[i].unused;
+		if ( SDL_RWwrite(dst, color, 4, 1) != 1 ) {
+			retval = -1;
+		}
+	}
+	if ( (retval == 0) && (dataoffset > headerend) &&
+	     (SDL_RWwrite(dst, padding, dataoffset-headerend, 1) != 1) ) {
+		retval = -1;
+	}
+	if ( (retval == 0) && datasize &&
+	     (SDL_RWwrite(dst, data, datasize, 1) != 1) ) {
+		retval = -1;
+	}
+	if ( retval < 0 ) {
+		SDL_Error(SDL_EFWRITE);
+	}
+
+	if ( compressed ) {
+		SDL_free(compressed);
+	}
+	SDL_UnlockSurface(surface);
+done:
+	if ( freedst && dst ) {
+		SDL_RWclose(dst);
+	}
+	return(retval);
+}
@@ -120,14 +120,19 @@ SDL_Surface * SDL_CreateRGBSurface (Uint32 flags,
 	SDL_SetClipRect(surface, NULL);
 	SDL_FormatChanged(surface);
 
+	/* Allocate an empty mapping */
+	surface->map = SDL_AllocBlitMap();
+	if ( surface->map == NULL ) {
+		SDL_FreeSurface(surface);
+		return(NULL);
+	}
+
 	/* Get the pixels */
 	if ( ((flags&SDL_HWSURFACE) == SDL_SWSURFACE) || 
 				(video->AllocHWSurface(this, surface) < 0) ) {
 		if ( surface->w && surface->h ) {
-			surface->pixels = SDL_malloc(surface->h*surface->pitch);
-			if ( surface->pixels == NULL ) {
+			if ( SDL_AllocSurfacePixels(surface) < 0 ) {
 				SDL_FreeSurface(surface);
-				SDL_OutOfMemory();
 				return(NULL);
 			}
 			/* This is important for bitmaps */
@@ -135,13 +140,6 @@ SDL_Surface * SDL_CreateRGBSurface (Uint32 flags,
 		}
 	}
 
-	/* Allocate an empty mapping */
-	surface->map = SDL_AllocBlitMap();
-	if ( surface->map == NULL ) {
-		SDL_FreeSurface(surface);
-		return(NULL);
-	}
-
 	/* The surface is ready to go */
 	surface->refcount = 1;
 #ifdef CHECK_LEAKS
@@ -964,10 +962,6 @@ void SDL_FreeSurface (SDL_Surface *surface)
 		SDL_FreeFormat(surface->format);
 		surface->format = NULL;
 	}
-	if ( surface->map != NULL ) {
-		SDL_FreeBlitMap(surface->map);
-		surface->map = NULL;
-	}
 	if ( surface->hwdata ) {
 		SDL_VideoDevice *video = current_video;
 		SDL_VideoDevice *this  = current_video;
@@ -975,7 +969,15 @@ void SDL_FreeSurface (SDL_Surface *surface)
 	}
 	if ( surface->pixels &&
 	     ((surface->flags & SDL_PREALLOC) != SDL_PREALLOC) ) {
-		SDL_free(surface->pixels);
+		/* Before the map, which knows if the pixels are pooled */
+		SDL_FreeSurfacePixels(surface);
+	}
+	if ( surface->map != NULL ) {
+		if ( surface->map->pixels_src != NULL ) {
+			SDL_RWclose(surface->map->pixels_src);
+		}
+		SDL_FreeBlitMap(surface->map);
+		surface->map = NULL;
 	}
 	SDL_free(surface);
 #ifdef CHECK_LEAKS
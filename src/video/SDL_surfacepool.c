@@ -0,0 +1,528 @@
+/*
+    SDL - Simple DirectMedia Layer
+    Copyright (C) 1997-2012 Sam Lantinga
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Sam Lantinga
+    slouken@libsdl.org
+*/
+#include "SDL_config.h"
+
+/* A pool of surface pixel buffers, and caches of pixel formats and of
+   blit mappings */
+
+#include "SDL_video.h"
+#include "SDL_mutex.h"
+#include "SDL_pixels_c.h"
+
+/* Buffers are rounded up to a quarter of a power of two, so at most a
+   fifth of a buffer is wasted.  Bigger buffers aren't pooled.
+ */
+#define POOL_MIN_SIZE		256
+#define POOL_MAX_SIZE		(64*1024*1024)
+#define POOL_CLASSES		80
+
+/* Idle buffers kept by default, less where memory is tight */
+#if defined(__DREAMCAST__) || defined(__NDS__)
+#define POOL_DEFAULT_KB		256
+#elif defined(__VITA__)
+#define POOL_DEFAULT_KB		1024
+#else
+#define POOL_DEFAULT_KB		8192
+#endif
+
+/* Formats are only cached up to this many pairs of depth and masks */
+#define FORMAT_CACHE_SIZE	64
+
+/* Blit mappings are only cached for this many pairs of formats */
+#define BLITMAP_CACHE_SIZE	64
+
+typedef struct SDL_CachedFormat {
+	int bpp;
+	Uint32 Rmask, Gmask, Bmask, Amask;
+	SDL_PixelFormat format;
+} SDL_CachedFormat;
+
+/* The blit mapping worked out for a source and destination format,
+   with the source blit flags, color key and alpha */
+typedef struct SDL_BlitMapKey {
+	Uint32 flags;
+	Uint32 colorkey;
+	Uint8 alpha;
+	Uint8 src_bpp, dst_bpp;
+	Uint32 src_Rmask, src_Gmask, src_Bmask, src_Amask;
+	Uint32 dst_Rmask, dst_Gmask, dst_Bmask, dst_Amask;
+	int src_ncolors, dst_ncolors;
+} SDL_BlitMapKey;
+
+typedef struct SDL_CachedBlitMap {
+	SDL_BlitMapKey key;
+	SDL_Color *src_colors;	/* The palettes the table was made for */
+	SDL_Color *dst_colors;
+	int identity;
+	Uint8 *table;
+	size_t tablesize;
+	SDL_loblit blit;
+	void *aux_data;
+	const char *name;
+} SDL_CachedBlitMap;
+
+static SDL_mutex *pool_lock = NULL;
+static size_t pool_limit = 0;
+static void *pool_free[POOL_CLASSES];
+static SDL_CachedFormat format_cache[FORMAT_CACHE_SIZE];
+static int format_cached[FORMAT_CACHE_SIZE];
+static SDL_CachedBlitMap blitmap_cache[BLITMAP_CACHE_SIZE];
+static SDL_SurfacePoolStats pool_stats;
+
+/* Find the size class for a buffer, and the size of its buffers */
+static int SDL_PoolClass(size_t size, size_t *classsize)
+{
+	size_t mantissa;
+	int shift;
+
+	if ( size < POOL_MIN_SIZE ) {
+		size = POOL_MIN_SIZE;
+	}
+	--size;
+	shift = 5;
+	while ( (size >> shift) >= 8 ) {
+		++shift;
+	}
+	mantissa = (size >> shift) + 1;
+	*classsize = (mantissa << shift);
+	return((shift - 5) * 4 + (int)(mantissa - 4));
+}
+
+/* The size of the buffers in a size class, the reverse of SDL_PoolClass() */
+static size_t SDL_PoolClassSize(int sizeclass)
+{
+	return((size_t)(5 + (sizeclass - 1) % 4) << (5 + (sizeclass - 1) / 4));
+}
+
+/* Free idle buffers, biggest first, down to the pool limit.
+   Called with the pool locked.
+ */
+static void SDL_TrimSurfacePool(void)
+{
+	void *pixels;
+	int i;
+
+	for ( i = POOL_CLASSES-1; i > 0; --i ) {
+		while ( pool_free[i] && (pool_stats.pooled_bytes > pool_limit) ) {
+			pixels = pool_free[i];
+			pool_free[i] = *(void **)pixels;
+			pool_stats.pooled_bytes -= SDL_PoolClassSize(i);
+			SDL_free(pixels);
+		}
+	}
+}
+
+static size_t SDL_SurfacePoolLimit(const char *env)
+{
+	if ( env && *env ) {
+		return((size_t)SDL_atoi(env) * 1024);
+	}
+	return(POOL_DEFAULT_KB * 1024);
+}
+
+/* SDL_putenv() of SDL_SURFACE_POOL resizes the running pool */
+static void SDLCALL SDL_SurfacePoolChanged(void *userdata, const char *name,
+						const char *value)
+{
+	SDL_mutexP(pool_lock);
+	pool_limit = SDL_SurfacePoolLimit(value);
+	SDL_TrimSurfacePool();
+	SDL_mutexV(pool_lock);
+}
+
+static void SDL_ClearBlitMap(SDL_CachedBlitMap *cached)
+{
+	if ( cached->src_colors ) {
+		SDL_free(cached->src_colors);
+	}
+	if ( cached->dst_colors ) {
+		SDL_free(cached->dst_colors);
+	}
+	if ( cached->table ) {
+		SDL_free(cached->table);
+	}
+	SDL_memset(cached, 0, sizeof(*cached));
+}
+
+void SDL_SurfacePoolInit(void)
+{
+	SDL_memset(&pool_stats, 0, sizeof(pool_stats));
+	pool_limit = SDL_SurfacePoolLimit(SDL_getenv("SDL_SURFACE_POOL"));
+	pool_lock = SDL_CreateMutex();
+	if ( pool_lock ) {
+		SDL_AddEnvCallback("SDL_SURFACE_POOL",
+					SDL_SurfacePoolChanged, NULL);
+	}
+}
+
+void SDL_SurfacePoolQuit(void)
+{
+	void *pixels;
+	int i;
+
+	if ( pool_lock ) {
+		SDL_DelEnvCallback("SDL_SURFACE_POOL",
+					SDL_SurfacePoolChanged, NULL);
+		SDL_DestroyMutex(pool_lock);
+		pool_lock = NULL;
+	}
+	for ( i = 0; i < POOL_CLASSES; ++i ) {
+		while ( pool_free[i] ) {
+			pixels = pool_free[i];
+			pool_free[i] = *(void **)pixels;
+			SDL_free(pixels);
+		}
+	}
+	pool_stats.pooled_bytes = 0;
+	SDL_memset(format_cached, 0, sizeof(format_cached));
+	for ( i = 0; i < BLITMAP_CACHE_SIZE; ++i ) {
+		SDL_ClearBlitMap(&blitmap_cache[i]);
+	}
+}
+
+/*
+ * Allocate the pixels for a software surface, which must have its blit
+ * map.  The map remembers a pooled buffer, so it goes back to the pool
+ * only if the surface still points at it when it is freed.  Any buffer
+ * may also be released with SDL_free(), so the pool can go away first.
+ */
+int SDL_AllocSurfacePixels(SDL_Surface *surface)
+{
+	size_t size = (size_t)surface->h * surface->pitch;
+	size_t classsize;
+	void *pixels = NULL;
+	int sizeclass;
+
+	if ( pool_lock && pool_limit && size <= POOL_MAX_SIZE ) {
+		sizeclass = SDL_PoolClass(size, &classsize);
+		SDL_mutexP(pool_lock);
+		if ( pool_free[sizeclass] ) {
+			pixels = pool_free[sizeclass];
+			pool_free[sizeclass] = *(void **)pixels;
+			pool_stats.pooled_bytes -= classsize;
+			++pool_stats.pixel_hits;
+		} else {
+			++pool_stats.pixel_misses;
+		}
+		SDL_mutexV(pool_lock);
+		if ( pixels == NULL ) {
+			pixels = SDL_malloc(classsize);
+		}
+		if ( pixels != NULL ) {
+			surface->map->pool_pixels = pixels;
+			surface->map->pool_size = classsize;
+		}
+	} else {
+		pixels = SDL_malloc(size);
+	}
+	if ( pixels == NULL ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	surface->pixels = pixels;
+	return(0);
+}
+
+void SDL_FreeSurfacePixels(SDL_Surface *surface)
+{
+	SDL_BlitMap *map = surface->map;
+	void *pixels = surface->pixels;
+	size_t classsize;
+	int sizeclass;
+
+	surface->pixels = NULL;
+	if ( pixels == NULL ) {
+		return;
+	}
+	if ( map && (pixels == map->pool_pixels) ) {
+		map->pool_pixels = NULL;
+		if ( pool_lock ) {
+			sizeclass = SDL_PoolClass(map->pool_size, &classsize);
+			SDL_mutexP(pool_lock);
+			if ( pool_stats.pooled_bytes + classsize <= pool_limit ) {
+				*(void **)pixels = pool_free[sizeclass];
+				pool_free[sizeclass] = pixels;
+				pool_stats.pooled_bytes += classsize;
+				++pool_stats.pixel_releases;
+				pixels = NULL;
+			} else {
+				++pool_stats.pixel_discards;
+			}
+			SDL_mutexV(pool_lock);
+		}
+	}
+	if ( pixels ) {
+		SDL_free(pixels);
+	}
+}
+
+static int SDL_FormatHash(int bpp, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+{
+	Uint32 hash = bpp;
+
+	hash = hash * 31 + Rmask;
+	hash = hash * 31 + Gmask;
+	hash = hash * 31 + Bmask;
+	hash = hash * 31 + Amask;
+	return((int)((hash ^ (hash >> 16)) % FORMAT_CACHE_SIZE));
+}
+
+/*
+ * Copy the cached format for a depth and masks into 'format'.
+ * Returns 1 if it was cached, or 0 if it has to be worked out.
+ */
+int SDL_LookupFormat(SDL_PixelFormat *format, int bpp,
+			Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+{
+	SDL_CachedFormat *cached;
+	int i, found = 0;
+
+	if ( pool_lock == NULL ) {
+		return(0);
+	}
+	i = SDL_FormatHash(bpp, Rmask, Gmask, Bmask, Amask);
+	cached = &format_cache[i];
+	SDL_mutexP(pool_lock);
+	if ( format_cached[i] &&
+	     (cached->bpp == bpp) && (cached->Rmask == Rmask) &&
+	     (cached->Gmask == Gmask) && (cached->Bmask == Bmask) &&
+	     (cached->Amask == Amask) ) {
+		SDL_memcpy(format, &cached->format, sizeof(*format));
+		++pool_stats.format_hits;
+		found = 1;
+	} else {
+		++pool_stats.format_misses;
+	}
+	SDL_mutexV(pool_lock);
+	return(found);
+}
+
+/* Cache a freshly worked out format, replacing any other in its slot */
+void SDL_CacheFormat(const SDL_PixelFormat *format, int bpp,
+			Uint32 Rmask, Uint32 Gmask, Uint32 Bmask, Uint32 Amask)
+{
+	SDL_CachedFormat *cached;
+	int i;
+
+	if ( (pool_lock == NULL) || format->palette ) {
+		return;
+	}
+	i = SDL_FormatHash(bpp, Rmask, Gmask, Bmask, Amask);
+	cached = &format_cache[i];
+	SDL_mutexP(pool_lock);
+	cached->bpp = bpp;
+	cached->Rmask = Rmask;
+	cached->Gmask = Gmask;
+	cached->Bmask = Bmask;
+	cached->Amask = Amask;
+	SDL_memcpy(&cached->format, format, sizeof(*format));
+	format_cached[i] = 1;
+	SDL_mutexV(pool_lock);
+}
+
+/*
+ * Hardware surfaces, RLE encoding and blits within one surface depend on
+ * more than the formats, so those are always worked out from scratch.
+ */
+static int SDL_BlitMapCacheable(SDL_Surface *src, SDL_Surface *dst)
+{
+	return( pool_lock && (src != dst) &&
+		!(src->flags & (SDL_HWSURFACE|SDL_RLEACCELOK)) &&
+		!(dst->flags & SDL_HWSURFACE) );
+}
+
+static int SDL_BlitMapHash(SDL_Surface *src, SDL_Surface *dst, SDL_BlitMapKey *key)
+{
+	SDL_PixelFormat *sf = src->format;
+	SDL_PixelFormat *df = dst->format;
+	const Uint8 *data;
+	Uint32 hash;
+	size_t i;
+
+	SDL_memset(key, 0, sizeof(*key));
+	key->flags = src->flags & (SDL_SRCCOLORKEY|SDL_SRCALPHA);
+	if ( key->flags & SDL_SRCCOLORKEY ) {
+		key->colorkey = sf->colorkey;
+	}
+	key->alpha = sf->alpha;
+	key->src_bpp = sf->BitsPerPixel;
+	key->src_Rmask = sf->Rmask;
+	key->src_Gmask = sf->Gmask;
+	key->src_Bmask = sf->Bmask;
+	key->src_Amask = sf->Amask;
+	key->src_ncolors = sf->palette ? sf->palette->ncolors : 0;
+	key->dst_bpp = df->BitsPerPixel;
+	key->dst_Rmask = df->Rmask;
+	key->dst_Gmask = df->Gmask;
+	key->dst_Bmask = df->Bmask;
+	key->dst_Amask = df->Amask;
+	key->dst_ncolors = df->palette ? df->palette->ncolors : 0;
+
+	/* FNV-1a over the key; palettes are compared, but not hashed */
+	hash = 2166136261u;
+	data = (const Uint8 *)key;
+	for ( i = 0; i < sizeof(*key); ++i ) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return((int)(hash % BLITMAP_CACHE_SIZE));
+}
+
+static int SDL_PaletteMatches(SDL_Palette *pal, SDL_Color *colors, int ncolors)
+{
+	if ( ncolors == 0 ) {
+		return(1);
+	}
+	return(SDL_memcmp(pal->colors, colors, ncolors*sizeof(SDL_Color)) == 0);
+}
+
+/*
+ * Set up the blit mapping from 'src' to 'dst' the way it was last worked
+ * out for the same formats, without building color tables or choosing
+ * blitters again.  The map has been invalidated by the caller.
+ * Returns 1 if the mapping was cached, 0 if not, or -1 if out of memory.
+ */
+int SDL_LookupBlitMap(SDL_Surface *src, SDL_Surface *dst)
+{
+	SDL_BlitMap *map = src->map;
+	SDL_CachedBlitMap *cached;
+	SDL_BlitMapKey key;
+	int found = 0;
+
+	if ( !SDL_BlitMapCacheable(src, dst) ) {
+		return(0);
+	}
+	cached = &blitmap_cache[SDL_BlitMapHash(src, dst, &key)];
+	SDL_mutexP(pool_lock);
+	if ( cached->blit &&
+	     (SDL_memcmp(&cached->key, &key, sizeof(key)) == 0) &&
+	     SDL_PaletteMatches(src->format->palette,
+				cached->src_colors, key.src_ncolors) &&
+	     SDL_PaletteMatches(dst->format->palette,
+				cached->dst_colors, key.dst_ncolors) ) {
+		found = 1;
+		if ( cached->table ) {
+			map->table = (Uint8 *)SDL_malloc(cached->tablesize);
+			if ( map->table == NULL ) {
+				found = -1;
+			} else {
+				SDL_memcpy(map->table, cached->table,
+						cached->tablesize);
+			}
+		}
+		map->identity = cached->identity;
+		map->sw_data->blit = cached->blit;
+		map->sw_data->aux_data = cached->aux_data;
+		map->sw_data->name = cached->name;
+		++pool_stats.blitmap_hits;
+	} else {
+		++pool_stats.blitmap_misses;
+	}
+	SDL_mutexV(pool_lock);
+
+	if ( found < 0 ) {
+		SDL_OutOfMemory();
+		return(-1);
+	}
+	if ( found ) {
+		src->flags &= ~SDL_HWACCEL;
+		map->sw_blit = SDL_SoftBlit;
+		map->dst = dst;
+		map->format_version = dst->format_version;
+		if ( SDL_blitstats_enabled ) {
+			SDL_ProfileBlit(src);
+		}
+	}
+	return(found);
+}
+
+/* Remember the blit mapping just worked out from 'src' to 'dst' */
+void SDL_CacheBlitMap(SDL_Surface *src, SDL_Surface *dst)
+{
+	SDL_BlitMap *map = src->map;
+	SDL_CachedBlitMap *cached;
+	SDL_BlitMapKey key;
+	SDL_Palette *pal;
+	int bpp;
+
+	/* The blitter may still have chosen RLE or hardware acceleration */
+	if ( !SDL_BlitMapCacheable(src, dst) ||
+	     (src->flags & (SDL_HWACCEL|SDL_RLEACCEL)) ) {
+		return;
+	}
+	cached = &blitmap_cache[SDL_BlitMapHash(src, dst, &key)];
+	SDL_mutexP(pool_lock);
+	SDL_ClearBlitMap(cached);
+	SDL_memcpy(&cached->key, &key, sizeof(key));
+	if ( key.src_ncolors ) {
+		pal = src->format->palette;
+		cached->src_colors = (SDL_Color *)SDL_malloc(key.src_ncolors*sizeof(SDL_Color));
+		if ( cached->src_colors ) {
+			SDL_memcpy(cached->src_colors, pal->colors,
+					key.src_ncolors*sizeof(SDL_Color));
+		}
+	}
+	if ( key.dst_ncolors ) {
+		pal = dst->format->palette;
+		cached->dst_colors = (SDL_Color *)SDL_malloc(key.dst_ncolors*sizeof(SDL_Color));
+		if ( cached->dst_colors ) {
+			SDL_memcpy(cached->dst_colors, pal->colors,
+					key.dst_ncolors*sizeof(SDL_Color));
+		}
+	}
+	if ( map->table ) {
+		/* Palette to bitfield tables hold a pixel per color */
+		if ( (src->format->BytesPerPixel == 1) &&
+		     (dst->format->BytesPerPixel != 1) ) {
+			bpp = dst->format->BytesPerPixel;
+			cached->tablesize = 256 * ((bpp == 3) ? 4 : bpp);
+		} else {
+			cached->tablesize = 256;
+		}
+		cached->table = (Uint8 *)SDL_malloc(cached->tablesize);
+		if ( cached->table ) {
+			SDL_memcpy(cached->table, map->table, cached->tablesize);
+		}
+	}
+	if ( (key.src_ncolors && !cached->src_colors) ||
+	     (key.dst_ncolors && !cached->dst_colors) ||
+	     (map->table && !cached->table) ) {
+		/* Out of memory, just don't cache it */
+		SDL_ClearBlitMap(cached);
+	} else {
+		cached->identity = map->identity;
+		cached->blit = map->sw_data->blit;
+		cached->aux_data = map->sw_data->aux_data;
+		cached->name = map->sw_data->name;
+	}
+	SDL_mutexV(pool_lock);
+}
+
+void SDL_GetSurfacePoolStats(SDL_SurfacePoolStats *stats)
+{
+	if ( pool_lock ) {
+		SDL_mutexP(pool_lock);
+	}
+	SDL_memcpy(stats, &pool_stats, sizeof(*stats));
+	if ( pool_lock ) {
+		SDL_mutexV(pool_lock);
+	}
+}
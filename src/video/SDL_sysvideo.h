@@ -40,6 +40,10 @@
 /* The SDL video driver */
 typedef struct SDL_VideoDevice SDL_VideoDevice;
 
+/* The block size of the video scratch arena.  Users keep under it, so
+   the arena holds one block of this size and never grows. */
+#define SDL_VIDEO_SCRATCH_SIZE	(64*1024)
+
 /* Define the SDL video driver structure */
 #define _THIS	SDL_VideoDevice *_this
 #ifndef _STATUS
@@ -164,6 +168,11 @@ struct SDL_VideoDevice {
 	/* Get the gamma ramp */
 	int (*GetGammaRamp)(_THIS, Uint16 *ramp);
 
+	/* Software gamma correction of the shadow surface updates, used
+	   when the driver can't set a gamma ramp (see SDL_gamma.c) */
+	int use_softgamma;
+	struct SDL_SoftGamma *softgamma;
+
 	/* * * */
 	/* OpenGL support */
 
@@ -265,6 +274,9 @@ struct SDL_VideoDevice {
 	SDL_Surface *visible;
         SDL_Palette *physpal;	/* physical palette, if != logical palette */
         SDL_Color *gammacols;	/* gamma-corrected colours, or NULL */
+	SDL_Arena *scratch;	/* temporary buffers, reset by each user,
+				   each under SDL_VIDEO_SCRATCH_SIZE bytes */
+	Uint32 scratch_thread;	/* the only thread using the scratch arena */
 	char *wm_title;
 	char *wm_icon;
 	int offset_x;
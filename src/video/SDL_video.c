@@ -28,6 +28,7 @@
 #include "SDL_blit.h"
 #include "SDL_pixels_c.h"
 #include "SDL_cursor_c.h"
+#include "SDL_gamma_c.h"
 #include "../events/SDL_sysevents.h"
 #include "../events/SDL_events_c.h"
 
@@ -223,7 +224,12 @@ int SDL_VideoInit (const char *driver_name, Uint32 flags)
 	video->visible = NULL;
 	video->physpal = NULL;
 	video->gammacols = NULL;
+	video->scratch = SDL_CreateArena(SDL_VIDEO_SCRATCH_SIZE);
+	video->scratch_thread = SDL_ThreadID();
+	SDL_SurfacePoolInit();
 	video->gamma = NULL;
+	video->use_softgamma = 0;
+	video->softgamma = NULL;
 	video->wm_title = NULL;
 	video->wm_icon  = NULL;
 	video->offset_x = 0;
@@ -684,6 +690,8 @@ SDL_Surface * SDL_SetVideoMode (int width, int height, int bpp, Uint32 flags)
 		SDL_free(video->gammacols);
 		video->gammacols = NULL;
 	}
+	SDL_FreeSoftGamma(video);
+	video->use_softgamma = 0;
 
 	/* Save the previous grab state and turn off grab for mode switch */
 	saved_grab = SDL_WM_GrabInputOff();
@@ -896,13 +904,16 @@ SDL_Surface * SDL_SetVideoMode (int width, int height, int bpp, Uint32 flags)
 	}
 
 	/* Create a shadow surface if necessary */
-	/* There are three conditions under which we create a shadow surface:
+	/* There are four conditions under which we create a shadow surface:
 		1.  We need a particular bits-per-pixel that we didn't get.
 		2.  We need a hardware palette and didn't get one.
 		3.  We need a software surface and got a hardware surface.
+		4.  We need software gamma correction of the screen updates.
 	*/
+	video->use_softgamma = SDL_SoftGammaRequested(video, bpp);
 	if ( !(SDL_VideoSurface->flags & SDL_OPENGL) &&
 	     (
+	     video->use_softgamma ||
 	     (  !(flags&SDL_ANYFORMAT) &&
 			(SDL_VideoSurface->format->BitsPerPixel != bpp)) ||
 	     (   (flags&SDL_HWPALETTE) && 
@@ -925,6 +936,10 @@ SDL_Surface * SDL_SetVideoMode (int width, int height, int bpp, Uint32 flags)
 	} else {
 		SDL_PublicSurface = SDL_VideoSurface;
 	}
+	if ( video->use_softgamma && video->gamma ) {
+		/* Rebuild the gamma tables for the new video format */
+		SDL_SetGammaRamp(NULL, NULL, NULL);
+	}
 	video->info.vfmt = SDL_VideoSurface->format;
 	video->info.current_w = SDL_VideoSurface->w;
 	video->info.current_h = SDL_VideoSurface->h;
@@ -1075,14 +1090,14 @@ void SDL_UpdateRects (SDL_Surface *screen, int numrects, SDL_Rect *rects)
 			SDL_LockCursor();
 			SDL_DrawCursor(SDL_ShadowSurface);
 			for ( i=0; i<numrects; ++i ) {
-				SDL_LowerBlit(SDL_ShadowSurface, &rects[i], 
+				SDL_SoftGammaBlit(SDL_ShadowSurface, &rects[i], 
 						SDL_VideoSurface, &rects[i]);
 			}
 			SDL_EraseCursor(SDL_ShadowSurface);
 			SDL_UnlockCursor();
 		} else {
 			for ( i=0; i<numrects; ++i ) {
-				SDL_LowerBlit(SDL_ShadowSurface, &rects[i], 
+				SDL_SoftGammaBlit(SDL_ShadowSurface, &rects[i], 
 						SDL_VideoSurface, &rects[i]);
 			}
 		}
@@ -1141,12 +1156,12 @@ int SDL_Flip(SDL_Surface *screen)
 		if ( SHOULD_DRAWCURSOR(SDL_cursorstate) ) {
 			SDL_LockCursor();
 			SDL_DrawCursor(SDL_ShadowSurface);
-			SDL_LowerBlit(SDL_ShadowSurface, &rect,
+			SDL_SoftGammaBlit(SDL_ShadowSurface, &rect,
 					SDL_VideoSurface, &rect);
 			SDL_EraseCursor(SDL_ShadowSurface);
 			SDL_UnlockCursor();
 		} else {
-			SDL_LowerBlit(SDL_ShadowSurface, &rect,
+			SDL_SoftGammaBlit(SDL_ShadowSurface, &rect,
 					SDL_VideoSurface, &rect);
 		}
 		if ( saved_colors ) {
@@ -1401,6 +1416,12 @@ void SDL_VideoQuit (void)
 			SDL_free(video->gamma);
 			video->gamma = NULL;
 		}
+		if ( video->scratch ) {
+			SDL_FreeArena(video->scratch);
+			video->scratch = NULL;
+		}
+		SDL_SurfacePoolQuit();
+		SDL_FreeSoftGamma(video);
 		if ( video->wm_title != NULL ) {
 			SDL_free(video->wm_title);
 			video->wm_title = NULL;
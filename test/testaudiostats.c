@@ -0,0 +1,142 @@
+
+/* Plays silence through the dummy audio driver, or SDL_AUDIODRIVER if
+   set, and checks the audio thread timings from SDL_GetAudioStats().
+
+   testaudiostats [seconds] [load]	how long to play (default 2) and
+					the percentage of each buffer's play
+					time the callback spins for (default 25)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+static Uint64 spin_ticks;
+
+static void SDLCALL fill_audio(void *udata, Uint8 *stream, int len)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+
+	while ( (SDL_GetPerformanceCounter() - start) < spin_ticks ) {
+		/* Pretend to be mixing */ ;
+	}
+}
+
+static void print_timing(const char *stage, const SDL_AudioTiming *timing)
+{
+	printf("  %-8s %8u %8u %8u\n", stage,
+		timing->last, timing->average, timing->max);
+}
+
+static int check_timing(const char *stage, const SDL_AudioTiming *timing)
+{
+	if ( (timing->last > timing->max) || (timing->average > timing->max) ) {
+		fprintf(stderr, "%s timing is inconsistent\n", stage);
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_AudioSpec spec;
+	SDL_AudioStats stats;
+	Uint32 expected, histogram, buffer_time, spin_time;
+	int i, seconds = 2, load = 25, errors = 0;
+
+	if ( argc > 1 ) {
+		seconds = atoi(argv[1]);
+	}
+	if ( argc > 2 ) {
+		load = atoi(argv[2]);
+	}
+	if ( (seconds <= 0) || (load < 0) || (load > 100) ) {
+		fprintf(stderr, "Usage: %s [seconds] [load]\n", argv[0]);
+		return 1;
+	}
+
+	if ( !SDL_getenv("SDL_AUDIODRIVER") ) {
+		SDL_putenv("SDL_AUDIODRIVER=dummy");
+	}
+	if ( SDL_Init(SDL_INIT_AUDIO) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	if ( SDL_GetAudioStats(&stats) == 0 ) {
+		fprintf(stderr, "Got audio stats with no audio device open\n");
+		++errors;
+	}
+
+	SDL_memset(&spec, 0, sizeof(spec));
+	spec.freq = 22050;
+	spec.format = AUDIO_S16SYS;
+	spec.channels = 1;
+	spec.samples = 512;
+	spec.callback = fill_audio;
+	if ( SDL_OpenAudio(&spec, NULL) < 0 ) {
+		fprintf(stderr, "Couldn't open audio: %s\n", SDL_GetError());
+		return 1;
+	}
+	buffer_time = (Uint32)(((Uint64)spec.samples * 1000000) / spec.freq);
+	spin_time = (buffer_time * load) / 100;
+	spin_ticks = ((Uint64)spin_time * SDL_GetPerformanceFrequency()) / 1000000;
+
+	SDL_PauseAudio(0);
+	SDL_Delay(seconds * 1000);
+	if ( SDL_GetAudioStats(&stats) < 0 ) {
+		fprintf(stderr, "Couldn't get audio stats: %s\n", SDL_GetError());
+		SDL_CloseAudio();
+		return 1;
+	}
+	SDL_CloseAudio();
+
+	printf("%u buffers of %u us, %u underruns, %u late, %u dropped\n",
+		stats.buffers, stats.buffer_time,
+		stats.underruns, stats.late, stats.dropped);
+	printf("  %-8s %8s %8s %8s\n", "us", "last", "average", "max");
+	print_timing("callback", &stats.callback);
+	print_timing("convert", &stats.convert);
+	print_timing("play", &stats.play);
+	print_timing("wait", &stats.wait);
+	printf("  Time to fill a buffer, in eighths of its play time:\n ");
+	histogram = 0;
+	for ( i = 0; i < SDL_AUDIO_HISTOGRAM_BUCKETS; ++i ) {
+		printf(" %u", stats.histogram[i]);
+		histogram += stats.histogram[i];
+	}
+	printf("\n");
+
+	/* The device wants a buffer every buffer_time, give or take */
+	expected = (Uint32)(((Uint64)seconds * 1000000) / buffer_time);
+	if ( (stats.buffers < expected / 2) || (stats.buffers > expected * 2) ) {
+		fprintf(stderr, "Expected about %u buffers\n", expected);
+		++errors;
+	}
+	if ( (stats.buffer_time + 1 < buffer_time) ||
+	     (stats.buffer_time > buffer_time + 1) ) {
+		fprintf(stderr, "Expected buffers of %u us\n", buffer_time);
+		++errors;
+	}
+	if ( histogram != stats.buffers ) {
+		fprintf(stderr, "The histogram holds %u buffers\n", histogram);
+		++errors;
+	}
+	errors += check_timing("callback", &stats.callback);
+	errors += check_timing("convert", &stats.convert);
+	errors += check_timing("play", &stats.play);
+	errors += check_timing("wait", &stats.wait);
+	if ( stats.callback.max < spin_time ) {
+		fprintf(stderr, "The callback spins for %u us\n", spin_time);
+		++errors;
+	}
+	if ( (load <= 50) && (stats.underruns > stats.buffers / 10) ) {
+		fprintf(stderr, "Too many underruns for a %d%% load\n", load);
+		++errors;
+	}
+
+	printf("%d errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -1,6 +1,9 @@
 /*
  * Benchmarks surface-to-surface blits in various formats.
  *
+ *  Run with --sweep to benchmark all the format pairs and blit modes
+ *  without a window, see run_sweep() below.
+ *
  *  Written by Ryan C. Gordon.
  */
 
@@ -405,9 +408,361 @@ static void test_blit_speed(void)
             (int) (((float)iterations) / (((float)elasped) / 1000.0f)));
 }
 
+/*
+ * --sweep: headless benchmark of every format pair and blit mode.
+ *  Prints one CSV line per case, so runs can be compared across builds.
+ */
+
+typedef struct
+{
+    const char *name;
+    int bpp;
+    Uint32 rmask, gmask, bmask, amask;
+} sweep_format;
+
+static const sweep_format sweep_formats[] =
+{
+    { "INDEX8",   8,  0x00000000, 0x00000000, 0x00000000, 0x00000000 },
+    { "RGB555",   15, 0x00007C00, 0x000003E0, 0x0000001F, 0x00000000 },
+    { "RGB565",   16, 0x0000F800, 0x000007E0, 0x0000001F, 0x00000000 },
+    { "BGR565",   16, 0x0000001F, 0x000007E0, 0x0000F800, 0x00000000 },
+    { "RGB24",    24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000 },
+    { "BGR24",    24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0x00000000 },
+    { "RGB888",   32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000 },
+    { "BGR888",   32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0x00000000 },
+    { "ARGB8888", 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 },
+    { "RGBA8888", 32, 0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF },
+    { "ABGR8888", 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 },
+    { "BGRA8888", 32, 0x0000FF00, 0x00FF0000, 0xFF000000, 0x000000FF },
+};
+
+#define SWEEP_COPY      0
+#define SWEEP_KEY       1
+#define SWEEP_RLEKEY    2
+#define SWEEP_SALPHA    3
+#define SWEEP_PALPHA    4
+#define SWEEP_RLEALPHA  5
+
+static const char *sweep_modes[] =
+{
+    "copy", "key", "rlekey", "salpha", "palpha", "rlealpha"
+};
+
+#define SWEEP_ARRAYSIZE(a) ((int) (sizeof (a) / sizeof ((a)[0])))
+
+static int sweep_find_format(const char *name)
+{
+    int i;
+    for (i = 0; i < SWEEP_ARRAYSIZE(sweep_formats); i++)
+    {
+        if (strcmp(name, sweep_formats[i].name) == 0)
+            return(i);
+    }
+    fprintf(stderr, "Unknown format: %s\n", name);
+    return(-1);
+}
+
+static int sweep_find_mode(const char *name)
+{
+    int i;
+    for (i = 0; i < SWEEP_ARRAYSIZE(sweep_modes); i++)
+    {
+        if (strcmp(name, sweep_modes[i]) == 0)
+            return(i);
+    }
+    fprintf(stderr, "Unknown blit mode: %s\n", name);
+    return(-1);
+}
+
+static SDL_Surface *sweep_surface(const sweep_format *fmt, int w, int h)
+{
+    SDL_Surface *surface;
+    SDL_Color colors[256];
+    int x, y;
+
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, fmt->bpp,
+                                   fmt->rmask, fmt->gmask, fmt->bmask,
+                                   fmt->amask);
+    if (surface == NULL)
+        return(NULL);
+
+    if (surface->format->palette)
+    {
+        for (x = 0; x < 256; x++)
+        {
+            colors[x].r = (Uint8) (x & 0xE0);
+            colors[x].g = (Uint8) ((x << 3) & 0xE0);
+            colors[x].b = (Uint8) ((x << 6) & 0xC0);
+        }
+        SDL_SetColors(surface, colors, 0, 256);
+    }
+
+    /* Noise, with about a quarter of it black for the colorkey tests,
+       and every level of alpha. */
+    SDL_LockSurface(surface);
+    for (y = 0; y < h; y++)
+    {
+        Uint8 *row = (Uint8 *) surface->pixels + y * surface->pitch;
+        for (x = 0; x < w; x++)
+        {
+            Uint32 pixel = 0;
+            Uint8 *p = row + x * surface->format->BytesPerPixel;
+            if ((rand() & 3) != 0)
+            {
+                pixel = SDL_MapRGBA(surface->format,
+                                    (Uint8) rand(), (Uint8) rand(),
+                                    (Uint8) rand(), (Uint8) rand());
+            }
+            switch (surface->format->BytesPerPixel)
+            {
+                case 1: *p = (Uint8) pixel; break;
+                case 2: *(Uint16 *) p = (Uint16) pixel; break;
+                case 3:
+                    #if SDL_BYTEORDER == SDL_LIL_ENDIAN
+                    p[0] = (Uint8) pixel;
+                    p[1] = (Uint8) (pixel >> 8);
+                    p[2] = (Uint8) (pixel >> 16);
+                    #else
+                    p[0] = (Uint8) (pixel >> 16);
+                    p[1] = (Uint8) (pixel >> 8);
+                    p[2] = (Uint8) pixel;
+                    #endif
+                    break;
+                case 4: *(Uint32 *) p = pixel; break;
+            }
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return(surface);
+}
+
+/* Sets up 'src' for the blit mode, returns 0 if it doesn't apply. */
+static int sweep_setmode(SDL_Surface *src, int mode)
+{
+    int has_alpha = (src->format->Amask != 0);
+    Uint32 black = SDL_MapRGBA(src->format, 0, 0, 0, 0);
+
+    SDL_SetColorKey(src, 0, 0);
+    SDL_SetAlpha(src, 0, SDL_ALPHA_OPAQUE);
+    switch (mode)
+    {
+        case SWEEP_COPY:
+            return(1);
+        case SWEEP_KEY:
+            return(SDL_SetColorKey(src, SDL_SRCCOLORKEY, black) == 0);
+        case SWEEP_RLEKEY:
+            return(SDL_SetColorKey(src, SDL_SRCCOLORKEY|SDL_RLEACCEL, black) == 0);
+        case SWEEP_SALPHA:
+            if (has_alpha)
+                return(0);
+            return(SDL_SetAlpha(src, SDL_SRCALPHA, 128) == 0);
+        case SWEEP_PALPHA:
+            if (!has_alpha)
+                return(0);
+            return(SDL_SetAlpha(src, SDL_SRCALPHA, SDL_ALPHA_OPAQUE) == 0);
+        case SWEEP_RLEALPHA:
+            if (!has_alpha)
+                return(0);
+            return(SDL_SetAlpha(src, SDL_SRCALPHA|SDL_RLEACCEL, SDL_ALPHA_OPAQUE) == 0);
+    }
+    return(0);
+}
+
+static void sweep_case(const sweep_format *sf, const sweep_format *df,
+                       int mode, int w, int h, int dstx, int ms)
+{
+    SDL_Surface *src = sweep_surface(sf, w, h);
+    SDL_Surface *dst = sweep_surface(df, w + 1, h);
+    SDL_BlitStats *stats;
+    SDL_Rect srcrect, dstrect;
+    const char *blitter = "none";
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint64 budget = (freq * ms) / 1000;
+    Uint64 start, elapsed;
+    Uint32 blits = 0;
+    double usecs;
+    int i, count, batch;
+
+    if ((src == NULL) || (dst == NULL) || !sweep_setmode(src, mode))
+    {
+        if (src)
+            SDL_FreeSurface(src);
+        if (dst)
+            SDL_FreeSurface(dst);
+        return;
+    }
+
+    /* one blit to set up the mapping (and RLE encode) before timing */
+    srcrect.x = 0;
+    srcrect.y = 0;
+    srcrect.w = w;
+    srcrect.h = h;
+    dstrect = srcrect;
+    dstrect.x = dstx;
+    if (SDL_LowerBlit(src, &srcrect, dst, &dstrect) < 0)
+    {
+        /* combination the blitter doesn't support */
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        return;
+    }
+
+    /* the setup blit tells us which blitter was picked */
+    count = SDL_GetBlitStats(NULL, 0);
+    stats = (SDL_BlitStats *) malloc(count * sizeof (*stats));
+    if (stats != NULL)
+    {
+        count = SDL_GetBlitStats(stats, count);
+        for (i = 0; i < count; i++)
+        {
+            if (stats[i].calls)
+            {
+                blitter = stats[i].blitter;
+                break;
+            }
+        }
+        free(stats);
+    }
+    SDL_ResetBlitStats();
+
+    /*
+     * Time batches of blits, with the counters off so the profiling shim
+     * doesn't time each one, and only read the clock between batches.
+     */
+    SDL_EnableBlitStats(0);
+    batch = 1;
+    start = SDL_GetPerformanceCounter();
+    do
+    {
+        for (i = 0; i < batch; i++)
+        {
+            dstrect.x = dstx;
+            dstrect.y = 0;
+            SDL_LowerBlit(src, &srcrect, dst, &dstrect);
+        }
+        blits += batch;
+        elapsed = SDL_GetPerformanceCounter() - start;
+        if (elapsed < budget / 16)
+            batch *= 2;
+    } while (elapsed < budget);
+    SDL_EnableBlitStats(1);
+
+    usecs = ((double) (Sint64) elapsed * 1000000.0) / (double) (Sint64) freq;
+    printf("%s,%s,%s,%d,%d,%d,%s,%u,%.0f,%.0f,%.2f\n",
+           sf->name, df->name, sweep_modes[mode], w, h, dstx, blitter,
+           (unsigned int) blits, (double) blits * w * h, usecs,
+           ((double) blits * w * h) / usecs);
+    fflush(stdout);
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+}
+
+static int run_sweep(int argc, char **argv)
+{
+    int sizes[16][2];
+    int nsizes = 0;
+    int onlysrc = -1;
+    int onlydst = -1;
+    int onlymode = -1;
+    int ms = 100;
+    int s, d, m, z, a;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if (strcmp(arg, "--sweep") == 0)
+            continue;
+        else if (strcmp(arg, "--ms") == 0)
+            ms = atoi(val);
+        else if ((strcmp(arg, "--size") == 0) && (nsizes < 16))
+        {
+            if (sscanf(val, "%dx%d", &sizes[nsizes][0], &sizes[nsizes][1]) == 2)
+                nsizes++;
+        }
+        else if (strcmp(arg, "--src") == 0)
+        {
+            if ((onlysrc = sweep_find_format(val)) < 0)
+                return(0);
+        }
+        else if (strcmp(arg, "--dst") == 0)
+        {
+            if ((onlydst = sweep_find_format(val)) < 0)
+                return(0);
+        }
+        else if (strcmp(arg, "--mode") == 0)
+        {
+            if ((onlymode = sweep_find_mode(val)) < 0)
+                return(0);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown commandline option: %s\n", arg);
+            return(0);
+        }
+        i++;
+    }
+
+    if (nsizes == 0)
+    {
+        sizes[0][0] = 64;  sizes[0][1] = 64;
+        sizes[1][0] = 640; sizes[1][1] = 480;
+        nsizes = 2;
+    }
+
+    /* No window needed, but keep the video subsystem in the loop */
+    if (getenv("SDL_VIDEODRIVER") == NULL)
+        SDL_putenv("SDL_VIDEODRIVER=dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) == -1)
+    {
+        fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+        return(0);
+    }
+    SDL_EnableBlitStats(1);
+
+    printf("src,dst,mode,width,height,dstx,blitter,blits,pixels,usecs,mpixels_per_sec\n");
+    for (s = 0; s < SWEEP_ARRAYSIZE(sweep_formats); s++)
+    {
+        if ((onlysrc >= 0) && (s != onlysrc))
+            continue;
+        for (d = 0; d < SWEEP_ARRAYSIZE(sweep_formats); d++)
+        {
+            if ((onlydst >= 0) && (d != onlydst))
+                continue;
+            for (m = 0; m < SWEEP_ARRAYSIZE(sweep_modes); m++)
+            {
+                if ((onlymode >= 0) && (m != onlymode))
+                    continue;
+                for (z = 0; z < nsizes; z++)
+                {
+                    /* aligned, and one pixel off for the destination */
+                    for (a = 0; a < 2; a++)
+                        sweep_case(&sweep_formats[s], &sweep_formats[d],
+                                   m, sizes[z][0], sizes[z][1], a, ms);
+                }
+            }
+        }
+    }
+
+    SDL_Quit();
+    return(1);
+}
+
 int main(int argc, char **argv)
 {
-    int initialized = setup_test(argc, argv);
+    int initialized;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--sweep") == 0)
+            return(!run_sweep(argc, argv));
+    }
+
+    initialized = setup_test(argc, argv);
     if (initialized)
     {
         test_blit_speed();
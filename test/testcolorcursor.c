@@ -0,0 +1,200 @@
+
+/* Draws colour cursors in software through the dummy video driver, or
+   SDL_VIDEODRIVER if set, and checks the pixels they leave on the screen
+   in each screen depth: opaque, transparent and half transparent pixels
+   from an alpha channel, a colorkeyed cursor, and erasing.
+
+   testcolorcursor
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define CURSOR_SIZE	8
+#define CURSOR_X	20
+#define CURSOR_Y	10
+
+static Uint32 get_pixel(SDL_Surface *surface, int x, int y)
+{
+	Uint8 *p = (Uint8 *)surface->pixels + y*surface->pitch +
+					x*surface->format->BytesPerPixel;
+
+	switch (surface->format->BytesPerPixel) {
+	    case 1:
+		return *p;
+	    case 2:
+		return *(Uint16 *)p;
+	    case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+		return p[0] | (p[1] << 8) | (p[2] << 16);
+#else
+		return (p[0] << 16) | (p[1] << 8) | p[2];
+#endif
+	    default:
+		return *(Uint32 *)p;
+	}
+}
+
+static int check_color(SDL_Surface *screen, const char *what, int x, int y,
+			Uint8 r, Uint8 g, Uint8 b, int slack)
+{
+	Uint8 sr, sg, sb;
+
+	SDL_LockSurface(screen);
+	SDL_GetRGB(get_pixel(screen, x, y), screen->format, &sr, &sg, &sb);
+	SDL_UnlockSurface(screen);
+	if ( (abs(sr - r) > slack) || (abs(sg - g) > slack) ||
+	     (abs(sb - b) > slack) ) {
+		printf("  %s at %d,%d is %d,%d,%d, expected %d,%d,%d\n",
+			what, x, y, sr, sg, sb, r, g, b);
+		return 1;
+	}
+	return 0;
+}
+
+/* Left half opaque red, top right clear, bottom right half clear red */
+static SDL_Cursor *create_alpha_cursor(void)
+{
+	SDL_Surface *surface;
+	SDL_Cursor *cursor;
+	Uint32 *row;
+	int x, y;
+
+	surface = SDL_CreateRGBSurface(SDL_SWSURFACE, CURSOR_SIZE, CURSOR_SIZE,
+			32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if ( surface == NULL ) {
+		return NULL;
+	}
+	for ( y = 0; y < CURSOR_SIZE; ++y ) {
+		row = (Uint32 *)((Uint8 *)surface->pixels + y*surface->pitch);
+		for ( x = 0; x < CURSOR_SIZE; ++x ) {
+			if ( x < CURSOR_SIZE/2 ) {
+				row[x] = 0xFFFF0000;
+			} else if ( y < CURSOR_SIZE/2 ) {
+				row[x] = 0x00FF0000;
+			} else {
+				row[x] = 0x80FF0000;
+			}
+		}
+	}
+	cursor = SDL_CreateColorCursor(surface, 0, 0);
+	SDL_FreeSurface(surface);
+	return cursor;
+}
+
+/* Green on the left, a magenta colorkey on the right */
+static SDL_Cursor *create_colorkey_cursor(void)
+{
+	SDL_Surface *surface;
+	SDL_Cursor *cursor;
+	SDL_Rect rect;
+
+	surface = SDL_CreateRGBSurface(SDL_SWSURFACE, CURSOR_SIZE, CURSOR_SIZE,
+			32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+	if ( surface == NULL ) {
+		return NULL;
+	}
+	SDL_FillRect(surface, NULL, SDL_MapRGB(surface->format, 255, 0, 255));
+	rect.x = 0;
+	rect.y = 0;
+	rect.w = CURSOR_SIZE/2;
+	rect.h = CURSOR_SIZE;
+	SDL_FillRect(surface, &rect, SDL_MapRGB(surface->format, 0, 255, 0));
+	SDL_SetColorKey(surface, SDL_SRCCOLORKEY,
+			SDL_MapRGB(surface->format, 255, 0, 255));
+	cursor = SDL_CreateColorCursor(surface, 0, 0);
+	SDL_FreeSurface(surface);
+	return cursor;
+}
+
+static int test_depth(int bpp, SDL_Cursor *alpha, SDL_Cursor *colorkey)
+{
+	SDL_Surface *screen;
+	int x = CURSOR_X, y = CURSOR_Y;
+	int slack, errors = 0;
+
+	screen = SDL_SetVideoMode(64, 64, bpp, SDL_SWSURFACE);
+	if ( screen == NULL ) {
+		printf("Couldn't set %d bpp video mode: %s\n",
+			bpp, SDL_GetError());
+		return 1;
+	}
+	printf("%d bpp:\n", screen->format->BitsPerPixel);
+	slack = (screen->format->BitsPerPixel < 24) ? 8 : 2;
+
+	/* Draw on a blue background, the mouse starts off the cursor spot */
+	SDL_ShowCursor(0);
+	SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 255));
+	SDL_WarpMouse(0, 0);
+	SDL_SetCursor(alpha);
+	SDL_ShowCursor(1);
+	SDL_WarpMouse(x, y);
+
+	errors += check_color(screen, "opaque", x, y, 255, 0, 0, slack);
+	errors += check_color(screen, "clear",
+			x+CURSOR_SIZE-1, y, 0, 0, 255, slack);
+	errors += check_color(screen, "half clear",
+			x+CURSOR_SIZE-1, y+CURSOR_SIZE-1, 128, 0, 127, slack);
+
+	SDL_SetCursor(colorkey);
+	errors += check_color(screen, "colorkey opaque", x, y, 0, 255, 0, slack);
+	errors += check_color(screen, "colorkey clear",
+			x+CURSOR_SIZE-1, y+CURSOR_SIZE-1, 0, 0, 255, slack);
+
+	/* Moving and hiding the cursor puts the background back */
+	SDL_WarpMouse(x+CURSOR_SIZE, y);
+	errors += check_color(screen, "moved from", x, y, 0, 0, 255, slack);
+	errors += check_color(screen, "moved to",
+			x+CURSOR_SIZE, y, 0, 255, 0, slack);
+	SDL_ShowCursor(0);
+	errors += check_color(screen, "hidden",
+			x+CURSOR_SIZE, y, 0, 0, 255, slack);
+
+	printf("  %s\n", errors ? "FAILED" : "passed");
+	return errors ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const int depths[] = { 32, 24, 16 };
+	SDL_Cursor *alpha, *colorkey;
+	int i, errors = 0;
+
+	if ( !SDL_getenv("SDL_VIDEODRIVER") ) {
+		SDL_putenv("SDL_VIDEODRIVER=dummy");
+	}
+	if ( SDL_Init(SDL_INIT_VIDEO) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	alpha = create_alpha_cursor();
+	colorkey = create_colorkey_cursor();
+	if ( (alpha == NULL) || (colorkey == NULL) ) {
+		fprintf(stderr, "Couldn't create cursors: %s\n", SDL_GetError());
+		return 1;
+	}
+	if ( SDL_CreateColorCursor(NULL, 0, 0) != NULL ) {
+		printf("Created a cursor from a NULL surface\n");
+		++errors;
+	}
+
+	/* The same cursors are redrawn after each mode change */
+	for ( i = 0; i < SDL_arraysize(depths); ++i ) {
+		errors += test_depth(depths[i], alpha, colorkey);
+	}
+
+	/* Freeing the current cursor goes back to the default one */
+	SDL_FreeCursor(colorkey);
+	SDL_FreeCursor(alpha);
+	if ( SDL_GetCursor() == alpha ) {
+		printf("The freed cursor is still current\n");
+		++errors;
+	}
+
+	printf("%d failures\n", errors);
+	return errors ? 1 : 0;
+}
@@ -15,6 +15,34 @@ static void quit(int rc)
 	exit(rc);
 }
 
+/* Time full screen updates, which go through software gamma on drivers
+   that can't set a gamma ramp (see SDL_VIDEO_SOFTWARE_GAMMA) */
+static void bench(SDL_Surface *screen, int frames)
+{
+	Uint64 start, elapsed;
+	int i, x, y;
+
+	if ( SDL_LockSurface(screen) == 0 ) {
+		for ( y = 0; y < screen->h; ++y ) {
+			Uint8 *row = (Uint8 *)screen->pixels + y * screen->pitch;
+			for ( x = 0; x < screen->w * screen->format->BytesPerPixel; ++x ) {
+				row[x] = (Uint8)(x ^ y);
+			}
+		}
+		SDL_UnlockSurface(screen);
+	}
+	SDL_Flip(screen);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < frames; ++i ) {
+		SDL_Flip(screen);
+	}
+	elapsed = SDL_GetPerformanceCounter() - start;
+	printf("%dx%dx%d: %.3f ms per frame\n",
+		screen->w, screen->h, screen->format->BitsPerPixel,
+		(double)elapsed * 1000.0 / SDL_GetPerformanceFrequency() / frames);
+}
+
 /* Turn a normal gamma value into an appropriate gamma ramp */
 void CalculateGamma(double gamma, Uint16 *ramp)
 {
@@ -81,9 +109,14 @@ int main(int argc, char *argv[])
 	Uint16 ramp[256];
 	Uint16 red_ramp[256];
 	Uint32 then, timeout;
+	int frames = 0;
 
 	/* Check command line arguments */
 	argv += get_video_args(argv, &w, &h, &bpp, &flags);
+	if ( *argv && (strcmp(*argv, "-bench") == 0) && argv[1] ) {
+		frames = atoi(argv[1]);
+		argv += 2;
+	}
 
 	/* Initialize SDL */
 	if ( SDL_Init(SDL_INIT_VIDEO) < 0 ) {
@@ -112,6 +145,10 @@ int main(int argc, char *argv[])
 		fprintf(stderr, "Unable to set gamma: %s\n", SDL_GetError());
 		quit(1);
 	}
+	if ( frames > 0 ) {
+		bench(screen, frames);
+		quit(0);
+	}
 
 #if 0 /* This isn't supported.  Integrating the gamma ramps isn't exact */
 	/* See what gamma was actually set */
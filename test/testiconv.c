@@ -1,8 +1,20 @@
 
+/* Checks SDL_iconv_string() round trips through each encoding, and times
+   the common conversions.
+
+   testiconv [file]	convert each line of a UTF-8 file (default utf8.txt)
+   testiconv -b [file]	time converting the file and plain ASCII text
+*/
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "SDL.h"
 
+#define BENCH_SIZE	(1024*1024)
+#define BENCH_LOOPS	20
+
 static size_t widelen(char *data)
 {
 	size_t len = 0;
@@ -13,6 +25,122 @@ static size_t widelen(char *data)
 	return len;
 }
 
+/* Time BENCH_LOOPS conversions of len bytes of text, returning megabytes of
+   input per second, and the size of the result in *outlen.
+ */
+static double bench(const char *tocode, const char *fromcode,
+                    const char *text, size_t len, size_t *outlen)
+{
+	Uint64 start;
+	double seconds;
+	char *result;
+	int i;
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < BENCH_LOOPS; ++i ) {
+		result = SDL_iconv_string(tocode, fromcode, text, len);
+		if ( !result ) {
+			return 0.0;
+		}
+		SDL_free(result);
+	}
+	seconds = (double)(SDL_GetPerformanceCounter() - start) /
+	          SDL_GetPerformanceFrequency();
+
+	/* Find the output length from the terminator, which is converted too */
+	result = SDL_iconv_string(tocode, fromcode, text, len);
+	if ( SDL_strcmp(tocode, "UTF-8") == 0 ) {
+		*outlen = SDL_strlen(result) + 1;
+	} else if ( SDL_strcmp(tocode, "UCS-4") == 0 ) {
+		*outlen = (widelen(result) + 1) * 4;
+	} else {
+		Uint16 *p = (Uint16 *)result;
+		while ( *p++ ) {
+		}
+		*outlen = (char *)p - result;
+	}
+	SDL_free(result);
+
+	if ( seconds <= 0.0 ) {
+		return 0.0;
+	}
+	return ((double)len * BENCH_LOOPS / (1024.0 * 1024.0)) / seconds;
+}
+
+static void bench_text(const char *name, const char *utf8)
+{
+	const char *wide[] = { "UCS-2", "UTF-16LE", "UCS-4" };
+	size_t len = SDL_strlen(utf8) + 1;
+	size_t widesize;
+	char *text;
+	double rate;
+	int i;
+
+	printf("%s, %lu bytes of UTF-8:\n", name, (unsigned long)len);
+	for ( i = 0; i < SDL_arraysize(wide); ++i ) {
+		rate = bench(wide[i], "UTF-8", utf8, len, &widesize);
+		printf("  UTF-8 -> %-8s %8.1f MB/s\n", wide[i], rate);
+
+		text = SDL_iconv_string(wide[i], "UTF-8", utf8, len);
+		rate = bench("UTF-8", wide[i], text, widesize, &widesize);
+		printf("  %-8s -> UTF-8 %8.1f MB/s\n", wide[i], rate);
+		SDL_free(text);
+	}
+}
+
+static int benchmark(const char *fname)
+{
+	char *ascii, *utf8;
+	size_t i, len, size;
+	FILE *file;
+
+	file = fopen(fname, "rb");
+	if ( !file ) {
+		fprintf(stderr, "Unable to open %s\n", fname);
+		return (1);
+	}
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	/* Repeat the file's text up to the benchmark size */
+	utf8 = (char *)malloc(BENCH_SIZE + 1);
+	ascii = (char *)malloc(BENCH_SIZE + 1);
+	if ( !utf8 || !ascii || !size ) {
+		fprintf(stderr, "Unable to load %s\n", fname);
+		fclose(file);
+		return (1);
+	}
+	len = fread(utf8, 1, size < BENCH_SIZE ? size : BENCH_SIZE, file);
+	fclose(file);
+	for ( i = len; i < BENCH_SIZE; ++i ) {
+		utf8[i] = utf8[i % len];
+	}
+	/* Don't leave a character cut off at the end */
+	while ( (utf8[i-1] & 0xC0) == 0x80 ) {
+		--i;
+	}
+	if ( (utf8[i-1] & 0x80) ) {
+		--i;
+	}
+	utf8[i] = '\0';
+
+	for ( i = 0; i < BENCH_SIZE; ++i ) {
+		ascii[i] = ' ' + (i % 95);
+	}
+	ascii[i] = '\0';
+
+#ifdef HAVE_ICONV
+	printf("SDL_iconv is the C library iconv in this build\n");
+#endif
+	bench_text(fname, utf8);
+	bench_text("ASCII text", ascii);
+
+	free(utf8);
+	free(ascii);
+	return (0);
+}
+
 int main(int argc, char *argv[])
 {
 	const char * formats[] = {
@@ -38,6 +166,10 @@ int main(int argc, char *argv[])
 	FILE *file;
 	int errors = 0;
 
+	if ( argc > 1 && strcmp(argv[1], "-b") == 0 ) {
+		return benchmark((argc < 3) ? "utf8.txt" : argv[2]);
+	}
+
 	fname = (argc < 2) ? "utf8.txt" : argv[1];
 	file = fopen(fname, "rb");
 	if ( !file ) {
@@ -0,0 +1,275 @@
+
+/* Checks the job pool: independent jobs, jobs that depend on others,
+   SDL_ParallelFor(), jobs that wait on jobs, and several threads waiting
+   on one counter, with each pool size given.
+
+   testjobs [workers ...]	pool sizes to test (default 0 3 8)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+#include "SDL_atomic.h"
+
+#define NUMJOBS		1000
+#define NUMSTAGES	8
+#define STAGEJOBS	50
+#define NUMITEMS	100000
+#define NUMWAITERS	4
+
+static SDL_atomic_t count;
+static SDL_atomic_t stage_done[NUMSTAGES];
+static SDL_atomic_t out_of_order;
+static SDL_atomic_t marks[NUMITEMS];
+
+static void SDLCALL CountJob(void *data)
+{
+	SDL_AtomicIncRef(&count);
+}
+
+/* Every job of the stage before must be done before this one runs */
+static void SDLCALL StageJob(void *data)
+{
+	int stage = (int)(size_t)data;
+
+	if ( stage == 0 ) {
+		SDL_Delay(1);
+	}
+	if ( (stage > 0) &&
+	     (SDL_AtomicGet(&stage_done[stage-1]) != STAGEJOBS) ) {
+		SDL_AtomicIncRef(&out_of_order);
+	}
+	SDL_AtomicIncRef(&stage_done[stage]);
+}
+
+static void SDLCALL MarkRange(void *data, int start, int end)
+{
+	int i;
+
+	for ( i = start; i < end; ++i ) {
+		SDL_AtomicIncRef(&marks[i]);
+	}
+}
+
+/* A job that waits for jobs of its own */
+static void SDLCALL NestedJob(void *data)
+{
+	SDL_ParallelFor(0, 100, 10, MarkRange, NULL);
+}
+
+static void SDLCALL SlowJob(void *data)
+{
+	SDL_Delay(1);
+	SDL_AtomicIncRef(&count);
+}
+
+static int SDLCALL WaitThread(void *data)
+{
+	SDL_JobCounter *counter = (SDL_JobCounter *)data;
+
+	SDL_WaitJobs(counter);
+	return(SDL_AtomicGet(&count));
+}
+
+static int CheckMarks(int n, int expected)
+{
+	int i;
+
+	for ( i = 0; i < n; ++i ) {
+		if ( SDL_AtomicGet(&marks[i]) != expected ) {
+			printf("  item %d was visited %d times\n",
+				i, SDL_AtomicGet(&marks[i]));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void ClearMarks(void)
+{
+	int i;
+
+	for ( i = 0; i < NUMITEMS; ++i ) {
+		SDL_AtomicSet(&marks[i], 0);
+	}
+}
+
+static int TestIndependent(void)
+{
+	SDL_JobCounter *counter;
+	int i;
+
+	counter = SDL_CreateJobCounter();
+	SDL_AtomicSet(&count, 0);
+	for ( i = 0; i < NUMJOBS; ++i ) {
+		if ( SDL_AddJob(CountJob, NULL, counter, NULL) < 0 ) {
+			printf("  couldn't add job: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+	SDL_WaitJobs(counter);
+	SDL_DestroyJobCounter(counter);
+	if ( SDL_AtomicGet(&count) != NUMJOBS ) {
+		printf("  %d of %d jobs ran\n", SDL_AtomicGet(&count), NUMJOBS);
+		return 1;
+	}
+	return 0;
+}
+
+static int TestDependencies(void)
+{
+	SDL_JobCounter *counters[NUMSTAGES];
+	int i, j, errors = 0;
+
+	SDL_AtomicSet(&out_of_order, 0);
+	for ( i = 0; i < NUMSTAGES; ++i ) {
+		SDL_AtomicSet(&stage_done[i], 0);
+		counters[i] = SDL_CreateJobCounter();
+	}
+	/* The first stage is slow, so the later ones queue up behind it */
+	for ( i = 0; i < NUMSTAGES; ++i ) {
+		for ( j = 0; j < STAGEJOBS; ++j ) {
+			SDL_AddJob(StageJob, (void *)(size_t)i, counters[i],
+				(i > 0) ? counters[i-1] : NULL);
+		}
+	}
+	SDL_WaitJobs(counters[NUMSTAGES-1]);
+	for ( i = 0; i < NUMSTAGES; ++i ) {
+		SDL_WaitJobs(counters[i]);
+		if ( SDL_AtomicGet(&stage_done[i]) != STAGEJOBS ) {
+			printf("  stage %d ran %d of %d jobs\n", i,
+				SDL_AtomicGet(&stage_done[i]), STAGEJOBS);
+			++errors;
+		}
+		SDL_DestroyJobCounter(counters[i]);
+	}
+	if ( SDL_AtomicGet(&out_of_order) ) {
+		printf("  %d jobs ran before the stage they depend on\n",
+			SDL_AtomicGet(&out_of_order));
+		++errors;
+	}
+	return errors;
+}
+
+static int TestParallelFor(void)
+{
+	static const int grains[] = { 0, 1, 7, 1000, NUMITEMS*2 };
+	int i, errors = 0;
+
+	for ( i = 0; i < SDL_arraysize(grains); ++i ) {
+		ClearMarks();
+		SDL_ParallelFor(0, NUMITEMS, grains[i], MarkRange, NULL);
+		if ( CheckMarks(NUMITEMS, 1) ) {
+			printf("  grain %d failed\n", grains[i]);
+			++errors;
+		}
+	}
+
+	/* An empty range shouldn't call anything */
+	ClearMarks();
+	SDL_ParallelFor(10, 10, 0, MarkRange, NULL);
+	errors += CheckMarks(NUMITEMS, 0);
+	return errors;
+}
+
+static int TestNested(void)
+{
+	SDL_JobCounter *counter;
+	int i;
+
+	ClearMarks();
+	counter = SDL_CreateJobCounter();
+	for ( i = 0; i < 20; ++i ) {
+		SDL_AddJob(NestedJob, NULL, counter, NULL);
+	}
+	SDL_WaitJobs(counter);
+	SDL_DestroyJobCounter(counter);
+	return CheckMarks(100, 20);
+}
+
+static int TestWaiters(void)
+{
+	SDL_JobCounter *counter;
+	SDL_Thread *threads[NUMWAITERS];
+	int i, result, errors = 0;
+
+	counter = SDL_CreateJobCounter();
+	SDL_AtomicSet(&count, 0);
+	for ( i = 0; i < 100; ++i ) {
+		SDL_AddJob(SlowJob, NULL, counter, NULL);
+	}
+	for ( i = 0; i < NUMWAITERS; ++i ) {
+		threads[i] = SDL_CreateThread(WaitThread, counter);
+	}
+	SDL_WaitJobs(counter);
+	for ( i = 0; i < NUMWAITERS; ++i ) {
+		if ( threads[i] ) {
+			SDL_WaitThread(threads[i], &result);
+			if ( result != 100 ) {
+				printf("  a waiter returned with %d of 100 jobs done\n",
+					result);
+				++errors;
+			}
+		}
+	}
+	SDL_DestroyJobCounter(counter);
+	return errors;
+}
+
+static int RunTest(const char *name, int (*test)(void))
+{
+	Uint32 start = SDL_GetTicks();
+	int errors = test();
+
+	printf("  %-14s %s in %u ms\n", name, errors ? "FAILED" : "passed",
+		SDL_GetTicks() - start);
+	return errors ? 1 : 0;
+}
+
+static int TestPool(int numthreads)
+{
+	int errors = 0;
+
+	/* SDL_InitJobs(0) picks the default, which the environment sets */
+	if ( numthreads == 0 ) {
+		SDL_putenv("SDL_JOB_THREADS=0");
+	}
+	if ( SDL_InitJobs(numthreads) < 0 ) {
+		printf("Couldn't start %d workers: %s\n", numthreads, SDL_GetError());
+		return 1;
+	}
+	printf("%d workers:\n", SDL_GetJobThreadCount());
+	errors += RunTest("independent", TestIndependent);
+	errors += RunTest("dependencies", TestDependencies);
+	errors += RunTest("parallel for", TestParallelFor);
+	errors += RunTest("nested", TestNested);
+	errors += RunTest("waiters", TestWaiters);
+	SDL_QuitJobs();
+	return errors;
+}
+
+int main(int argc, char *argv[])
+{
+	static const int default_sizes[] = { 0, 3, 8 };
+	int i, errors = 0;
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	if ( argc > 1 ) {
+		for ( i = 1; i < argc; ++i ) {
+			errors += TestPool(atoi(argv[i]));
+		}
+	} else {
+		for ( i = 0; i < SDL_arraysize(default_sizes); ++i ) {
+			errors += TestPool(default_sizes[i]);
+		}
+	}
+	printf("%d failures\n", errors);
+	return errors ? 1 : 0;
+}
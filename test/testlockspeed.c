@@ -0,0 +1,196 @@
+
+/* Times SDL mutexes and semaphores with and without contention, and
+   checks how closely semaphore timeouts are kept.
+
+   testlockspeed [threads] [iterations]	contending threads (default 4)
+						and operations per measurement
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+static SDL_mutex *mutex;
+static SDL_sem *ping;
+static SDL_sem *pong;
+static int iterations = 1000000;
+static int numthreads = 4;
+static volatile int counter;
+
+/* Return the nanoseconds per operation since start */
+static double ns_per_op(Uint64 start, int ops)
+{
+	double seconds;
+
+	seconds = (double)(SDL_GetPerformanceCounter() - start) /
+	          SDL_GetPerformanceFrequency();
+	return (seconds * 1000000000.0) / ops;
+}
+
+static void print_stats(const char *name, int result, const SDL_SyncStats *stats)
+{
+	if ( result < 0 ) {
+		printf("  %s stats: %s\n", name, SDL_GetError());
+	} else {
+		printf("  %s stats: %u acquired, %u contended, %u timed out\n",
+			name, stats->acquired, stats->contended, stats->timeouts);
+	}
+}
+
+static int SDLCALL LockThread(void *data)
+{
+	int i, count = (int)(uintptr_t)data;
+
+	for ( i = 0; i < count; ++i ) {
+		SDL_mutexP(mutex);
+		++counter;
+		SDL_mutexV(mutex);
+	}
+	return 0;
+}
+
+static int SDLCALL PongThread(void *data)
+{
+	int i, count = (int)(uintptr_t)data;
+
+	for ( i = 0; i < count; ++i ) {
+		SDL_SemWait(ping);
+		SDL_SemPost(pong);
+	}
+	return 0;
+}
+
+static void TestUncontended(void)
+{
+	SDL_SyncStats stats;
+	Uint64 start;
+	int i;
+
+	/* Some C libraries skip the atomic operations in their locks until a
+	   second thread starts, so start one to measure the usual case.
+	 */
+	SDL_WaitThread(SDL_CreateThread(LockThread, (void *)0), NULL);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < iterations; ++i ) {
+		SDL_mutexP(mutex);
+		SDL_mutexV(mutex);
+	}
+	printf("Uncontended mutex lock/unlock: %.1f ns\n", ns_per_op(start, iterations));
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < iterations; ++i ) {
+		SDL_SemPost(ping);
+		SDL_SemWait(ping);
+	}
+	printf("Uncontended semaphore post/wait: %.1f ns\n", ns_per_op(start, iterations));
+	print_stats("semaphore", SDL_GetSemStats(ping, &stats), &stats);
+}
+
+static void TestContended(void)
+{
+	SDL_Thread **threads;
+	SDL_SyncStats before, after;
+	Uint64 start;
+	int i, result, count = iterations / numthreads;
+
+	threads = (SDL_Thread **)malloc(numthreads * sizeof(*threads));
+	if ( threads == NULL ) {
+		fprintf(stderr, "Out of memory\n");
+		return;
+	}
+	SDL_GetMutexStats(mutex, &before);
+	counter = 0;
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < numthreads; ++i ) {
+		threads[i] = SDL_CreateThread(LockThread, (void *)(uintptr_t)count);
+	}
+	for ( i = 0; i < numthreads; ++i ) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+	printf("Contended mutex lock/unlock, %d threads: %.1f ns\n",
+		numthreads, ns_per_op(start, count * numthreads));
+	if ( counter != count * numthreads ) {
+		printf("  counter is %d, expected %d!\n", counter, count * numthreads);
+	}
+	result = SDL_GetMutexStats(mutex, &after);
+	after.acquired -= before.acquired;
+	after.contended -= before.contended;
+	print_stats("mutex", result, &after);
+	free(threads);
+}
+
+static void TestPingPong(void)
+{
+	SDL_Thread *thread;
+	Uint64 start;
+	int i, count = iterations / 10;
+
+	start = SDL_GetPerformanceCounter();
+	thread = SDL_CreateThread(PongThread, (void *)(uintptr_t)count);
+	for ( i = 0; i < count; ++i ) {
+		SDL_SemPost(ping);
+		SDL_SemWait(pong);
+	}
+	SDL_WaitThread(thread, NULL);
+	printf("Semaphore round trip between threads: %.1f ns\n", ns_per_op(start, count));
+}
+
+static void TestTimeouts(void)
+{
+	static const Uint32 timeouts[] = { 1, 5, 20, 100 };
+	SDL_SyncStats stats;
+	Uint64 start;
+	double elapsed;
+	int i, result;
+
+	for ( i = 0; i < (int)SDL_arraysize(timeouts); ++i ) {
+		start = SDL_GetPerformanceCounter();
+		result = SDL_SemWaitTimeout(pong, timeouts[i]);
+		elapsed = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 /
+		          SDL_GetPerformanceFrequency();
+		printf("Semaphore wait timeout of %u ms took %.2f ms%s\n", timeouts[i],
+			elapsed, (result == SDL_MUTEX_TIMEDOUT) ? "" : " (didn't time out!)");
+	}
+	print_stats("semaphore", SDL_GetSemStats(pong, &stats), &stats);
+}
+
+int main(int argc, char *argv[])
+{
+	if ( argc > 1 ) {
+		numthreads = atoi(argv[1]);
+	}
+	if ( argc > 2 ) {
+		iterations = atoi(argv[2]);
+	}
+	if ( (numthreads <= 0) || (iterations <= 0) ) {
+		fprintf(stderr, "Usage: %s [threads] [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	mutex = SDL_CreateMutex();
+	ping = SDL_CreateSemaphore(0);
+	pong = SDL_CreateSemaphore(0);
+	if ( !mutex || !ping || !pong ) {
+		fprintf(stderr, "Couldn't create locks: %s\n", SDL_GetError());
+		return 1;
+	}
+
+	TestUncontended();
+	TestContended();
+	TestPingPong();
+	TestTimeouts();
+
+	SDL_DestroySemaphore(pong);
+	SDL_DestroySemaphore(ping);
+	SDL_DestroyMutex(mutex);
+	return 0;
+}
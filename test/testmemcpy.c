@@ -0,0 +1,125 @@
+
+/* Times SDL_memcpy(), SDL_memset() and SDL_memset4() against the C library
+   for a range of buffer sizes.
+
+   testmemcpy [megabytes]	bytes moved for each measurement (default 64)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#define MAX_SIZE	(8*1024*1024)
+
+static const size_t sizes[] = {
+	16, 64, 256, 1024, 4096, 65536, 1024*1024, MAX_SIZE
+};
+
+static Uint8 *src;
+static Uint8 *dst;
+
+/* Return the throughput in megabytes per second */
+static double rate(Uint64 start, size_t total)
+{
+	double seconds;
+
+	seconds = (double)(SDL_GetPerformanceCounter() - start) /
+	          SDL_GetPerformanceFrequency();
+	if ( seconds <= 0.0 ) {
+		return 0.0;
+	}
+	return (total / (1024.0 * 1024.0)) / seconds;
+}
+
+static void run(size_t size, size_t total)
+{
+	size_t i, loops = total / size;
+	Uint64 start;
+	double sdl_copy, libc_copy, sdl_set, libc_set, sdl_set4;
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < loops; ++i ) {
+		SDL_memcpy(dst, src, size);
+	}
+	sdl_copy = rate(start, loops * size);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < loops; ++i ) {
+		memcpy(dst, src, size);
+	}
+	libc_copy = rate(start, loops * size);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < loops; ++i ) {
+		SDL_memset(dst, (int)i, size);
+	}
+	sdl_set = rate(start, loops * size);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < loops; ++i ) {
+		memset(dst, (int)i, size);
+	}
+	libc_set = rate(start, loops * size);
+
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < loops; ++i ) {
+		SDL_memset4(dst, (Uint32)i, size / 4);
+	}
+	sdl_set4 = rate(start, loops * size);
+
+	printf("%8lu %10.0f %10.0f %10.0f %10.0f %10.0f\n", (unsigned long)size,
+		sdl_copy, libc_copy, sdl_set, libc_set, sdl_set4);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t total = 64;
+	int i;
+
+	if ( argc > 1 ) {
+		total = (size_t)atoi(argv[1]);
+		if ( total == 0 ) {
+			fprintf(stderr, "Usage: %s [megabytes]\n", argv[0]);
+			return 1;
+		}
+	}
+	total *= 1024 * 1024;
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	src = (Uint8 *)malloc(MAX_SIZE);
+	dst = (Uint8 *)malloc(MAX_SIZE);
+	if ( !src || !dst ) {
+		fprintf(stderr, "Out of memory\n");
+		return 1;
+	}
+	for ( i = 0; i < MAX_SIZE; ++i ) {
+		src[i] = (Uint8)i;
+	}
+	memset(dst, 0, MAX_SIZE);
+
+#ifdef HAVE_MEMCPY
+	printf("SDL_memcpy is the C library memcpy in this build\n");
+#endif
+#ifdef HAVE_MEMSET
+	printf("SDL_memset is the C library memset in this build\n");
+#endif
+	printf("SSE2: %s\n", SDL_HasSSE2() ? "yes" : "no");
+	printf("Throughput in MB/s, %lu MB per measurement\n\n",
+		(unsigned long)(total / (1024 * 1024)));
+	printf("%8s %10s %10s %10s %10s %10s\n",
+		"size", "SDL_memcpy", "memcpy", "SDL_memset", "memset", "SDL_memset4");
+	for ( i = 0; i < (int)SDL_arraysize(sizes); ++i ) {
+		run(sizes[i], total);
+	}
+
+	free(src);
+	free(dst);
+	return 0;
+}
@@ -0,0 +1,174 @@
+
+/* Builds and checks SDL pack files (see SDL_OpenPackRW()).
+
+   testpack [-z] pack.spk file ...	build a pack of the files, named
+					as given, LZ4 compressed with -z
+   testpack -t pack.spk			list a pack, read every entry and
+					compare it with the file it came from
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL.h"
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr, "Usage: %s [-z] pack.spk file ...\n", argv0);
+	fprintf(stderr, "       %s -t pack.spk\n", argv0);
+	exit(1);
+}
+
+/* Read a whole file into memory */
+static void *load_file(const char *file, int *size)
+{
+	SDL_RWops *src;
+	void *data;
+
+	src = SDL_RWFromFile(file, "rb");
+	if ( src == NULL ) {
+		return NULL;
+	}
+	*size = SDL_RWseek(src, 0, RW_SEEK_END);
+	if ( (*size < 0) || (SDL_RWseek(src, 0, RW_SEEK_SET) < 0) ) {
+		SDL_RWclose(src);
+		return NULL;
+	}
+	data = malloc(*size ? *size : 1);
+	if ( data && (SDL_RWread(src, data, 1, *size) != *size) ) {
+		SDL_SetError("Couldn't read %s", file);
+		free(data);
+		data = NULL;
+	}
+	SDL_RWclose(src);
+	return data;
+}
+
+static int build_pack(const char *packfile, char **files, int numfiles, int compress)
+{
+	SDL_RWpack *pack;
+	void *data;
+	int i, size;
+
+	pack = SDL_CreatePack(packfile);
+	if ( pack == NULL ) {
+		fprintf(stderr, "Couldn't create %s: %s\n", packfile, SDL_GetError());
+		return 1;
+	}
+	for ( i = 0; i < numfiles; ++i ) {
+		data = load_file(files[i], &size);
+		if ( data == NULL ) {
+			fprintf(stderr, "Couldn't load %s: %s\n", files[i], SDL_GetError());
+			SDL_ClosePack(pack);
+			return 1;
+		}
+		if ( SDL_AddPackEntry(pack, files[i], data, size, compress) < 0 ) {
+			fprintf(stderr, "Couldn't add %s: %s\n", files[i], SDL_GetError());
+			free(data);
+			SDL_ClosePack(pack);
+			return 1;
+		}
+		free(data);
+	}
+	if ( SDL_ClosePack(pack) < 0 ) {
+		fprintf(stderr, "Couldn't write %s: %s\n", packfile, SDL_GetError());
+		return 1;
+	}
+	printf("Wrote %d entries to %s\n", numfiles, packfile);
+	return 0;
+}
+
+static int test_pack(const char *packfile)
+{
+	SDL_RWpack *pack;
+	SDL_RWops *src;
+	const char *name;
+	Uint8 *data, *newdata, *file;
+	Uint32 start, total;
+	int i, size, maxsize, amount, filesize, numentries;
+	int errors = 0;
+
+	start = SDL_GetTicks();
+	pack = SDL_OpenPack(packfile);
+	if ( pack == NULL ) {
+		fprintf(stderr, "Couldn't open %s: %s\n", packfile, SDL_GetError());
+		return 1;
+	}
+	numentries = SDL_PackNumEntries(pack);
+	total = 0;
+	maxsize = 4096;
+	data = (Uint8 *)malloc(maxsize);
+	if ( data == NULL ) {
+		fprintf(stderr, "Out of memory\n");
+		SDL_ClosePack(pack);
+		return 1;
+	}
+	for ( i = 0; i < numentries; ++i ) {
+		name = SDL_PackEntryName(pack, i);
+		src = SDL_RWFromPack(pack, name);
+		if ( src == NULL ) {
+			fprintf(stderr, "Couldn't open %s: %s\n", name, SDL_GetError());
+			free(data);
+			SDL_ClosePack(pack);
+			return 1;
+		}
+		size = 0;
+		while ( (amount = SDL_RWread(src, data+size, 1, maxsize-size)) > 0 ) {
+			size += amount;
+			if ( size == maxsize ) {
+				newdata = (Uint8 *)realloc(data, maxsize*2);
+				if ( newdata == NULL ) {
+					break;
+				}
+				data = newdata;
+				maxsize *= 2;
+			}
+		}
+		SDL_RWclose(src);
+		printf("%10d  %s\n", size, name);
+		total += size;
+
+		/* Entries are named after the files they were built from */
+		file = (Uint8 *)load_file(name, &filesize);
+		if ( file == NULL ) {
+			fprintf(stderr, "Couldn't load %s: %s\n", name, SDL_GetError());
+			++errors;
+		} else {
+			if ( (filesize != size) || (memcmp(file, data, size) != 0) ) {
+				fprintf(stderr, "%s doesn't match its file\n", name);
+				++errors;
+			}
+			free(file);
+		}
+	}
+	free(data);
+	SDL_ClosePack(pack);
+	printf("Read %d entries, %u bytes in %u ms, %d mismatched\n",
+		numentries, total, SDL_GetTicks() - start, errors);
+	return errors ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int compress = 0;
+	int i = 1;
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	if ( (argc == 3) && (strcmp(argv[1], "-t") == 0) ) {
+		return test_pack(argv[2]);
+	}
+	if ( (i < argc) && (strcmp(argv[i], "-z") == 0) ) {
+		compress = 1;
+		++i;
+	}
+	if ( argc - i < 2 ) {
+		usage(argv[0]);
+	}
+	return build_pack(argv[i], &argv[i+1], argc - i - 1, compress);
+}
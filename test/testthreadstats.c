@@ -0,0 +1,192 @@
+
+/* Starts a batch of threads and checks that SDL_GetThreads() lists them,
+   that SDL_GetThreadFromID() finds them by ID, and that SDL_GetThreadStats()
+   counts them as they are created, exit and are waited for.
+
+   testthreadstats [threads]	how many threads to start (default 16)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+#include "SDL_thread.h"
+
+#define MAXTHREADS	256
+#define LIFETIME	50	/* Milliseconds each thread is kept running */
+
+static SDL_sem *go;
+
+static int SDLCALL ThreadFunc(void *data)
+{
+	SDL_SemWait(go);
+	return (int)(size_t)data;
+}
+
+static int check_count(const char *what, Uint32 value, Uint32 expected)
+{
+	if ( value != expected ) {
+		printf("  %s is %u, expected %u\n", what, value, expected);
+		return 1;
+	}
+	return 0;
+}
+
+/* Every thread started is listed exactly once */
+static int check_list(SDL_Thread **threads, int numthreads, int base)
+{
+	SDL_Thread *list[MAXTHREADS+2];
+	int i, j, found, count, errors = 0;
+
+	count = SDL_GetThreads(NULL, 0);
+	errors += check_count("thread count", count, base + numthreads);
+	if ( count > SDL_arraysize(list) ) {
+		return errors + 1;
+	}
+	if ( SDL_GetThreads(list, SDL_arraysize(list)) != count ) {
+		printf("  the thread count changed\n");
+		++errors;
+	}
+	for ( i = 0; i < numthreads; ++i ) {
+		found = 0;
+		for ( j = 0; j < count; ++j ) {
+			if ( list[j] == threads[i] ) {
+				++found;
+			}
+		}
+		if ( found != 1 ) {
+			printf("  thread %d is listed %d times\n", i, found);
+			++errors;
+		}
+	}
+
+	/* A short list is filled in as far as it goes */
+	if ( count > 1 ) {
+		list[1] = NULL;
+		if ( SDL_GetThreads(list, 1) != count ) {
+			printf("  a short list didn't return the thread count\n");
+			++errors;
+		}
+		if ( list[1] != NULL ) {
+			printf("  a short list was filled past its end\n");
+			++errors;
+		}
+	}
+	return errors;
+}
+
+int main(int argc, char *argv[])
+{
+	SDL_Thread *threads[MAXTHREADS];
+	Uint32 ids[MAXTHREADS];
+	SDL_ThreadStats before, stats;
+	int i, base, status, numthreads = 16, errors = 0;
+
+	if ( argc > 1 ) {
+		numthreads = atoi(argv[1]);
+	}
+	if ( (numthreads <= 0) || (numthreads > MAXTHREADS) ) {
+		fprintf(stderr, "Usage: %s [threads]\n", argv[0]);
+		return 1;
+	}
+
+	if ( SDL_Init(0) < 0 ) {
+		fprintf(stderr, "Couldn't initialize SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	atexit(SDL_Quit);
+
+	go = SDL_CreateSemaphore(0);
+	if ( go == NULL ) {
+		fprintf(stderr, "Couldn't create semaphore: %s\n", SDL_GetError());
+		return 1;
+	}
+	SDL_GetThreadStats(&before);
+	base = SDL_GetThreads(NULL, 0);
+	errors += check_count("active threads", before.active, base);
+
+	printf("Starting %d threads\n", numthreads);
+	for ( i = 0; i < numthreads; ++i ) {
+		threads[i] = SDL_CreateThread(ThreadFunc, (void *)(size_t)i);
+		if ( threads[i] == NULL ) {
+			fprintf(stderr, "Couldn't create thread: %s\n", SDL_GetError());
+			return 1;
+		}
+		ids[i] = SDL_GetThreadID(threads[i]);
+	}
+
+	/* The threads are all blocked on the semaphore */
+	errors += check_list(threads, numthreads, base);
+	for ( i = 0; i < numthreads; ++i ) {
+		if ( SDL_GetThreadFromID(ids[i]) != threads[i] ) {
+			printf("  thread %d wasn't found by its ID\n", i);
+			++errors;
+		}
+	}
+	if ( SDL_GetThreadFromID(SDL_ThreadID()) != NULL ) {
+		printf("  found the main thread, which SDL didn't create\n");
+		++errors;
+	}
+	SDL_GetThreadStats(&stats);
+	errors += check_count("active threads", stats.active,
+				before.active + numthreads);
+	errors += check_count("created threads", stats.created,
+				before.created + numthreads);
+	errors += check_count("exited threads", stats.exited, before.exited);
+	if ( stats.created_last_second > stats.created ) {
+		printf("  %u threads created in the last second, of %u\n",
+			stats.created_last_second, stats.created);
+		++errors;
+	}
+
+	/* Let them go and check how long they lived */
+	SDL_Delay(LIFETIME);
+	for ( i = 0; i < numthreads; ++i ) {
+		SDL_SemPost(go);
+	}
+	for ( i = 0; i < numthreads; ++i ) {
+		SDL_WaitThread(threads[i], &status);
+		if ( status != i ) {
+			printf("  thread %d returned %d\n", i, status);
+			++errors;
+		}
+	}
+	SDL_DestroySemaphore(go);
+
+	if ( SDL_GetThreads(NULL, 0) != base ) {
+		printf("  %d threads are listed after waiting for them\n",
+			SDL_GetThreads(NULL, 0));
+		++errors;
+	}
+	for ( i = 0; i < numthreads; ++i ) {
+		if ( SDL_GetThreadFromID(ids[i]) != NULL ) {
+			printf("  thread %d was found after waiting for it\n", i);
+			++errors;
+			break;
+		}
+	}
+	SDL_GetThreadStats(&stats);
+	printf("%d active, %u created, %u exited, average %u ms, longest %u ms\n",
+		stats.active, stats.created, stats.exited,
+		stats.average_lifetime, stats.longest_lifetime);
+	errors += check_count("active threads", stats.active, before.active);
+	errors += check_count("created threads", stats.created,
+				before.created + numthreads);
+	errors += check_count("exited threads", stats.exited,
+				before.exited + numthreads);
+	if ( stats.longest_lifetime < LIFETIME ) {
+		printf("  the longest lifetime is under %d ms\n", LIFETIME);
+		++errors;
+	}
+	if ( stats.average_lifetime > stats.longest_lifetime ) {
+		printf("  the average lifetime is over the longest\n");
+		++errors;
+	}
+	if ( (before.exited == 0) && (stats.average_lifetime < LIFETIME) ) {
+		printf("  the average lifetime is under %d ms\n", LIFETIME);
+		++errors;
+	}
+
+	printf("%d failures\n", errors);
+	return errors ? 1 : 0;
+}